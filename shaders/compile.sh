@@ -1,2 +1,6 @@
 glslc ./shaders/shader.vert -o ./shaders/vert.spv
-glslc ./shaders/shader.frag -o ./shaders/frag.spv
\ No newline at end of file
+glslc ./shaders/shader.frag -o ./shaders/frag.spv
+glslc ./shaders/shader_compact.vert -o ./shaders/compact_vert.spv
+glslc ./shaders/cluster_cull.comp -o ./shaders/cluster_cull_comp.spv
+glslc ./shaders/depth.vert -o ./shaders/depth_vert.spv
+glslc ./shaders/depth_compact.vert -o ./shaders/depth_compact_vert.spv
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 450
+
+// Depth prepass for StandardVertex meshes, reading the position-only stream. gl_Position is
+// invariant here and in shader.vert so the EQUAL test of the main pass sees identical depths.
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 viewProj;
+} ubo;
+
+// Per-draw data, see DrawPushConstants
+layout(push_constant) uniform Draw {
+    mat4 model;
+} draw;
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = ubo.viewProj * draw.model * vec4(inPosition, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 450
+
+// Depth prepass for CompactVertex meshes. Only the position attribute is fetched; the
+// dequantization matches shader_compact.vert exactly.
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 viewProj;
+} ubo;
+
+// Per-draw data, see DrawPushConstants
+layout(push_constant) uniform Draw {
+    mat4 model;
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 texCoordOffsetScale;
+} draw;
+
+layout(location = 0) in vec4 inPosition;
+
+invariant gl_Position;
+
+void main() {
+    vec3 position = draw.positionOffset.xyz + inPosition.xyz * draw.positionScale.xyz;
+    gl_Position = ubo.viewProj * draw.model * vec4(position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#version 450
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 viewProj;
+} ubo;
+
+// Per-draw data, see DrawPushConstants. The quantization parameters expand CompactVertex
+// attributes back to object space.
+layout(push_constant) uniform Draw {
+    mat4 model;
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 texCoordOffsetScale;
+} draw;
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec2 inOctNormal;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragNormal;
+
+// Must match the depth prepass bit for bit
+invariant gl_Position;
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 position = draw.positionOffset.xyz + inPosition.xyz * draw.positionScale.xyz;
+    gl_Position = ubo.viewProj * draw.model * vec4(position, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = draw.texCoordOffsetScale.xy + inTexCoord * draw.texCoordOffsetScale.zw;
+    fragNormal = mat3(draw.model) * decodeOctahedral(inOctNormal);
+}
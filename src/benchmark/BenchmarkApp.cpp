@@ -0,0 +1,472 @@
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BenchmarkApp.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include "../common/UniformTypes.h"
+#include "../rendering/VulkanGraphicsPipeline.h"
+#include "../rendering/VulkanSwapchain.h"
+#include "../rendering/CommandManager.h"
+#include "../rendering/RenderGraph.h"
+#include "../rendering/GpuTimer.h"
+#include "../rendering/FrameReadback.h"
+#include "../resources/BufferManager.h"
+#include "../resources/TextureManager.h"
+#include "../descriptors/DescriptorManager.h"
+
+namespace {
+    const std::string MODEL_PATH = "../assets/models/viking_room.obj";
+    const std::string TEXTURE_PATH = "../assets/textures/viking_room.png";
+    const float INSTANCE_SPACING = 2.5f;
+    // Mesh slots reloaded in turn by the churn scenario
+    const uint32_t CHURN_MESH_SLOTS = 4;
+    // Swapchain sizes of the resize storm, as fractions of the scenario size
+    const std::array<float, 5> RESIZE_SCALES = {0.5f, 0.75f, 1.25f, 0.6f, 1.0f};
+
+    uint32_t hashSeed(uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7feb352dU;
+        value ^= value >> 15;
+        value *= 0x846ca68bU;
+        value ^= value >> 16;
+        return value;
+    }
+}
+
+BenchmarkApp::BenchmarkApp(const BenchmarkScenario& scenario, bool captureLastFrame)
+    : VulkanApplication(makeConfig(scenario)), scenario_(scenario), captureLastFrame_(captureLastFrame) {
+    result_.scenario = scenario.name;
+    result_.type = BenchmarkScenario::getTypeName(scenario.type);
+    result_.width = scenario.width;
+    result_.height = scenario.height;
+    result_.warmupFrames = scenario.warmupFrames;
+    result_.measuredFrames = scenario.measuredFrames;
+}
+
+BenchmarkApp::~BenchmarkApp() {}
+
+VulkanApplication::Config BenchmarkApp::makeConfig(const BenchmarkScenario& scenario) {
+    Config config;
+    config.windowWidth = scenario.width;
+    config.windowHeight = scenario.height;
+    config.windowTitle = "Vulkan Benchmark - " + scenario.name;
+    config.maxFramesInFlight = 2;
+    // Not throttled by the display, falls back to FIFO where the surface has no immediate mode
+    config.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    // Layers skew the timings and are often not installed on CI machines
+    config.enableValidation = false;
+    config.headless = true;
+    config.enableGui = false;
+    config.metricsHistory = std::max(scenario.measuredFrames, 1u);
+    config.enableShaderHotReload = false;
+    config.msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+    config.assetPackPath = scenario.assetPackPath;
+    return config;
+}
+
+void BenchmarkApp::initializeResources() {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(vulkanDevice_->getPhysicalDevice(), &properties);
+    result_.deviceName = properties.deviceName;
+    result_.driverVersion = properties.driverVersion;
+    result_.memoryBudget = vulkanDevice_->isMemoryBudgetEnabled();
+
+    // Only LOD 0 is drawn, and without cluster culling
+    ModelLoader::Options options;
+    options.buildLods = false;
+    options.buildMeshlets = false;
+    options.assetPack = assetPack_.get();
+    options.fileReader = fileReader_.get();
+    mesh_ = ModelLoader::loadObj(MODEL_PATH, options);
+    vulkanPipeline_->setVertexFormat(mesh_.format);
+
+    uint32_t meshSlots = scenario_.type == BenchmarkScenario::Type::Churn ? CHURN_MESH_SLOTS : 1;
+    // Room for the copies unloaded during the last frames in flight, which are freed later
+    uint32_t poolSlots = meshSlots + config_.maxFramesInFlight;
+    geometryPool_ = std::make_unique<GeometryPool>();
+    geometryPool_->initialize(*vulkanDevice_, *bufferManager_, mesh_.vertexStride(),
+                              static_cast<uint32_t>(mesh_.vertexCount()) * poolSlots,
+                              static_cast<uint32_t>(mesh_.indices.size()) * poolSlots);
+    for (uint32_t i = 0; i < meshSlots; i++) {
+        meshes_.push_back(geometryPool_->allocate(mesh_.vertexData(), static_cast<uint32_t>(mesh_.vertexCount()), mesh_.indices));
+    }
+
+    bufferManager_->createUniformBuffer(config_.maxFramesInFlight, uniformBuffers_, uniformBuffersMemory_, uniformBuffersMapped_);
+    textureSampler_ = textureManager_->createTextureSampler();
+
+    // Sets of unloaded textures are not freed, so the pool holds one group per texture ever loaded
+    uint32_t textureCount = std::max(scenario_.textureCount, 1u);
+    uint32_t loadCount = textureCount;
+    if (scenario_.type == BenchmarkScenario::Type::Churn && scenario_.eventInterval > 0) {
+        loadCount += (scenario_.warmupFrames + scenario_.measuredFrames) / scenario_.eventInterval + 1;
+    }
+    descriptorManager_->createDescriptorPool(config_.maxFramesInFlight * loadCount);
+
+    textures_.resize(textureCount);
+    for (uint32_t i = 0; i < textureCount; i++) {
+        createTexture(i, textures_[i]);
+    }
+
+    // Instances are grouped by texture, so the descriptor set only changes between groups
+    uint32_t instanceCount = std::max(scenario_.instanceCount, 1u);
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(instanceCount))));
+    float origin = (side - 1) * INSTANCE_SPACING * 0.5f;
+    Scene::NodeId grid = scene_.createNode();
+    for (uint32_t i = 0; i < instanceCount; i++) {
+        Scene::NodeId node = scene_.createNode(grid, glm::vec3((i % side) * INSTANCE_SPACING - origin, (i / side) * INSTANCE_SPACING - origin, 0.0f));
+        scene_.setMesh(node, i % meshSlots, static_cast<uint32_t>(static_cast<uint64_t>(i) * textureCount / instanceCount));
+        instanceNodes_.push_back(node);
+    }
+
+    gpuTimer_ = std::make_unique<GpuTimer>();
+    gpuTimer_->initialize(*vulkanDevice_, config_.maxFramesInFlight);
+
+    if (captureLastFrame_) {
+        if (!(vulkanSwapchain_->getImageUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) ||
+            !FrameReadback::isFormatSupported(vulkanSwapchain_->getImageFormat())) {
+            throw std::runtime_error("swapchain images cannot be read back!");
+        }
+        frameReadback_ = std::make_unique<FrameReadback>();
+        frameReadback_->initialize(*vulkanDevice_, *bufferManager_, 1);
+    }
+
+    renderGraph_ = std::make_unique<RenderGraph>();
+    renderGraph_->initialize(*vulkanDevice_);
+    buildRenderGraph();
+
+    gpuFrameSeries_ = metrics_->addSeries("GPU frame time", Metrics::Category::Frame);
+    drawSeries_ = metrics_->addSeries("draw calls", Metrics::Category::Counter);
+    triangleSeries_ = metrics_->addSeries("triangles", Metrics::Category::Counter);
+
+    if (scenario_.warmupFrames == 0) {
+        beginMeasurement();
+    }
+}
+
+void BenchmarkApp::createTexture(uint32_t seed, Texture& texture) {
+    if (scenario_.textureSize == 0) {
+        textureManager_->createTextureFromFile(TEXTURE_PATH, texture.image, texture.memory, texture.view);
+    } else {
+        // Checkerboard in two colors derived from the seed, the same on every run
+        uint32_t size = scenario_.textureSize;
+        uint32_t colorA = hashSeed(seed * 2 + 1) | 0xff000000u;
+        uint32_t colorB = hashSeed(seed * 2 + 2) | 0xff000000u;
+        std::vector<uint32_t> pixels(static_cast<size_t>(size) * size);
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                pixels[static_cast<size_t>(y) * size + x] = ((x / 32 + y / 32) & 1) ? colorA : colorB;
+            }
+        }
+        textureManager_->createTextureFromPixels(reinterpret_cast<const uint8_t*>(pixels.data()), size, size,
+                                                 texture.image, texture.memory, texture.view);
+    }
+    descriptorManager_->createDescriptorSets(vulkanPipeline_->getDescriptorSetLayout(), config_.maxFramesInFlight,
+                                             uniformBuffers_, texture.view, textureSampler_, texture.descriptorSets);
+}
+
+void BenchmarkApp::destroyTexture(Texture& texture) {
+    textureManager_->destroyImageView(texture.view);
+    textureManager_->destroyImage(texture.image, texture.memory);
+    texture.descriptorSets.clear();
+}
+
+void BenchmarkApp::onSwapchainRecreated() {
+    buildRenderGraph();
+}
+
+void BenchmarkApp::updateUniforms(uint32_t currentImage) {
+    releaseRetired(false);
+    if (scenario_.type != BenchmarkScenario::Type::Instances && scenario_.type != BenchmarkScenario::Type::Textures &&
+        scenario_.eventInterval > 0 && frameIndex_ > 0 && frameIndex_ % scenario_.eventInterval == 0) {
+        runScenarioEvent(static_cast<uint32_t>(frameIndex_ / scenario_.eventInterval - 1));
+    }
+
+    // Camera distance fits the whole grid at any aspect ratio the resize storm produces
+    VkExtent2D extent = vulkanSwapchain_->getExtent();
+    float gridSize = std::ceil(std::sqrt(static_cast<float>(instanceNodes_.size()))) * INSTANCE_SPACING;
+    float distance = std::max(gridSize, 2.0f) * 1.2f;
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, -distance, distance), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), extent.width / static_cast<float>(extent.height), 0.1f, distance * 4.0f);
+    proj[1][1] *= -1;
+    viewProj_ = proj * view;
+    // Driven by the frame index, not the clock, so every run draws the same frames
+    rotation_ = frameIndex_ * 0.01f;
+    for (size_t i = 0; i < instanceNodes_.size(); i++) {
+        scene_.setRotation(instanceNodes_[i], glm::angleAxis(rotation_ + i * 0.1f, glm::vec3(0.0f, 0.0f, 1.0f)));
+    }
+    scene_.update();
+
+    UniformBufferObject ubo{};
+    ubo.viewProj = viewProj_;
+    memcpy(uniformBuffersMapped_[currentImage], &ubo, sizeof(ubo));
+}
+
+void BenchmarkApp::recordRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
+    commandManager_->resetCommandBuffer(currentFrame_);
+    commandManager_->beginCommandBuffer(commandBuffer);
+
+    // The fence of this slot has signaled, so its previous frame's timestamps are available
+    double gpuFrameMs;
+    if (gpuTimer_->getFrameTime(currentFrame_, gpuFrameMs)) {
+        metrics_->record(gpuFrameSeries_, static_cast<float>(gpuFrameMs));
+    }
+    if (metrics_->isEnabled()) {
+        for (uint32_t passIndex = 0; passIndex < renderGraph_->getPassCount(); passIndex++) {
+            double passMs;
+            if (renderGraph_->getPassTime(passIndex, currentFrame_, passMs)) {
+                metrics_->record(passSeries_[passIndex], static_cast<float>(passMs));
+            }
+        }
+    }
+    // Also written during warmup, so the first measured frames already have pass times to read back
+    renderGraph_->setPassTimingEnabled(true, config_.maxFramesInFlight);
+
+    drawCount_ = 0;
+    triangleCount_ = 0;
+    imageIndex_ = imageIndex;
+    gpuTimer_->begin(commandBuffer, currentFrame_);
+    renderGraph_->execute(commandBuffer, currentFrame_, imageIndex);
+    gpuTimer_->end(commandBuffer, currentFrame_);
+    metrics_->record(drawSeries_, static_cast<float>(drawCount_));
+    metrics_->record(triangleSeries_, static_cast<float>(triangleCount_));
+
+    VkResult result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("Failed to end command buffer recording!");
+    }
+
+    if (measuring_) {
+        sampleMemory();
+    }
+    frameIndex_++;
+}
+
+void BenchmarkApp::onFrameEnd() {
+    // The metrics switch between frames, so every measured frame records all of its phases,
+    // submission and present included
+    if (!measuring_ && !result_.completed && frameIndex_ == scenario_.warmupFrames) {
+        beginMeasurement();
+    }
+    if (measuring_ && frameIndex_ == static_cast<uint64_t>(scenario_.warmupFrames) + scenario_.measuredFrames) {
+        finishMeasurement();
+    }
+}
+
+void BenchmarkApp::onCleanup() {
+    // The device is idle, so the capture of the last frame has landed
+    if (frameReadback_) {
+        frameReadback_->readImage(UINT64_MAX, capture_);
+        frameReadback_.reset();
+    }
+
+    releaseRetired(true);
+    renderGraph_.reset();
+    gpuTimer_.reset();
+
+    for (Texture& texture : textures_) {
+        destroyTexture(texture);
+    }
+    textures_.clear();
+    textureManager_->destroySampler(textureSampler_);
+
+    geometryPool_.reset();
+    for (size_t i = 0; i < uniformBuffers_.size(); i++) {
+        bufferManager_->destroyBuffer(uniformBuffers_[i], uniformBuffersMemory_[i]);
+    }
+
+    descriptorManager_->destroyDescriptorPool();
+}
+
+void BenchmarkApp::buildRenderGraph() {
+    renderGraph_->reset();
+
+    VkExtent2D extent = vulkanSwapchain_->getExtent();
+    RenderGraph::ImportedImage backbufferImage;
+    backbufferImage.images = vulkanSwapchain_->getImages();
+    backbufferImage.views = vulkanSwapchain_->getImageViews();
+    backbufferImage.format = vulkanSwapchain_->getImageFormat();
+    backbufferImage.extent = extent;
+    backbufferImage.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    backbufferImage.waitStage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    RenderGraph::ResourceHandle backbuffer = renderGraph_->importImage("backbuffer", backbufferImage);
+
+    RenderGraph::ImageDesc depthDesc;
+    depthDesc.format = vulkanPipeline_->getDepthFormat();
+    depthDesc.extent = extent;
+    RenderGraph::ResourceHandle depth = renderGraph_->createImage("depth", depthDesc);
+
+    renderGraph_->addPass("main",
+        [&](RenderGraph::PassBuilder& builder) {
+            builder.writeColor(backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, {{0.0f, 0.0f, 0.0f, 1.0f}});
+            builder.writeDepth(depth);
+        },
+        [this](VkCommandBuffer commandBuffer) {
+            drawInstances(commandBuffer);
+        });
+
+    // Only in golden image test mode: the copy's barriers would otherwise be part of every measured frame
+    if (frameReadback_) {
+        renderGraph_->addPass("readback",
+            [&](RenderGraph::PassBuilder& builder) {
+                builder.read(backbuffer, RenderGraph::ResourceUsage::TransferSrc);
+                builder.setSideEffect();
+            },
+            [this, backbuffer](VkCommandBuffer commandBuffer) {
+                if (frameIndex_ + 1 != static_cast<uint64_t>(scenario_.warmupFrames) + scenario_.measuredFrames) {
+                    return;
+                }
+                frameReadback_->copyImage(commandBuffer, getFrameNumber(), renderGraph_->getImage(backbuffer, imageIndex_),
+                                          vulkanSwapchain_->getImageFormat(), vulkanSwapchain_->getExtent());
+            });
+    }
+
+    renderGraph_->compile();
+    passSeries_.clear();
+    for (uint32_t passIndex = 0; passIndex < renderGraph_->getPassCount(); passIndex++) {
+        passSeries_.push_back(metrics_->addSeries(renderGraph_->getPassName(passIndex), Metrics::Category::GpuPass));
+    }
+    result_.peakTransientBytes = std::max(result_.peakTransientBytes, renderGraph_->getTransientBytesAllocated());
+}
+
+void BenchmarkApp::drawInstances(VkCommandBuffer commandBuffer) {
+    const QuantizationParams* quantization = mesh_.format == VertexFormat::Compact ? &mesh_.quantization : nullptr;
+    const MeshLod& lod = mesh_.lods[0];
+    VkPipelineLayout pipelineLayout = vulkanPipeline_->getPipelineLayout();
+
+    // The scene is walked in storage order; nodes without a mesh are skipped
+    const glm::mat4* worldMatrices = scene_.getWorldMatrices();
+    const uint32_t* meshes = scene_.getStorageMeshes();
+    const uint32_t* materials = scene_.getStorageMaterials();
+    uint32_t boundTexture = scene_.getMaterial(instanceNodes_.front());
+    commandManager_->bindGeometry(commandBuffer, vulkanSwapchain_->getExtent(),
+                                  vulkanPipeline_->getGraphicsPipeline(), pipelineLayout,
+                                  geometryPool_->getVertexBuffer(), geometryPool_->getIndexBuffer(),
+                                  textures_[boundTexture].descriptorSets[currentFrame_]);
+
+    for (uint32_t i = 0; i < scene_.getStorageCount(); i++) {
+        if (meshes[i] == Scene::NONE) {
+            continue;
+        }
+        if (materials[i] != boundTexture) {
+            boundTexture = materials[i];
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                                    &textures_[boundTexture].descriptorSets[currentFrame_], 0, nullptr);
+        }
+
+        commandManager_->pushDrawConstants(commandBuffer, pipelineLayout, worldMatrices[i], quantization);
+
+        const MeshAllocation& allocation = meshes_[meshes[i]];
+        vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, allocation.firstIndex + lod.firstIndex, allocation.vertexOffset, 0);
+        drawCount_++;
+        triangleCount_ += lod.indexCount / 3;
+    }
+}
+
+void BenchmarkApp::runScenarioEvent(uint32_t event) {
+    if (scenario_.type == BenchmarkScenario::Type::ResizeStorm) {
+        float scale = RESIZE_SCALES[event % RESIZE_SCALES.size()];
+        requestResize(std::max(static_cast<uint32_t>(scenario_.width * scale), 1u),
+                      std::max(static_cast<uint32_t>(scenario_.height * scale), 1u));
+        if (measuring_) {
+            result_.resizeCount++;
+        }
+        return;
+    }
+
+    // Churn: unload one mesh and one texture and load them again. Frames in flight may still draw
+    // the old ones, so they are destroyed once those frames have finished.
+    uint64_t releaseFrame = frameIndex_ + config_.maxFramesInFlight;
+
+    uint32_t meshSlot = event % static_cast<uint32_t>(meshes_.size());
+    MeshAllocation oldMesh = meshes_[meshSlot];
+    meshes_[meshSlot] = geometryPool_->allocate(mesh_.vertexData(), static_cast<uint32_t>(mesh_.vertexCount()), mesh_.indices);
+    retired_.push_back({releaseFrame, [this, oldMesh]() { geometryPool_->free(oldMesh); }});
+
+    uint32_t textureSlot = event % static_cast<uint32_t>(textures_.size());
+    Texture oldTexture = textures_[textureSlot];
+    createTexture(static_cast<uint32_t>(textures_.size()) + event, textures_[textureSlot]);
+    retired_.push_back({releaseFrame, [this, oldTexture]() mutable { destroyTexture(oldTexture); }});
+
+    if (measuring_) {
+        result_.churnCount++;
+    }
+}
+
+void BenchmarkApp::releaseRetired(bool all) {
+    auto released = std::remove_if(retired_.begin(), retired_.end(), [this, all](Retired& retired) {
+        if (!all && retired.frame > frameIndex_) {
+            return false;
+        }
+        retired.destroy();
+        return true;
+    });
+    retired_.erase(released, retired_.end());
+}
+
+void BenchmarkApp::beginMeasurement() {
+    std::vector<MemoryHeapUsage> heaps = vulkanDevice_->getMemoryHeapUsage();
+    result_.heaps.clear();
+    for (uint32_t i = 0; i < heaps.size(); i++) {
+        BenchmarkResult::Heap heap;
+        heap.index = i;
+        heap.deviceLocal = (heaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heap.size = heaps[i].size;
+        heap.peakUsage = heaps[i].usage;
+        result_.heaps.push_back(heap);
+    }
+    // Transient memory of the graphs built while measuring
+    result_.peakTransientBytes = renderGraph_->getTransientBytesAllocated();
+
+    metrics_->clear();
+    metrics_->setEnabled(true);
+    measuring_ = true;
+    measureStart_ = std::chrono::steady_clock::now();
+    std::cout << "Benchmark " << scenario_.name << " - measuring " << scenario_.measuredFrames << " frames" << std::endl;
+}
+
+void BenchmarkApp::sampleMemory() {
+    std::vector<MemoryHeapUsage> heaps = vulkanDevice_->getMemoryHeapUsage();
+    for (size_t i = 0; i < heaps.size() && i < result_.heaps.size(); i++) {
+        result_.heaps[i].peakUsage = std::max(result_.heaps[i].peakUsage, heaps[i].usage);
+    }
+}
+
+void BenchmarkApp::finishMeasurement() {
+    result_.wallTimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart_).count();
+    metrics_->setEnabled(false);
+    measuring_ = false;
+
+    for (Metrics::SeriesId id = 0; id < metrics_->getSeriesCount(); id++) {
+        BenchmarkResult::Timing timing{metrics_->getName(id), metrics_->getStats(id)};
+        switch (metrics_->getCategory(id)) {
+            case Metrics::Category::Frame:
+                if (id == gpuFrameSeries_) {
+                    result_.gpuFrameTime = timing.stats;
+                } else {
+                    result_.frameTime = timing.stats;
+                }
+                break;
+            case Metrics::Category::CpuPhase:
+                result_.cpuPhases.push_back(timing);
+                break;
+            case Metrics::Category::GpuPass:
+                result_.gpuPasses.push_back(timing);
+                break;
+            case Metrics::Category::Counter:
+                result_.counters.push_back(timing);
+                break;
+        }
+    }
+
+    result_.completed = true;
+    std::cout << "Benchmark " << scenario_.name << " - " << result_.frameTime.average << " ms average, "
+              << result_.frameTime.p99 << " ms p99" << std::endl;
+    requestClose();
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BenchmarkScenario.h"
+#include "../core/VulkanApplication.h"
+#include "../core/Metrics.h"
+#include "../common/ImageTypes.h"
+#include "../resources/ModelLoader.h"
+#include "../resources/GeometryPool.h"
+#include "../scene/Scene.h"
+
+class RenderGraph;
+class GpuTimer;
+class FrameReadback;
+
+struct BenchmarkResult {
+    struct Timing {
+        std::string name;
+        Metrics::Stats stats;
+    };
+
+    struct Heap {
+        uint32_t index = 0;
+        bool deviceLocal = false;
+        VkDeviceSize size = 0;
+        // Highest usage sampled during the measured frames, 0 without VK_EXT_memory_budget
+        VkDeviceSize peakUsage = 0;
+    };
+
+    std::string scenario;
+    std::string type;
+    std::string deviceName;
+    uint32_t driverVersion = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t warmupFrames = 0;
+    uint32_t measuredFrames = 0;
+    double wallTimeSeconds = 0.0;
+
+    Metrics::Stats frameTime;
+    Metrics::Stats gpuFrameTime;
+    std::vector<Timing> cpuPhases;
+    std::vector<Timing> gpuPasses;
+    std::vector<Timing> counters;
+
+    bool memoryBudget = false;
+    std::vector<Heap> heaps;
+    VkDeviceSize peakTransientBytes = 0;
+    uint32_t resizeCount = 0;
+    uint32_t churnCount = 0;
+    bool completed = false;
+
+    // Golden image test mode, see ImageCompare. Empty status when not compared.
+    std::string goldenStatus;
+    uint32_t goldenMismatchedPixels = 0;
+    double goldenMismatchRatio = 0.0;
+    float goldenMaxDifference = 0.0f;
+};
+
+// Drives VulkanApplication headless through one BenchmarkScenario: warmupFrames frames that are not
+// measured, then measuredFrames frames with every metric recorded, then the app closes itself.
+// The scene is a grid of instances of the model, rendered by a render graph with a single pass.
+class BenchmarkApp : public VulkanApplication {
+    public:
+        // With captureLastFrame, the last measured frame is read back for golden image tests
+        explicit BenchmarkApp(const BenchmarkScenario& scenario, bool captureLastFrame = false);
+        ~BenchmarkApp();
+
+        // Filled once the measured frames are done
+        const BenchmarkResult& getResult() const { return result_; }
+        // Empty unless captureLastFrame was set and the app ran to the end
+        const ImageRgba8& getCapture() const { return capture_; }
+
+    protected:
+        void initializeResources() override;
+        void updateUniforms(uint32_t currentImage) override;
+        void recordRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
+        void onSwapchainRecreated() override;
+        void onFrameEnd() override;
+        void onCleanup() override;
+
+    private:
+        struct Texture {
+            VkImage image = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+            std::vector<VkDescriptorSet> descriptorSets;
+        };
+
+        // Resource replaced while frames in flight may still use it, destroyed after `frame`
+        struct Retired {
+            uint64_t frame = 0;
+            std::function<void()> destroy;
+        };
+
+        static Config makeConfig(const BenchmarkScenario& scenario);
+
+        void createTexture(uint32_t seed, Texture& texture);
+        void destroyTexture(Texture& texture);
+        void buildRenderGraph();
+        void drawInstances(VkCommandBuffer commandBuffer);
+        // Resize or reload, every eventInterval frames
+        void runScenarioEvent(uint32_t event);
+        void beginMeasurement();
+        void finishMeasurement();
+        void sampleMemory();
+        void releaseRetired(bool all);
+
+        BenchmarkScenario scenario_;
+        BenchmarkResult result_;
+
+        MeshData mesh_;
+        std::unique_ptr<GeometryPool> geometryPool_;
+        std::vector<MeshAllocation> meshes_;
+        std::vector<Texture> textures_;
+        // A grid node with one child per instance, drawn with the instance's mesh slot and texture
+        Scene scene_;
+        std::vector<Scene::NodeId> instanceNodes_;
+        std::vector<Retired> retired_;
+        VkSampler textureSampler_ = VK_NULL_HANDLE;
+
+        std::vector<VkBuffer> uniformBuffers_;
+        std::vector<VkDeviceMemory> uniformBuffersMemory_;
+        std::vector<void*> uniformBuffersMapped_;
+
+        std::unique_ptr<RenderGraph> renderGraph_;
+        std::unique_ptr<GpuTimer> gpuTimer_;
+        std::unique_ptr<FrameReadback> frameReadback_;
+        bool captureLastFrame_ = false;
+        // Last frame's color, read once the device is idle
+        ImageRgba8 capture_;
+        uint32_t imageIndex_ = 0;
+
+        uint64_t frameIndex_ = 0;
+        bool measuring_ = false;
+        std::chrono::steady_clock::time_point measureStart_;
+        glm::mat4 viewProj_{1.0f};
+        float rotation_ = 0.0f;
+        uint32_t drawCount_ = 0;
+        uint64_t triangleCount_ = 0;
+        Metrics::SeriesId gpuFrameSeries_ = 0;
+        Metrics::SeriesId drawSeries_ = 0;
+        Metrics::SeriesId triangleSeries_ = 0;
+        // By render graph pass index, resolved whenever the graph is rebuilt
+        std::vector<Metrics::SeriesId> passSeries_;
+};
@@ -0,0 +1,130 @@
+#include "BenchmarkReport.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+void BenchmarkReport::write(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << "{\n  \"scenarios\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        out << (i > 0 ? ",\n" : "\n") << "    {\n";
+        out << "      \"name\": ";
+        writeString(out, result.scenario);
+        out << ",\n      \"type\": ";
+        writeString(out, result.type);
+        out << ",\n      \"device\": ";
+        writeString(out, result.deviceName);
+        out << ",\n      \"driverVersion\": " << result.driverVersion;
+        out << ",\n      \"completed\": " << (result.completed ? "true" : "false");
+        out << ",\n      \"width\": " << result.width;
+        out << ",\n      \"height\": " << result.height;
+        out << ",\n      \"warmupFrames\": " << result.warmupFrames;
+        out << ",\n      \"measuredFrames\": " << result.measuredFrames;
+        out << ",\n      \"wallTimeSeconds\": ";
+        writeNumber(out, result.wallTimeSeconds);
+        out << ",\n      \"resizes\": " << result.resizeCount;
+        out << ",\n      \"reloads\": " << result.churnCount;
+        out << ",\n      \"frameTime\": ";
+        writeStats(out, result.frameTime);
+        out << ",\n      \"gpuFrameTime\": ";
+        writeStats(out, result.gpuFrameTime);
+        out << ",\n      \"cpuPhases\": ";
+        writeTimings(out, result.cpuPhases, "      ");
+        out << ",\n      \"gpuPasses\": ";
+        writeTimings(out, result.gpuPasses, "      ");
+        out << ",\n      \"counters\": ";
+        writeTimings(out, result.counters, "      ");
+
+        out << ",\n      \"memory\": {\n";
+        out << "        \"budgetExtension\": " << (result.memoryBudget ? "true" : "false") << ",\n";
+        out << "        \"peakTransientBytes\": " << result.peakTransientBytes << ",\n";
+        out << "        \"heaps\": [";
+        for (size_t h = 0; h < result.heaps.size(); h++) {
+            const BenchmarkResult::Heap& heap = result.heaps[h];
+            out << (h > 0 ? "," : "") << "\n          {\"index\": " << heap.index
+                << ", \"deviceLocal\": " << (heap.deviceLocal ? "true" : "false")
+                << ", \"size\": " << heap.size << ", \"peakUsage\": " << heap.peakUsage << "}";
+        }
+        out << (result.heaps.empty() ? "]" : "\n        ]") << "\n      }";
+
+        if (!result.goldenStatus.empty()) {
+            out << ",\n      \"golden\": {\"status\": ";
+            writeString(out, result.goldenStatus);
+            out << ", \"mismatchedPixels\": " << result.goldenMismatchedPixels << ", \"mismatchRatio\": ";
+            writeNumber(out, result.goldenMismatchRatio);
+            out << ", \"maxDifference\": ";
+            writeNumber(out, result.goldenMaxDifference);
+            out << "}";
+        }
+        out << "\n    }";
+    }
+    out << (results.empty() ? "]" : "\n  ]") << "\n}\n";
+}
+
+void BenchmarkReport::writeFile(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open benchmark output file: " + path);
+    }
+    write(file, results);
+    if (!file.good()) {
+        throw std::runtime_error("Failed to write benchmark output file: " + path);
+    }
+}
+
+void BenchmarkReport::writeString(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+void BenchmarkReport::writeNumber(std::ostream& out, double value) {
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+void BenchmarkReport::writeStats(std::ostream& out, const Metrics::Stats& stats) {
+    out << "{\"count\": " << stats.count << ", \"average\": ";
+    writeNumber(out, stats.average);
+    out << ", \"min\": ";
+    writeNumber(out, stats.min);
+    out << ", \"max\": ";
+    writeNumber(out, stats.max);
+    out << ", \"p50\": ";
+    writeNumber(out, stats.p50);
+    out << ", \"p95\": ";
+    writeNumber(out, stats.p95);
+    out << ", \"p99\": ";
+    writeNumber(out, stats.p99);
+    out << "}";
+}
+
+void BenchmarkReport::writeTimings(std::ostream& out, const std::vector<BenchmarkResult::Timing>& timings, const char* indent) {
+    out << "{";
+    for (size_t i = 0; i < timings.size(); i++) {
+        out << (i > 0 ? ",\n" : "\n") << indent << "  ";
+        writeString(out, timings[i].name);
+        out << ": ";
+        writeStats(out, timings[i].stats);
+    }
+    out << (timings.empty() ? "}" : "\n" + std::string(indent) + "}");
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BenchmarkApp.h"
+
+// Writes benchmark results as JSON, one object per scenario, for tracking across commits on CI.
+// Times are in milliseconds and sizes in bytes.
+class BenchmarkReport {
+    public:
+        static void write(std::ostream& out, const std::vector<BenchmarkResult>& results);
+        static void writeFile(const std::string& path, const std::vector<BenchmarkResult>& results);
+
+    private:
+        static void writeString(std::ostream& out, const std::string& value);
+        // JSON has no NaN or infinity; those are written as null
+        static void writeNumber(std::ostream& out, double value);
+        static void writeStats(std::ostream& out, const Metrics::Stats& stats);
+        static void writeTimings(std::ostream& out, const std::vector<BenchmarkResult::Timing>& timings, const char* indent);
+};
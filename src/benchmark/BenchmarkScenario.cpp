@@ -0,0 +1,47 @@
+#include "BenchmarkScenario.h"
+
+std::vector<BenchmarkScenario> BenchmarkScenario::getDefaultScenarios() {
+    std::vector<BenchmarkScenario> scenarios;
+
+    BenchmarkScenario instances;
+    instances.name = "instances_256";
+    instances.type = Type::Instances;
+    instances.instanceCount = 256;
+    scenarios.push_back(instances);
+
+    BenchmarkScenario textures;
+    textures.name = "textures_64";
+    textures.type = Type::Textures;
+    textures.instanceCount = 64;
+    textures.textureCount = 64;
+    textures.textureSize = 1024;
+    scenarios.push_back(textures);
+
+    BenchmarkScenario resize;
+    resize.name = "resize_storm";
+    resize.type = Type::ResizeStorm;
+    resize.instanceCount = 16;
+    resize.eventInterval = 10;
+    scenarios.push_back(resize);
+
+    BenchmarkScenario churn;
+    churn.name = "load_unload_churn";
+    churn.type = Type::Churn;
+    churn.instanceCount = 16;
+    churn.textureCount = 4;
+    churn.textureSize = 512;
+    churn.eventInterval = 5;
+    scenarios.push_back(churn);
+
+    return scenarios;
+}
+
+const char* BenchmarkScenario::getTypeName(Type type) {
+    switch (type) {
+        case Type::Instances: return "instances";
+        case Type::Textures: return "textures";
+        case Type::ResizeStorm: return "resize_storm";
+        case Type::Churn: return "churn";
+    }
+    return "unknown";
+}
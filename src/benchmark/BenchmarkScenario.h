@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A scripted, deterministic workload for the benchmark harness. Everything that moves is driven by
+// the frame index, never by wall clock time, so two runs on the same machine draw the same frames.
+struct BenchmarkScenario {
+    enum class Type {
+        Instances,      // instanceCount copies of the model sharing one texture
+        Textures,       // instanceCount copies spread over textureCount generated textures
+        ResizeStorm,    // the swapchain is resized every eventInterval frames
+        Churn           // every eventInterval frames a mesh and a texture are unloaded and loaded again
+    };
+
+    std::string name;
+    Type type = Type::Instances;
+    uint32_t instanceCount = 1;
+    uint32_t textureCount = 1;
+    // Edge length of the generated textures; 0 uses the model's texture file
+    uint32_t textureSize = 0;
+    uint32_t eventInterval = 10;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    uint32_t warmupFrames = 60;
+    uint32_t measuredFrames = 600;
+    // Load the model and texture from this pack (see vulkan_packer) instead of loose files
+    std::string assetPackPath;
+
+    static std::vector<BenchmarkScenario> getDefaultScenarios();
+    static const char* getTypeName(Type type);
+};
@@ -0,0 +1,69 @@
+#include "ImageCompare.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // YIQ distance between black and white, the largest possible
+    const float MAX_YIQ_DISTANCE = 35215.0f;
+}
+
+ImageCompare::Result ImageCompare::compare(const ImageRgba8& image, const ImageRgba8& golden, const Options& options, ImageRgba8* diff) {
+    Result result;
+    result.sizeMatches = image.width == golden.width && image.height == golden.height &&
+                         image.pixels.size() == golden.pixels.size();
+    if (!result.sizeMatches) {
+        return result;
+    }
+
+    if (diff) {
+        diff->width = golden.width;
+        diff->height = golden.height;
+        diff->pixels.resize(golden.pixels.size());
+    }
+
+    float maxDistance = MAX_YIQ_DISTANCE * options.threshold * options.threshold;
+    float largest = 0.0f;
+    size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+    for (size_t i = 0; i < pixelCount; i++) {
+        const uint8_t* a = &image.pixels[i * 4];
+        const uint8_t* b = &golden.pixels[i * 4];
+        float distance = colorDistance(a, b);
+        largest = std::max(largest, distance);
+        bool mismatch = distance > maxDistance;
+        if (mismatch) {
+            result.mismatchedPixels++;
+        }
+
+        if (diff) {
+            uint8_t* out = &diff->pixels[i * 4];
+            if (mismatch) {
+                out[0] = 255;
+                out[1] = 0;
+                out[2] = 0;
+            } else {
+                uint8_t gray = static_cast<uint8_t>(255 - (255 - (b[0] * 77 + b[1] * 150 + b[2] * 29) / 256) / 4);
+                out[0] = out[1] = out[2] = gray;
+            }
+            out[3] = 255;
+        }
+    }
+
+    result.mismatchRatio = pixelCount > 0 ? static_cast<double>(result.mismatchedPixels) / pixelCount : 0.0;
+    result.maxDifference = std::sqrt(largest / MAX_YIQ_DISTANCE);
+    result.passed = result.mismatchRatio <= options.maxMismatchRatio;
+    return result;
+}
+
+float ImageCompare::colorDistance(const uint8_t* a, const uint8_t* b) {
+    float r = static_cast<float>(a[0]) - b[0];
+    float g = static_cast<float>(a[1]) - b[1];
+    float bl = static_cast<float>(a[2]) - b[2];
+    if (r == 0.0f && g == 0.0f && bl == 0.0f) {
+        return 0.0f;
+    }
+
+    float y = r * 0.29889531f + g * 0.58662247f + bl * 0.11448223f;
+    float i = r * 0.59597799f - g * 0.27417610f - bl * 0.32180189f;
+    float q = r * 0.21147017f - g * 0.52261711f + bl * 0.31114694f;
+    return 0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include "../common/ImageTypes.h"
+
+// Perceptual comparison of a rendered frame against a golden image. Pixel differences are measured
+// as the YIQ color distance of Kotsarenko and Ramos (as in pixelmatch), which weights luma over
+// chroma roughly like the eye does, so small shifts in hue pass where a change in brightness fails.
+// Alpha is ignored: swapchain alpha is undefined for presentation.
+class ImageCompare {
+    public:
+        struct Options {
+            // Per pixel tolerance in [0, 1] of the largest possible YIQ distance; 0.1 hides rounding
+            // and filtering differences between drivers while catching visible changes
+            float threshold = 0.1f;
+            // Fraction of pixels allowed over the threshold, e.g. for rasterization differences
+            // along edges
+            double maxMismatchRatio = 0.001;
+        };
+
+        struct Result {
+            bool sizeMatches = false;
+            uint32_t mismatchedPixels = 0;
+            double mismatchRatio = 0.0;
+            // Largest per pixel distance, on the same scale as the threshold
+            float maxDifference = 0.0f;
+            bool passed = false;
+        };
+
+        // diff, when given, shows mismatched pixels in red over a faded grayscale copy of the golden
+        static Result compare(const ImageRgba8& image, const ImageRgba8& golden, const Options& options, ImageRgba8* diff = nullptr);
+
+    private:
+        static float colorDistance(const uint8_t* a, const uint8_t* b);
+};
@@ -0,0 +1,136 @@
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "TransformBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "../scene/TransformSystem.h"
+
+namespace {
+    // Each case repeats until it has run this long, so small counts are still measured reliably
+    const double MIN_SECONDS = 0.25;
+
+    struct Euler {
+        glm::vec3 position;
+        glm::vec3 degrees;
+        glm::vec3 scale;
+    };
+
+    struct Transform {
+        glm::vec3 position;
+        glm::quat rotation;
+        glm::vec3 scale;
+    };
+
+    glm::mat4 composeEuler(const Euler& transform) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.position);
+        model = glm::rotate(model, glm::radians(transform.degrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(transform.degrees.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(transform.degrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        return glm::scale(model, transform.scale);
+    }
+
+    // translate * mat4_cast(rotation) * scale, without multiplying out the identity parts
+    glm::mat4 composeGlm(const Transform& transform) {
+        glm::mat4 model = glm::mat4_cast(transform.rotation);
+        model[0] *= transform.scale.x;
+        model[1] *= transform.scale.y;
+        model[2] *= transform.scale.z;
+        model[3] = glm::vec4(transform.position, 1.0f);
+        return model;
+    }
+
+    // Runs pass until MIN_SECONDS have passed, returns the number of items per second
+    template <typename Pass>
+    double measure(uint32_t itemsPerPass, Pass pass) {
+        using Clock = std::chrono::steady_clock;
+        uint64_t passes = 0;
+        Clock::time_point start = Clock::now();
+        double seconds = 0.0;
+        do {
+            pass();
+            passes++;
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (seconds < MIN_SECONDS);
+        return static_cast<double>(passes) * itemsPerPass / seconds;
+    }
+}
+
+TransformBenchmark::Result TransformBenchmark::run(uint32_t count) {
+    count = std::max(count, 1u);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> positions(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angles(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> scales(0.5f, 2.0f);
+
+    std::vector<Euler> eulers(count);
+    std::vector<Transform> quaternions(count);
+    TransformSystem transforms;
+    for (uint32_t i = 0; i < count; i++) {
+        Euler& euler = eulers[i];
+        euler.position = glm::vec3(positions(random), positions(random), positions(random));
+        euler.degrees = glm::vec3(angles(random), angles(random), angles(random));
+        euler.scale = glm::vec3(scales(random), scales(random), scales(random));
+        // Same order as composeEuler: x * y * z
+        glm::quat rotation = glm::angleAxis(glm::radians(euler.degrees.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+                   glm::angleAxis(glm::radians(euler.degrees.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                   glm::angleAxis(glm::radians(euler.degrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        quaternions[i] = {euler.position, rotation, euler.scale};
+        transforms.create(euler.position, rotation, euler.scale);
+    }
+
+    Result result;
+    std::vector<glm::mat4> glmMatrices(count);
+    std::vector<glm::mat4> batchMatrices(count);
+    result.eulerRate = measure(count, [&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            glmMatrices[i] = composeEuler(eulers[i]);
+        }
+    });
+    result.glmRate = measure(count, [&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            glmMatrices[i] = composeGlm(quaternions[i]);
+        }
+    });
+    result.batchRate = measure(count, [&]() {
+        transforms.invalidate();
+        transforms.update(batchMatrices.data());
+    });
+
+    for (uint32_t i = 0; i < count; i++) {
+        for (int column = 0; column < 4; column++) {
+            for (int row = 0; row < 4; row++) {
+                result.maxError = std::max(result.maxError, std::abs(glmMatrices[i][column][row] - batchMatrices[i][column][row]));
+            }
+        }
+    }
+
+    // Moves a different 1% of the objects each pass
+    uint32_t stride = 100;
+    uint32_t offset = 0;
+    result.sparseRate = measure(count, [&]() {
+        for (uint32_t i = offset; i < count; i += stride) {
+            transforms.setPosition(i, eulers[i].position + glm::vec3(0.0f, 0.0f, static_cast<float>(offset)));
+        }
+        offset = (offset + 1) % stride;
+        transforms.update(batchMatrices.data());
+    });
+    return result;
+}
+
+void TransformBenchmark::print(std::ostream& out, uint32_t count, const Result& result) {
+    out << "Transforms: " << count << ", TransformSystem using " << TransformSystem::getInstructionSet() << "\n"
+        << "  glm Euler angles         " << result.eulerRate / 1e6 << " M matrices/s ("
+        << result.eulerRate / result.glmRate << "x)\n"
+        << "  glm quaternions          " << result.glmRate / 1e6 << " M matrices/s\n"
+        << "  TransformSystem all      " << result.batchRate / 1e6 << " M matrices/s ("
+        << result.batchRate / result.glmRate << "x)\n"
+        << "  TransformSystem 1% dirty " << result.sparseRate / 1e6 << " M transforms/s ("
+        << result.sparseRate / result.glmRate << "x)\n"
+        << "  Max difference to glm    " << result.maxError << std::endl;
+}
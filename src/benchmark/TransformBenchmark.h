@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// CPU microbenchmark of world matrix composition, run with --transforms. Compares glm composing from
+// the same quaternions (mat4_cast, then translation and scale per object) against TransformSystem
+// with every transform changed and with about 1% changed, in matrices per second. The Euler call
+// chain (translate * rotate x, y, z * scale), which pays for trigonometry per object, is shown for
+// reference. Needs no GPU.
+class TransformBenchmark {
+    public:
+        struct Result {
+            // Matrices composed per second
+            double eulerRate = 0.0;
+            double glmRate = 0.0;
+            double batchRate = 0.0;
+            // Transforms updated per second, changed or not
+            double sparseRate = 0.0;
+            // Largest element difference between the glm quaternion and TransformSystem matrices
+            float maxError = 0.0f;
+        };
+
+        static Result run(uint32_t count);
+        static void print(std::ostream& out, uint32_t count, const Result& result);
+};
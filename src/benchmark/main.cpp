@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BenchmarkApp.h"
+#include "BenchmarkReport.h"
+#include "BenchmarkScenario.h"
+#include "ImageCompare.h"
+#include "TransformBenchmark.h"
+#include "../resources/ImageWriter.h"
+#include "../resources/TextureManager.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --output <file>     JSON results (default benchmark_results.json)\n"
+                  << "  --scenario <name>   run only this scenario, may be repeated\n"
+                  << "  --frames <count>    measured frames per scenario\n"
+                  << "  --warmup <count>    unmeasured frames before measuring\n"
+                  << "  --width <pixels>    swapchain width\n"
+                  << "  --height <pixels>   swapchain height\n"
+                  << "  --list              print the scenarios and exit\n"
+                  << "  --asset-pack <file> load assets from a pack built by vulkan_packer\n"
+                  << "  --golden <dir>      compare each scenario's last frame with <dir>/<scenario>.png\n"
+                  << "  --update-golden     write the last frames to the golden directory instead\n"
+                  << "  --threshold <t>     per pixel color tolerance in [0, 1] (default 0.1)\n"
+                  << "  --max-mismatch <r>  fraction of pixels allowed over the threshold (default 0.001)\n"
+                  << "  --transforms <n>    time world matrix composition for n objects on the CPU and exit\n";
+    }
+
+    double parseNumber(const std::string& option, const char* value) {
+        char* end = nullptr;
+        double number = std::strtod(value, &end);
+        if (end == value || *end != '\0' || number < 0.0) {
+            throw std::runtime_error("Invalid value for " + option + ": " + value);
+        }
+        return number;
+    }
+
+    // Records the outcome in the result; false when the test fails. Failed frames are written to the
+    // working directory next to a diff image, for CI artifacts.
+    bool checkGolden(const std::string& goldenDir, bool update, const ImageCompare::Options& options,
+                     const ImageRgba8& capture, BenchmarkResult& result) {
+        std::string goldenPath = goldenDir + "/" + result.scenario + ".png";
+        if (capture.empty()) {
+            result.goldenStatus = "no_capture";
+            return false;
+        }
+        if (update) {
+            std::filesystem::create_directories(goldenDir);
+            ImageWriter::writePng(goldenPath, capture);
+            result.goldenStatus = "updated";
+            std::cout << "Golden image written to " << goldenPath << std::endl;
+            return true;
+        }
+
+        ImageRgba8 golden;
+        if (!TextureManager::loadPixels(goldenPath, golden)) {
+            result.goldenStatus = "missing";
+            std::cerr << "Golden image " << goldenPath << " not found, run with --update-golden to create it" << std::endl;
+            ImageWriter::writePng(result.scenario + "_actual.png", capture);
+            return false;
+        }
+
+        ImageRgba8 diff;
+        ImageCompare::Result comparison = ImageCompare::compare(capture, golden, options, &diff);
+        result.goldenMismatchedPixels = comparison.mismatchedPixels;
+        result.goldenMismatchRatio = comparison.mismatchRatio;
+        result.goldenMaxDifference = comparison.maxDifference;
+        if (!comparison.sizeMatches) {
+            result.goldenStatus = "size_mismatch";
+        } else {
+            result.goldenStatus = comparison.passed ? "passed" : "failed";
+        }
+        std::cout << "Golden image " << result.scenario << " - " << result.goldenStatus << ", "
+                  << comparison.mismatchedPixels << " pixels over the threshold" << std::endl;
+
+        if (!comparison.passed) {
+            ImageWriter::writePng(result.scenario + "_actual.png", capture);
+            if (comparison.sizeMatches) {
+                ImageWriter::writePng(result.scenario + "_diff.png", diff);
+            }
+        }
+        return comparison.passed;
+    }
+
+    uint32_t parseCount(const std::string& option, const char* value) {
+        char* end = nullptr;
+        unsigned long count = std::strtoul(value, &end, 10);
+        if (end == value || *end != '\0') {
+            throw std::runtime_error("Invalid value for " + option + ": " + value);
+        }
+        return static_cast<uint32_t>(count);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string outputPath = "benchmark_results.json";
+    std::vector<std::string> selected;
+    std::vector<BenchmarkScenario> scenarios = BenchmarkScenario::getDefaultScenarios();
+    std::string goldenDir;
+    bool updateGolden = false;
+    ImageCompare::Options compareOptions;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string option = argv[i];
+            if (option == "--list") {
+                for (const BenchmarkScenario& scenario : scenarios) {
+                    std::cout << scenario.name << " (" << BenchmarkScenario::getTypeName(scenario.type) << ")" << std::endl;
+                }
+                return EXIT_SUCCESS;
+            }
+            if (option == "--update-golden") {
+                updateGolden = true;
+                continue;
+            }
+            if (option == "--help" || option == "-h") {
+                printUsage(argv[0]);
+                return EXIT_SUCCESS;
+            }
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                throw std::runtime_error("Missing value for " + option);
+            }
+
+            const char* value = argv[++i];
+            if (option == "--output") {
+                outputPath = value;
+            } else if (option == "--scenario") {
+                selected.push_back(value);
+            } else if (option == "--asset-pack") {
+                for (BenchmarkScenario& scenario : scenarios) {
+                    scenario.assetPackPath = value;
+                }
+            } else if (option == "--golden") {
+                goldenDir = value;
+            } else if (option == "--threshold") {
+                compareOptions.threshold = static_cast<float>(std::min(parseNumber(option, value), 1.0));
+            } else if (option == "--max-mismatch") {
+                compareOptions.maxMismatchRatio = parseNumber(option, value);
+            } else if (option == "--transforms") {
+                uint32_t count = std::max(parseCount(option, value), 1u);
+                TransformBenchmark::print(std::cout, count, TransformBenchmark::run(count));
+                return EXIT_SUCCESS;
+            } else if (option == "--frames" || option == "--warmup" || option == "--width" || option == "--height") {
+                uint32_t count = parseCount(option, value);
+                for (BenchmarkScenario& scenario : scenarios) {
+                    if (option == "--frames") {
+                        scenario.measuredFrames = std::max(count, 1u);
+                    } else if (option == "--warmup") {
+                        scenario.warmupFrames = count;
+                    } else if (option == "--width") {
+                        scenario.width = std::max(count, 1u);
+                    } else {
+                        scenario.height = std::max(count, 1u);
+                    }
+                }
+            } else {
+                printUsage(argv[0]);
+                throw std::runtime_error("Unknown option " + option);
+            }
+        }
+
+        if (!selected.empty()) {
+            std::vector<BenchmarkScenario> filtered;
+            for (const std::string& name : selected) {
+                bool found = false;
+                for (const BenchmarkScenario& scenario : scenarios) {
+                    if (scenario.name == name) {
+                        filtered.push_back(scenario);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    throw std::runtime_error("Unknown scenario " + name);
+                }
+            }
+            scenarios = filtered;
+        }
+        if (updateGolden && goldenDir.empty()) {
+            throw std::runtime_error("--update-golden needs --golden <dir>");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Each scenario gets its own instance and device, so none inherits another's allocations.
+    // A failed scenario is still reported, and fails the run.
+    std::vector<BenchmarkResult> results;
+    bool failed = false;
+    for (const BenchmarkScenario& scenario : scenarios) {
+        size_t resultCount = results.size();
+        try {
+            BenchmarkApp app(scenario, !goldenDir.empty());
+            app.run();
+            results.push_back(app.getResult());
+            if (!goldenDir.empty()) {
+                failed |= !checkGolden(goldenDir, updateGolden, compareOptions, app.getCapture(), results.back());
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Benchmark " << scenario.name << " failed - " << e.what() << std::endl;
+            if (results.size() == resultCount) {
+                BenchmarkResult result;
+                result.scenario = scenario.name;
+                result.type = BenchmarkScenario::getTypeName(scenario.type);
+                results.push_back(result);
+            }
+            failed = true;
+        }
+        failed |= !results.back().completed;
+    }
+
+    try {
+        BenchmarkReport::writeFile(outputPath, results);
+        std::cout << "Benchmark results written to " << outputPath << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#include "CpuFeatures.h"
+#include <cstring>
+
+#ifdef CPU_FEATURES_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+    CpuFeatures detect() {
+        CpuFeatures features;
+#ifdef CPU_FEATURES_X86
+        unsigned int leaf1[4] = {};
+        unsigned int leaf7[4] = {};
+#ifdef _MSC_VER
+        int registers[4];
+        __cpuid(registers, 0);
+        unsigned int maxLeaf = static_cast<unsigned int>(registers[0]);
+        __cpuid(registers, 1);
+        std::memcpy(leaf1, registers, sizeof(leaf1));
+        if (maxLeaf >= 7) {
+            __cpuidex(registers, 7, 0);
+            std::memcpy(leaf7, registers, sizeof(leaf7));
+        }
+#else
+        unsigned int maxLeaf = __get_cpuid_max(0, nullptr);
+        __get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]);
+        if (maxLeaf >= 7) {
+            __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+        }
+#endif
+        features.ssse3 = (leaf1[2] & (1u << 9)) != 0;
+
+        // AVX registers are only usable when the OS saves them (OSXSAVE, then XCR0 bits 1 and 2)
+        bool osSavesAvx = false;
+        if ((leaf1[2] & (1u << 27)) && (leaf1[2] & (1u << 28))) {
+#ifdef _MSC_VER
+            unsigned long long xcr0 = _xgetbv(0);
+#else
+            unsigned int eax, edx;
+            __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+            osSavesAvx = (xcr0 & 6) == 6;
+        }
+        features.avx = osSavesAvx;
+        features.avx2 = osSavesAvx && (leaf7[1] & (1u << 5)) != 0;
+        features.f16c = osSavesAvx && (leaf1[2] & (1u << 29)) != 0;
+#endif
+        return features;
+    }
+}
+
+const CpuFeatures& CpuFeatures::get() {
+    static const CpuFeatures features = detect();
+    return features;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Instruction sets usable at run time, for code that picks SIMD kernels on first use. Kernels for
+// newer instruction sets are compiled with CPU_TARGET instead of global -m flags, so binaries still
+// run on CPUs without them.
+struct CpuFeatures {
+    bool ssse3 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool f16c = false;
+
+    static const CpuFeatures& get();
+};
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_FEATURES_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC compiles intrinsics of any instruction set without per function targets
+#define CPU_TARGET(isa)
+#else
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define CPU_FEATURES_NEON
+#endif
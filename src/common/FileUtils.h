@@ -0,0 +1,30 @@
+#pragma once
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Reads a whole file into data, a vector of char or uint8_t. Returns false when the file cannot be
+// opened or read.
+template <typename Byte>
+bool readFile(const std::string& path, std::vector<Byte>& data) {
+    static_assert(sizeof(Byte) == 1, "files are read as bytes");
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return file.good();
+}
+
+// As above, but throws when the file cannot be read, e.g. for shaders the caller cannot do without
+inline std::vector<char> readFile(const std::string& path) {
+    std::vector<char> data;
+    if (!readFile(path, data)) {
+        throw std::runtime_error("failed to read file " + path);
+    }
+    return data;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+
+// boost::hash_combine style mixing for composite cache keys
+inline void hashCombine(size_t& seed, size_t value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
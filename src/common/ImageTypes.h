@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Tightly packed 8-bit RGBA pixels, rows top to bottom. Color values are stored as they are in the
+// source image, i.e. sRGB encoded for sRGB swapchains and texture files.
+struct ImageRgba8 {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+
+    bool empty() const { return pixels.empty(); }
+};
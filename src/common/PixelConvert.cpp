@@ -0,0 +1,438 @@
+#include "PixelConvert.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef CPU_FEATURES_X86
+#include <immintrin.h>
+#elif defined(CPU_FEATURES_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    struct Tables {
+        // sRGB decode for 0-255, then alpha / 255 for 256-511 so one gather covers whole pixels
+        float toLinear[512];
+        // Linear [0, 1] in 4096 steps to sRGB encoded 8 bit
+        uint8_t toSrgb[4096];
+
+        Tables() {
+            for (int i = 0; i < 256; i++) {
+                float value = i / 255.0f;
+                toLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+                toLinear[256 + i] = value;
+            }
+            for (int i = 0; i < 4096; i++) {
+                float value = i / 4095.0f;
+                float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+                toSrgb[i] = static_cast<uint8_t>(std::min(encoded * 255.0f + 0.5f, 255.0f));
+            }
+        }
+    };
+
+    const Tables& getTables() {
+        static const Tables tables;
+        return tables;
+    }
+
+    // Exact rounded value * alpha / 255 for 8 bit inputs
+    inline uint8_t multiplyAlpha(uint32_t value, uint32_t alpha) {
+        uint32_t product = value * alpha + 128;
+        return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+    }
+
+    void rgbToRgbaScalar(const uint8_t* rgb, uint8_t* rgba, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            rgba[i * 4 + 0] = rgb[i * 3 + 0];
+            rgba[i * 4 + 1] = rgb[i * 3 + 1];
+            rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+
+    void swapRedBlueScalar(const uint8_t* source, uint8_t* destination, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            uint8_t red = source[i * 4 + 0];
+            destination[i * 4 + 0] = source[i * 4 + 2];
+            destination[i * 4 + 1] = source[i * 4 + 1];
+            destination[i * 4 + 2] = red;
+            destination[i * 4 + 3] = source[i * 4 + 3];
+        }
+    }
+
+    void rgbaToRgbScalar(const uint8_t* rgba, uint8_t* rgb, size_t count, bool swapRedBlue) {
+        size_t red = swapRedBlue ? 2 : 0;
+        size_t blue = swapRedBlue ? 0 : 2;
+        for (size_t i = 0; i < count; i++) {
+            rgb[i * 3 + 0] = rgba[i * 4 + red];
+            rgb[i * 3 + 1] = rgba[i * 4 + 1];
+            rgb[i * 3 + 2] = rgba[i * 4 + blue];
+        }
+    }
+
+    void srgbToLinearScalar(const uint8_t* rgba, float* linear, size_t count) {
+        const float* table = getTables().toLinear;
+        for (size_t i = 0; i < count; i++) {
+            linear[i * 4 + 0] = table[rgba[i * 4 + 0]];
+            linear[i * 4 + 1] = table[rgba[i * 4 + 1]];
+            linear[i * 4 + 2] = table[rgba[i * 4 + 2]];
+            linear[i * 4 + 3] = table[256 + rgba[i * 4 + 3]];
+        }
+    }
+
+    void premultiplyAlphaScalar(uint8_t* rgba, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t alpha = rgba[i * 4 + 3];
+            rgba[i * 4 + 0] = multiplyAlpha(rgba[i * 4 + 0], alpha);
+            rgba[i * 4 + 1] = multiplyAlpha(rgba[i * 4 + 1], alpha);
+            rgba[i * 4 + 2] = multiplyAlpha(rgba[i * 4 + 2], alpha);
+        }
+    }
+
+    uint16_t floatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000u;
+        uint32_t magnitude = bits & 0x7fffffffu;
+
+        if (magnitude >= 0x7f800000u) {
+            // Infinity, or NaN kept quiet
+            return static_cast<uint16_t>(sign | (magnitude > 0x7f800000u ? 0x7e00u : 0x7c00u));
+        }
+        if (magnitude >= 0x477ff000u) {
+            // 65520 and up round to infinity
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+        if (magnitude < 0x38800000u) {
+            // Subnormal half: adding 0.5 puts the half's mantissa in the low bits, rounded by the FPU
+            float shifted;
+            std::memcpy(&shifted, &magnitude, sizeof(shifted));
+            shifted += 0.5f;
+            uint32_t shiftedBits;
+            std::memcpy(&shiftedBits, &shifted, sizeof(shiftedBits));
+            return static_cast<uint16_t>(sign | (shiftedBits - 0x3f000000u));
+        }
+        // Rebias the exponent and round the dropped 13 bits to nearest even
+        uint32_t odd = (magnitude >> 13) & 1u;
+        magnitude += 0xc8000fffu + odd;
+        return static_cast<uint16_t>(sign | (magnitude >> 13));
+    }
+
+    void floatToHalfScalar(const float* source, uint16_t* destination, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            destination[i] = floatToHalf(source[i]);
+        }
+    }
+
+#ifdef CPU_FEATURES_X86
+    CPU_TARGET("ssse3")
+    void rgbToRgbaSsse3(const uint8_t* rgb, uint8_t* rgba, size_t count) {
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+        size_t i = 0;
+        // 16 pixels from three loads
+        for (; i + 16 <= count; i += 16) {
+            const uint8_t* source = rgb + i * 3;
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 32));
+            __m128i pixels[4] = {a, _mm_alignr_epi8(b, a, 12), _mm_alignr_epi8(c, b, 8), _mm_srli_si128(c, 4)};
+            for (int j = 0; j < 4; j++) {
+                __m128i expanded = _mm_or_si128(_mm_shuffle_epi8(pixels[j], shuffle), alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + (i + j * 4) * 4), expanded);
+            }
+        }
+        rgbToRgbaScalar(rgb + i * 3, rgba + i * 4, count - i);
+    }
+
+    CPU_TARGET("ssse3")
+    void swapRedBlueSsse3(const uint8_t* source, uint8_t* destination, size_t count) {
+        const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_shuffle_epi8(pixels, shuffle));
+        }
+        swapRedBlueScalar(source + i * 4, destination + i * 4, count - i);
+    }
+
+    CPU_TARGET("ssse3")
+    void rgbaToRgbSsse3(const uint8_t* rgba, uint8_t* rgb, size_t count, bool swapRedBlue) {
+        const __m128i shuffle = swapRedBlue ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+                                            : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        size_t i = 0;
+        // 16 pixels packed into three full stores
+        for (; i + 16 <= count; i += 16) {
+            const __m128i* source = reinterpret_cast<const __m128i*>(rgba + i * 4);
+            __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(source + 0), shuffle);
+            __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(source + 1), shuffle);
+            __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(source + 2), shuffle);
+            __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(source + 3), shuffle);
+            __m128i* destination = reinterpret_cast<__m128i*>(rgb + i * 3);
+            _mm_storeu_si128(destination + 0, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+            _mm_storeu_si128(destination + 1, _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+            _mm_storeu_si128(destination + 2, _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+        }
+        rgbaToRgbScalar(rgba + i * 4, rgb + i * 3, count - i, swapRedBlue);
+    }
+
+    CPU_TARGET("ssse3")
+    void premultiplyAlphaSsse3(uint8_t* rgba, size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i colorLanes = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+        const __m128i opaqueLanes = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+        const __m128i half = _mm_set1_epi16(128);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+            __m128i halves[2] = {_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero)};
+            for (__m128i& values : halves) {
+                // Alpha in every lane of its pixel, 255 in the alpha lane so alpha stays as it is
+                __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(values, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                alpha = _mm_or_si128(_mm_and_si128(alpha, colorLanes), opaqueLanes);
+                __m128i product = _mm_add_epi16(_mm_mullo_epi16(values, alpha), half);
+                values = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm_packus_epi16(halves[0], halves[1]));
+        }
+        premultiplyAlphaScalar(rgba + i * 4, count - i);
+    }
+
+    CPU_TARGET("avx2")
+    void rgbToRgbaAvx2(const uint8_t* rgb, uint8_t* rgba, size_t count) {
+        const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+        size_t i = 0;
+        // 8 pixels per step; the second load reads 4 bytes past them, hence the extra 2 pixels
+        for (; i + 10 <= count; i += 8) {
+            const uint8_t* source = rgb + i * 3;
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 12));
+            __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+            __m256i expanded = _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), expanded);
+        }
+        rgbToRgbaSsse3(rgb + i * 3, rgba + i * 4, count - i);
+    }
+
+    CPU_TARGET("avx2")
+    void swapRedBlueAvx2(const uint8_t* source, uint8_t* destination, size_t count) {
+        const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                                 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+        }
+        swapRedBlueSsse3(source + i * 4, destination + i * 4, count - i);
+    }
+
+    CPU_TARGET("avx2")
+    void srgbToLinearAvx2(const uint8_t* rgba, float* linear, size_t count) {
+        const float* table = getTables().toLinear;
+        const __m256i alphaOffset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(rgba + i * 4));
+            __m256i indices = _mm256_add_epi32(_mm256_cvtepu8_epi32(pixels), alphaOffset);
+            _mm256_storeu_ps(linear + i * 4, _mm256_i32gather_ps(table, indices, 4));
+        }
+        srgbToLinearScalar(rgba + i * 4, linear + i * 4, count - i);
+    }
+
+    CPU_TARGET("avx2")
+    void premultiplyAlphaAvx2(uint8_t* rgba, size_t count) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i colorLanes = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+        const __m256i opaqueLanes = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+        const __m256i half = _mm256_set1_epi16(128);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + i * 4));
+            // Unpack and pack work within 128 bit lanes, so pixel order survives the round trip
+            __m256i halves[2] = {_mm256_unpacklo_epi8(pixels, zero), _mm256_unpackhi_epi8(pixels, zero)};
+            for (__m256i& values : halves) {
+                __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(values, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                alpha = _mm256_or_si256(_mm256_and_si256(alpha, colorLanes), opaqueLanes);
+                __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(values, alpha), half);
+                values = _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_packus_epi16(halves[0], halves[1]));
+        }
+        premultiplyAlphaSsse3(rgba + i * 4, count - i);
+    }
+
+    CPU_TARGET("avx2,f16c")
+    void floatToHalfF16c(const float* source, uint16_t* destination, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), halves);
+        }
+        floatToHalfScalar(source + i, destination + i, count - i);
+    }
+#endif
+
+#ifdef CPU_FEATURES_NEON
+    void rgbToRgbaNeon(const uint8_t* rgb, uint8_t* rgba, size_t count) {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            uint8x16x3_t source = vld3q_u8(rgb + i * 3);
+            uint8x16x4_t pixels = {{source.val[0], source.val[1], source.val[2], vdupq_n_u8(255)}};
+            vst4q_u8(rgba + i * 4, pixels);
+        }
+        rgbToRgbaScalar(rgb + i * 3, rgba + i * 4, count - i);
+    }
+
+    void swapRedBlueNeon(const uint8_t* source, uint8_t* destination, size_t count) {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            uint8x16x4_t pixels = vld4q_u8(source + i * 4);
+            uint8x16_t red = pixels.val[0];
+            pixels.val[0] = pixels.val[2];
+            pixels.val[2] = red;
+            vst4q_u8(destination + i * 4, pixels);
+        }
+        swapRedBlueScalar(source + i * 4, destination + i * 4, count - i);
+    }
+
+    void rgbaToRgbNeon(const uint8_t* rgba, uint8_t* rgb, size_t count, bool swapRedBlue) {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            uint8x16x4_t pixels = vld4q_u8(rgba + i * 4);
+            uint8x16x3_t colors = {{pixels.val[swapRedBlue ? 2 : 0], pixels.val[1], pixels.val[swapRedBlue ? 0 : 2]}};
+            vst3q_u8(rgb + i * 3, colors);
+        }
+        rgbaToRgbScalar(rgba + i * 4, rgb + i * 3, count - i, swapRedBlue);
+    }
+
+    void premultiplyAlphaNeon(uint8_t* rgba, size_t count) {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint8x8x4_t pixels = vld4_u8(rgba + i * 4);
+            for (int channel = 0; channel < 3; channel++) {
+                // Rounded division by 255: (x + ((x + 128) >> 8) + 128) >> 8
+                uint16x8_t product = vmull_u8(pixels.val[channel], pixels.val[3]);
+                pixels.val[channel] = vraddhn_u16(product, vrshrq_n_u16(product, 8));
+            }
+            vst4_u8(rgba + i * 4, pixels);
+        }
+        premultiplyAlphaScalar(rgba + i * 4, count - i);
+    }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    void floatToHalfNeon(const float* source, uint16_t* destination, size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            float16x4_t halves = vcvt_f16_f32(vld1q_f32(source + i));
+            vst1_u16(destination + i, vreinterpret_u16_f16(halves));
+        }
+        floatToHalfScalar(source + i, destination + i, count - i);
+    }
+#endif
+#endif
+
+    struct Kernels {
+        void (*rgbToRgba)(const uint8_t*, uint8_t*, size_t) = rgbToRgbaScalar;
+        void (*swapRedBlue)(const uint8_t*, uint8_t*, size_t) = swapRedBlueScalar;
+        void (*rgbaToRgb)(const uint8_t*, uint8_t*, size_t, bool) = rgbaToRgbScalar;
+        void (*srgbToLinear)(const uint8_t*, float*, size_t) = srgbToLinearScalar;
+        void (*premultiplyAlpha)(uint8_t*, size_t) = premultiplyAlphaScalar;
+        void (*floatToHalf)(const float*, uint16_t*, size_t) = floatToHalfScalar;
+        const char* instructionSet = "scalar";
+    };
+
+    Kernels selectKernels() {
+        Kernels kernels;
+#ifdef CPU_FEATURES_X86
+        const CpuFeatures& features = CpuFeatures::get();
+        if (features.ssse3) {
+            kernels.rgbToRgba = rgbToRgbaSsse3;
+            kernels.swapRedBlue = swapRedBlueSsse3;
+            kernels.rgbaToRgb = rgbaToRgbSsse3;
+            kernels.premultiplyAlpha = premultiplyAlphaSsse3;
+            kernels.instructionSet = "SSSE3";
+        }
+        // Every AVX2 CPU has SSSE3, which the AVX2 kernels use for their remainders
+        if (features.avx2 && features.ssse3) {
+            kernels.rgbToRgba = rgbToRgbaAvx2;
+            kernels.swapRedBlue = swapRedBlueAvx2;
+            kernels.srgbToLinear = srgbToLinearAvx2;
+            kernels.premultiplyAlpha = premultiplyAlphaAvx2;
+            kernels.instructionSet = "AVX2";
+            if (features.f16c) {
+                kernels.floatToHalf = floatToHalfF16c;
+            }
+        }
+#elif defined(CPU_FEATURES_NEON)
+        kernels.rgbToRgba = rgbToRgbaNeon;
+        kernels.swapRedBlue = swapRedBlueNeon;
+        kernels.rgbaToRgb = rgbaToRgbNeon;
+        kernels.premultiplyAlpha = premultiplyAlphaNeon;
+#if defined(__aarch64__) || defined(_M_ARM64)
+        kernels.floatToHalf = floatToHalfNeon;
+#endif
+        kernels.instructionSet = "NEON";
+#endif
+        return kernels;
+    }
+
+    const Kernels& getKernels() {
+        static const Kernels kernels = selectKernels();
+        return kernels;
+    }
+}
+
+void PixelConvert::rgbToRgba(const uint8_t* rgb, uint8_t* rgba, size_t count) {
+    getKernels().rgbToRgba(rgb, rgba, count);
+}
+
+void PixelConvert::swapRedBlue(const uint8_t* source, uint8_t* destination, size_t count) {
+    getKernels().swapRedBlue(source, destination, count);
+}
+
+void PixelConvert::rgbaToRgb(const uint8_t* rgba, uint8_t* rgb, size_t count, bool swapRedBlue) {
+    getKernels().rgbaToRgb(rgba, rgb, count, swapRedBlue);
+}
+
+void PixelConvert::srgbToLinear(const uint8_t* rgba, float* linear, size_t count) {
+    getKernels().srgbToLinear(rgba, linear, count);
+}
+
+void PixelConvert::premultiplyAlpha(uint8_t* rgba, size_t count, bool srgb) {
+    if (!srgb) {
+        getKernels().premultiplyAlpha(rgba, count);
+        return;
+    }
+
+    // Decoded a chunk at a time so the linear copy stays in L1
+    const size_t chunkSize = 256;
+    const uint8_t* toSrgb = getTables().toSrgb;
+    float linear[chunkSize * 4];
+    for (size_t start = 0; start < count; start += chunkSize) {
+        size_t chunk = std::min(chunkSize, count - start);
+        uint8_t* pixels = rgba + start * 4;
+        getKernels().srgbToLinear(pixels, linear, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            uint8_t* pixel = pixels + i * 4;
+            // Opaque pixels are left exactly as they are
+            if (pixel[3] == 255) {
+                continue;
+            }
+            float alpha = linear[i * 4 + 3] * 4095.0f;
+            for (int channel = 0; channel < 3; channel++) {
+                pixel[channel] = toSrgb[static_cast<int>(linear[i * 4 + channel] * alpha + 0.5f)];
+            }
+        }
+    }
+}
+
+void PixelConvert::floatToHalf(const float* source, uint16_t* destination, size_t count) {
+    getKernels().floatToHalf(source, destination, count);
+}
+
+const char* PixelConvert::getInstructionSet() {
+    return getKernels().instructionSet;
+}
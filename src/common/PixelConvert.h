@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel format conversions for texture ingest and frame capture. Each one runs on the widest
+// instruction set the CPU supports, picked once on first use: AVX2 or SSSE3 on x86, NEON on ARM,
+// plain C++ otherwise. Counts are in pixels (floats for floatToHalf); buffers are tightly packed
+// and need no particular alignment.
+class PixelConvert {
+    public:
+        // Alpha is set to 255
+        static void rgbToRgba(const uint8_t* rgb, uint8_t* rgba, size_t count);
+        // RGBA <-> BGRA; source and destination may be the same buffer
+        static void swapRedBlue(const uint8_t* source, uint8_t* destination, size_t count);
+        // Drops alpha, swapping red and blue on the way when swapRedBlue is set (BGRA sources)
+        static void rgbaToRgb(const uint8_t* rgba, uint8_t* rgb, size_t count, bool swapRedBlue);
+        // sRGB encoded RGBA8 to linear float RGBA; alpha is linear already and only scaled to [0, 1]
+        static void srgbToLinear(const uint8_t* rgba, float* linear, size_t count);
+        // Multiplies color by alpha in place. With srgb, colors are decoded to linear first and
+        // encoded again after, matching how the GPU filters and blends sRGB textures.
+        static void premultiplyAlpha(uint8_t* rgba, size_t count, bool srgb);
+        // IEEE half precision, rounded to nearest even; values out of range become infinity
+        static void floatToHalf(const float* source, uint16_t* destination, size_t count);
+
+        // Instruction set in use, e.g. "AVX2"
+        static const char* getInstructionSet();
+};
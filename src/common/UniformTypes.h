@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "VertexTypes.h"
+
+// Frame constants at set 0, binding 0 of the scene vertex shaders. View and projection are
+// combined on the CPU so the shaders do one matrix multiply per vertex.
+struct UniformBufferObject {
+    glm::mat4 viewProj;
+};
+
+// Per-draw push constants of the scene vertex shaders. shader.vert only declares the model
+// matrix; shader_compact.vert adds the dequantization parameters after it.
+struct DrawPushConstants {
+    glm::mat4 model;
+    QuantizationParams quantization;
+};
@@ -5,6 +5,7 @@
 #include <array>
 #include <vector>
 #include <functional>
+#include <cstdint>
 
 namespace std {
     template<> struct hash<glm::vec2> {
@@ -122,6 +123,78 @@ struct StandardVertex {
     }
 };
 
+// Vertex layouts a mesh can be uploaded with
+enum class VertexFormat {
+    Standard,
+    Compact,
+    // BasicVertex, the position-only stream read by depth-only passes
+    Position
+};
+
+// Compact vertex (12 bytes): position quantized to unorm16 relative to the mesh bounds,
+// an octahedral normal packed into the fourth position lane and unorm16 texture coordinates
+// relative to the texcoord bounds. Dequantized in shader_compact.vert using QuantizationParams.
+struct CompactVertex {
+    uint16_t pos[3];
+    int8_t normal[2];
+    uint16_t texCoord[2];
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(CompactVertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(3);
+
+        // Reads pos[3] plus the packed normal as w, which the shader ignores
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+        attributeDescriptions[0].offset = offsetof(CompactVertex, pos);
+
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 2;
+        attributeDescriptions[1].format = VK_FORMAT_R16G16_UNORM;
+        attributeDescriptions[1].offset = offsetof(CompactVertex, texCoord);
+
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 3;
+        attributeDescriptions[2].format = VK_FORMAT_R8G8_SNORM;
+        attributeDescriptions[2].offset = offsetof(CompactVertex, normal);
+
+        return attributeDescriptions;
+    }
+};
+
+static_assert(sizeof(CompactVertex) == 12, "CompactVertex must stay tightly packed");
+
+inline VkVertexInputBindingDescription getBindingDescription(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Compact: return CompactVertex::getBindingDescription();
+        case VertexFormat::Position: return BasicVertex::getBindingDescription();
+        default: return StandardVertex::getBindingDescription();
+    }
+}
+
+inline std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Compact: return CompactVertex::getAttributeDescriptions();
+        case VertexFormat::Position: return BasicVertex::getAttributeDescriptions();
+        default: return StandardVertex::getAttributeDescriptions();
+    }
+}
+
+// Push constant block used by shader_compact.vert to expand CompactVertex attributes
+struct QuantizationParams {
+    glm::vec4 positionOffset{0.0f};
+    glm::vec4 positionScale{1.0f};
+    glm::vec4 texCoordOffsetScale{0.0f, 0.0f, 1.0f, 1.0f};
+};
+
 // Hash functions for unordered_map usage
 namespace std {
     template<> struct hash<BasicVertex> {
@@ -0,0 +1,49 @@
+#include "FrameLimiter.h"
+#include <thread>
+
+void FrameLimiter::setTargetFrameRate(double framesPerSecond) {
+    targetFrameRate = framesPerSecond > 0.0 ? framesPerSecond : 0.0;
+    targetFrameTime = targetFrameRate > 0.0
+                          ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFrameRate))
+                          : Clock::duration{0};
+    nextDeadline = Clock::time_point{};
+}
+
+void FrameLimiter::waitForNextFrame() {
+    Clock::time_point now = Clock::now();
+    if (targetFrameTime.count() == 0) {
+        frameStart = now;
+        return;
+    }
+
+    // After a stall, pace from now instead of rushing to catch up
+    if (nextDeadline < now) {
+        nextDeadline = now + cpuEstimate;
+    }
+
+    Clock::time_point wakeTime = nextDeadline - cpuEstimate - margin;
+    // Sleep coarsely, then yield for the last millisecond; sleeps overshoot by more than that
+    Clock::time_point sleepUntil = wakeTime - std::chrono::milliseconds(1);
+    if (sleepUntil > now) {
+        std::this_thread::sleep_until(sleepUntil);
+    }
+    while (Clock::now() < wakeTime) {
+        std::this_thread::yield();
+    }
+    frameStart = Clock::now();
+}
+
+void FrameLimiter::frameSubmitted() {
+    lastCpuTime = Clock::now() - frameStart;
+
+    // Rise immediately, decay slowly: waking too late costs a frame, waking early only a little latency
+    if (lastCpuTime > cpuEstimate) {
+        cpuEstimate = lastCpuTime;
+    } else {
+        cpuEstimate -= (cpuEstimate - lastCpuTime) / 16;
+    }
+
+    if (targetFrameTime.count() != 0) {
+        nextDeadline += targetFrameTime;
+    }
+}
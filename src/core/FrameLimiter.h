@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+
+// CPU side frame pacing. Instead of sleeping after a frame, the limiter sleeps before the next one
+// acquires its image and samples input, and wakes an estimate of the CPU frame time (plus a margin)
+// before that frame is due to be submitted. The input read after the wait is then as fresh as the
+// pacing allows.
+class FrameLimiter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // 0 disables the limiter
+        void setTargetFrameRate(double framesPerSecond);
+        double getTargetFrameRate() const { return targetFrameRate; }
+
+        // Call before acquiring the swapchain image for a frame
+        void waitForNextFrame();
+        // Call once the frame was submitted; updates the CPU frame time estimate
+        void frameSubmitted();
+
+        // Time the last frame took from the end of its wait to submission
+        double getCpuFrameTime() const { return std::chrono::duration<double, std::milli>(lastCpuTime).count(); }
+        // Moment the current frame's wait ended
+        Clock::time_point getFrameStart() const { return frameStart; }
+
+    private:
+        double targetFrameRate = 0.0;
+        Clock::duration targetFrameTime{0};
+        // Headroom for scheduler wake-up jitter
+        Clock::duration margin = std::chrono::microseconds(500);
+        Clock::duration cpuEstimate{0};
+        Clock::duration lastCpuTime{0};
+        Clock::time_point frameStart{};
+        Clock::time_point nextDeadline{};
+};
@@ -0,0 +1,108 @@
+#include "LatencyMonitor.h"
+#include <iostream>
+
+// Wait in short slices: the swapchain mutex is held for each one, so acquire and present wait at
+// most a slice, and flush() and shutdown are not held up by a frame that is never shown
+static const uint64_t PRESENT_WAIT_TIMEOUT_NS = 1'000'000;
+
+LatencyMonitor::LatencyMonitor() {}
+
+LatencyMonitor::~LatencyMonitor() {
+    cleanup();
+}
+
+void LatencyMonitor::initialize(const VulkanDevice& device, std::mutex& swapchainMutex) {
+    this->vulkanDevice = &device;
+    this->swapchainMutex = &swapchainMutex;
+    if (!device.isPresentWaitEnabled()) {
+        std::cout << "Input-to-photon latency unavailable (no VK_KHR_present_wait)" << std::endl;
+        return;
+    }
+
+    waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+        vkGetDeviceProcAddr(device.getLogicalDevice(), "vkWaitForPresentKHR"));
+    if (!waitForPresent) {
+        std::cout << "Failed to load vkWaitForPresentKHR" << std::endl;
+        return;
+    }
+
+    stopping = false;
+    worker = std::thread(&LatencyMonitor::workerLoop, this);
+}
+
+void LatencyMonitor::cleanup() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            pending.clear();
+        }
+        condition.notify_all();
+        worker.join();
+    }
+    waitForPresent = nullptr;
+    vulkanDevice = nullptr;
+}
+
+uint64_t LatencyMonitor::nextPresentId(VkSwapchainKHR swapchain, Clock::time_point inputTime) {
+    if (!isSupported()) {
+        return 0;
+    }
+    uint64_t presentId = ++presentCounter;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({swapchain, presentId, inputTime});
+    }
+    condition.notify_all();
+    return presentId;
+}
+
+void LatencyMonitor::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    pending.clear();
+    generation++;
+    condition.wait(lock, [this] { return !waiting; });
+}
+
+double LatencyMonitor::getAverageLatency() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return averageLatency;
+}
+
+double LatencyMonitor::getLastLatency() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastLatency;
+}
+
+void LatencyMonitor::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (stopping) {
+            return;
+        }
+        PendingPresent present = pending.front();
+        pending.pop_front();
+        uint64_t waitGeneration = generation;
+        waiting = true;
+
+        // Presents complete in order, so waiting on each id in turn never skips a frame
+        VkResult result = VK_TIMEOUT;
+        while (result == VK_TIMEOUT && !stopping && waitGeneration == generation) {
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> swapchainLock(*swapchainMutex);
+                result = waitForPresent(vulkanDevice->getLogicalDevice(), present.swapchain, present.presentId,
+                                        PRESENT_WAIT_TIMEOUT_NS);
+            }
+            lock.lock();
+        }
+
+        if (result == VK_SUCCESS && waitGeneration == generation) {
+            lastLatency = std::chrono::duration<double, std::milli>(Clock::now() - present.inputTime).count();
+            averageLatency = averageLatency == 0.0 ? lastLatency : averageLatency + 0.05 * (lastLatency - averageLatency);
+        }
+        waiting = false;
+        condition.notify_all();
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "VulkanDevice.h"
+
+// Input-to-photon latency: the time from sampling input for a frame until the presentation engine
+// reports its image as shown (VK_KHR_present_wait). A worker thread blocks in vkWaitForPresentKHR on
+// each presented frame in turn, so the render loop never waits on the display.
+class LatencyMonitor {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        LatencyMonitor();
+        ~LatencyMonitor();
+
+        // swapchainMutex must be held around every acquire and present on the monitored swapchains,
+        // which must not run concurrently with vkWaitForPresentKHR
+        void initialize(const VulkanDevice& device, std::mutex& swapchainMutex);
+        void cleanup();
+
+        // False without present wait support; nextPresentId() then returns 0 and nothing is measured
+        bool isSupported() const { return waitForPresent != nullptr; }
+
+        // Id to chain into the frame's present with VkPresentIdKHR, tracked against the input sample time
+        uint64_t nextPresentId(VkSwapchainKHR swapchain, Clock::time_point inputTime);
+        // Drops the pending frames and waits until the worker no longer uses the swapchain. Call
+        // before the swapchain is destroyed.
+        void flush();
+
+        // Milliseconds, averaged over the recent frames; 0 until the first frame was shown
+        double getAverageLatency() const;
+        double getLastLatency() const;
+
+    private:
+        struct PendingPresent {
+            VkSwapchainKHR swapchain;
+            uint64_t presentId;
+            Clock::time_point inputTime;
+        };
+
+        const VulkanDevice* vulkanDevice = nullptr;
+        PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+        std::mutex* swapchainMutex = nullptr;
+        uint64_t presentCounter = 0;
+
+        std::thread worker;
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<PendingPresent> pending;
+        bool waiting = false;
+        bool stopping = false;
+        // Bumped by flush() so an in-progress wait is discarded
+        uint64_t generation = 0;
+
+        double averageLatency = 0.0;
+        double lastLatency = 0.0;
+
+        void workerLoop();
+};
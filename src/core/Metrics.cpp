@@ -0,0 +1,78 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+Metrics::Metrics(uint32_t historySize) : historySize(1) {
+    while (this->historySize < historySize) {
+        this->historySize <<= 1;
+    }
+}
+
+Metrics::~Metrics() {}
+
+Metrics::SeriesId Metrics::addSeries(const std::string& name, Category category) {
+    for (SeriesId id = 0; id < series.size(); id++) {
+        if (series[id]->name == name && series[id]->category == category) {
+            return id;
+        }
+    }
+    std::unique_ptr<Series> entry = std::make_unique<Series>();
+    entry->name = name;
+    entry->category = category;
+    entry->values = std::make_unique<std::atomic<float>[]>(historySize);
+    entry->mask = historySize - 1;
+    series.push_back(std::move(entry));
+    return static_cast<SeriesId>(series.size() - 1);
+}
+
+void Metrics::clear() {
+    for (std::unique_ptr<Series>& entry : series) {
+        entry->written.store(0, std::memory_order_release);
+    }
+}
+
+void Metrics::getHistory(SeriesId id, std::vector<float>& values) const {
+    const Series& entry = *series[id];
+    uint64_t written = entry.written.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>(written, historySize);
+
+    values.resize(static_cast<size_t>(count));
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t index = written - count + i;
+        values[static_cast<size_t>(i)] = entry.values[index & entry.mask].load(std::memory_order_relaxed);
+    }
+}
+
+Metrics::Stats Metrics::getStats(SeriesId id) const {
+    std::vector<float> values;
+    getHistory(id, values);
+    return computeStats(values);
+}
+
+Metrics::Stats Metrics::computeStats(std::vector<float>& values) {
+    Stats stats;
+    if (values.empty()) {
+        return stats;
+    }
+    stats.count = static_cast<uint32_t>(values.size());
+    stats.last = values.back();
+
+    double sum = 0.0;
+    for (float value : values) {
+        sum += value;
+    }
+    stats.average = static_cast<float>(sum / values.size());
+
+    // Nearest rank percentiles
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](float p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    };
+    stats.min = values.front();
+    stats.max = values.back();
+    stats.p50 = percentile(0.50f);
+    stats.p95 = percentile(0.95f);
+    stats.p99 = percentile(0.99f);
+    return stats;
+}
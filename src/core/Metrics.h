@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Named series of per-frame samples (frame times, phase and pass timings, counts), each kept in a
+// fixed size lock-free ring buffer: one thread records while another may copy the history out.
+// Recording is a relaxed load and a store, and nothing at all while the metrics are disabled, so
+// the calls stay in the hot path and are switched off whenever nobody looks at the values.
+class Metrics {
+    public:
+        enum class Category {
+            Frame,      // whole frame timings, shown with a histogram
+            CpuPhase,   // CPU time of one part of the frame
+            GpuPass,    // GPU time of one render graph pass
+            Counter     // per-frame counts, e.g. draw calls
+        };
+
+        using SeriesId = uint32_t;
+
+        struct Stats {
+            uint32_t count = 0;
+            float last = 0.0f;
+            float average = 0.0f;
+            float min = 0.0f;
+            float max = 0.0f;
+            float p50 = 0.0f;
+            float p95 = 0.0f;
+            float p99 = 0.0f;
+        };
+
+        // Measures consecutive phases: every mark() records the time since the previous one
+        class PhaseTimer {
+            public:
+                explicit PhaseTimer(Metrics& metrics)
+                    : metrics(metrics), active(metrics.isEnabled()), start(active ? Clock::now() : Clock::time_point{}) {}
+
+                void mark(SeriesId series) {
+                    if (!active) {
+                        return;
+                    }
+                    Clock::time_point now = Clock::now();
+                    metrics.record(series, std::chrono::duration<float, std::milli>(now - start).count());
+                    start = now;
+                }
+
+            private:
+                using Clock = std::chrono::steady_clock;
+                Metrics& metrics;
+                bool active;
+                Clock::time_point start;
+        };
+
+        // Keeps the last historySize samples per series, rounded up to a power of two
+        explicit Metrics(uint32_t historySize = 512);
+        ~Metrics();
+
+        uint32_t getHistorySize() const { return historySize; }
+
+        // Returns the series with this name, registering it on first use. Registration is not
+        // thread safe: do it on the thread that reads the metrics, before recording into it.
+        SeriesId addSeries(const std::string& name, Category category);
+
+        void record(SeriesId id, float value) {
+            if (enabled.load(std::memory_order_relaxed)) {
+                series[id]->push(value);
+            }
+        }
+
+        void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+        bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+        // Drops all samples, e.g. after a setting change that makes the old ones meaningless
+        void clear();
+
+        uint32_t getSeriesCount() const { return static_cast<uint32_t>(series.size()); }
+        const std::string& getName(SeriesId id) const { return series[id]->name; }
+        Category getCategory(SeriesId id) const { return series[id]->category; }
+        // Recorded samples, oldest first. A writer that laps the copy replaces its oldest samples.
+        void getHistory(SeriesId id, std::vector<float>& values) const;
+        Stats getStats(SeriesId id) const;
+
+        // Sorts values
+        static Stats computeStats(std::vector<float>& values);
+
+    private:
+        struct Series {
+            std::string name;
+            Category category;
+            std::unique_ptr<std::atomic<float>[]> values;
+            uint64_t mask = 0;
+            // Total samples written; the next one goes to written & mask
+            std::atomic<uint64_t> written{0};
+
+            void push(float value) {
+                uint64_t index = written.load(std::memory_order_relaxed);
+                values[index & mask].store(value, std::memory_order_relaxed);
+                written.store(index + 1, std::memory_order_release);
+            }
+        };
+
+        uint32_t historySize;
+        std::atomic<bool> enabled{false};
+        // Pointers keep the atomics in place when the vector grows
+        std::vector<std::unique_ptr<Series>> series;
+};
@@ -3,14 +3,22 @@
 #include "VulkanDevice.h"
 #include "../rendering/VulkanSwapchain.h"
 #include "../rendering/VulkanGraphicsPipeline.h"
+#include "../rendering/PipelineManager.h"
 #include "../rendering/CommandManager.h"
 #include "../resources/BufferManager.h"
 #include "../resources/TextureManager.h"
+#include "../resources/AssetPack.h"
+#include "../resources/AsyncFileReader.h"
 #include "../descriptors/DescriptorManager.h"
+#include "../descriptors/LayoutCache.h"
 #include "../ui/GuiManager.h"
+#include "../rendering/ShaderHotReloader.h"
+#include "FrameLimiter.h"
+#include "LatencyMonitor.h"
 #include <stdexcept>
 #include <iostream>
 #include <memory>
+#include <algorithm>
 
 VulkanApplication::VulkanApplication(const Config& config)
     : config_(config), window_(nullptr), surface_(VK_NULL_HANDLE) {
@@ -28,6 +36,9 @@ void VulkanApplication::run(){
 }
 
 void VulkanApplication::initWindow(){
+    if (config_.headless) {
+        return;
+    }
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -40,20 +51,35 @@ void VulkanApplication::initWindow(){
 
 void VulkanApplication::initVulkan(){
     vulkanInstance_ = std::make_unique<VulkanInstance>();
-    vulkanInstance_->initialize();
+    vulkanInstance_->initialize(config_.headless);
 
-    if(glfwCreateWindowSurface(vulkanInstance_->getInstance(), window_, nullptr, &surface_) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create window surface!");
-    }
+    createSurface();
 
     vulkanDevice_ = std::make_unique<VulkanDevice>();
-    vulkanDevice_->initialize(*vulkanInstance_, surface_);
+    vulkanDevice_->initialize(*vulkanInstance_, surface_, config_.enableDynamicRendering);
+
+    msaaSamples_ = std::min(config_.msaaSamples, vulkanDevice_->getMaxUsableSampleCount());
+    std::cout << "MSAA samples - " << msaaSamples_ << std::endl;
+
+    layoutCache_ = std::make_unique<LayoutCache>();
+    layoutCache_->initialize(*vulkanDevice_);
+
+    pipelineManager_ = std::make_unique<PipelineManager>();
+    pipelineManager_->initialize(*vulkanDevice_, *layoutCache_);
 
     vulkanSwapchain_ = std::make_unique<VulkanSwapchain>();
+    vulkanSwapchain_->setPresentMode(config_.presentMode);
+    vulkanSwapchain_->setImageCount(config_.swapchainImageCount);
+    vulkanSwapchain_->setFallbackExtent({config_.windowWidth, config_.windowHeight});
     vulkanSwapchain_->initialize(*vulkanDevice_, surface_, window_);
 
+    openAssetPack();
+    fileReader_ = std::make_unique<AsyncFileReader>();
+    fileReader_->initialize(64, 4, config_.enableIoUring);
+
     vulkanPipeline_ = std::make_unique<VulkanGraphicsPipeline>();
-    vulkanPipeline_->initialize(*vulkanDevice_, *vulkanSwapchain_);
+    vulkanPipeline_->setFileReader(fileReader_.get());
+    vulkanPipeline_->initialize(*vulkanDevice_, *vulkanSwapchain_, *pipelineManager_, msaaSamples_);
 
     commandManager_ = std::make_unique<CommandManager>();
     commandManager_->initialize(*vulkanDevice_, config_.maxFramesInFlight);
@@ -63,31 +89,118 @@ void VulkanApplication::initVulkan(){
 
     textureManager_ = std::make_unique<TextureManager>();
     textureManager_->initialize(*vulkanDevice_, *commandManager_, *bufferManager_);
+    textureManager_->setAssetPack(assetPack_.get());
+    textureManager_->setFileReader(fileReader_.get());
 
     descriptorManager_ = std::make_unique<DescriptorManager>();
     descriptorManager_->initialize(*vulkanDevice_);
 
+    createMetrics();
+
     // Initialize GUI if enabled
-    if (config_.enableGui) {
+    if (config_.enableGui && !config_.headless) {
         GuiManager::Config guiConfig;
         guiConfig.maxFramesInFlight = config_.maxFramesInFlight;
         guiConfig.fontPath = config_.fontPath;
         guiConfig.fontSize = config_.fontSize;
+        guiConfig.assetPack = assetPack_.get();
+        guiConfig.cacheStaticFrames = config_.cacheStaticGuiFrames;
+        // Drawn in its own single sampled pass over the final image, at native resolution
         guiManager_ = std::make_unique<GuiManager>(guiConfig);
         guiManager_->initialize(window_, vulkanInstance_->getInstance(), 
                                vulkanDevice_.get(), vulkanSwapchain_.get(), 
-                               vulkanPipeline_->getRenderPass());
+                               vulkanPipeline_->getOverlayRenderPass());
+        guiManager_->setMetrics(metrics_.get());
     }
 
     createSyncObjects();
 
+    framesInFlight_ = config_.framesInFlight > 0 ? std::min(config_.framesInFlight, config_.maxFramesInFlight)
+                                                 : config_.maxFramesInFlight;
+    requestedFramesInFlight_ = framesInFlight_;
+    frameLimiter_ = std::make_unique<FrameLimiter>();
+    frameLimiter_->setTargetFrameRate(config_.frameRateLimit);
+    latencyMonitor_ = std::make_unique<LatencyMonitor>();
+    latencyMonitor_->initialize(*vulkanDevice_, swapchainMutex_);
+
     initializeResources();
+
+    // Started last so the pipeline layout and vertex format are final
+    if (config_.enableShaderHotReload) {
+        shaderHotReloader_ = std::make_unique<ShaderHotReloader>();
+        shaderHotReloader_->initialize(*vulkanDevice_, *vulkanPipeline_, *pipelineManager_);
+    }
+}
+
+void VulkanApplication::createSurface() {
+    if (!config_.headless) {
+        if(glfwCreateWindowSurface(vulkanInstance_->getInstance(), window_, nullptr, &surface_) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create window surface!");
+        }
+        return;
+    }
+
+    auto createHeadlessSurface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(
+        vkGetInstanceProcAddr(vulkanInstance_->getInstance(), "vkCreateHeadlessSurfaceEXT"));
+    if (createHeadlessSurface == nullptr) {
+        throw std::runtime_error("VK_EXT_headless_surface is not available!");
+    }
+    VkHeadlessSurfaceCreateInfoEXT surfaceInfo{};
+    surfaceInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+    VkResult result = createHeadlessSurface(vulkanInstance_->getInstance(), &surfaceInfo, nullptr, &surface_);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to create headless surface - " << result << std::endl;
+        throw std::runtime_error("failed to create headless surface!");
+    }
+    std::cout << "Successfully created headless surface - " << result << std::endl;
+}
+
+void VulkanApplication::openAssetPack() {
+    if (config_.assetPackPath.empty()) {
+        return;
+    }
+    assetPack_ = std::make_unique<AssetPack>();
+    try {
+        assetPack_->open(config_.assetPackPath, config_.assetMountPoint);
+    } catch (const std::exception& e) {
+        std::cout << "Loading assets from disk - " << e.what() << std::endl;
+        assetPack_.reset();
+    }
+}
+
+void VulkanApplication::createMetrics() {
+    metrics_ = std::make_unique<Metrics>(config_.metricsHistory);
+    frameSeries_.frameTime = metrics_->addSeries("frame time", Metrics::Category::Frame);
+    frameSeries_.fenceWait = metrics_->addSeries("wait for GPU", Metrics::Category::CpuPhase);
+    frameSeries_.acquire = metrics_->addSeries("acquire", Metrics::Category::CpuPhase);
+    frameSeries_.limiter = metrics_->addSeries("frame limiter", Metrics::Category::CpuPhase);
+    frameSeries_.input = metrics_->addSeries("input", Metrics::Category::CpuPhase);
+    frameSeries_.update = metrics_->addSeries("update", Metrics::Category::CpuPhase);
+    frameSeries_.gui = metrics_->addSeries("gui", Metrics::Category::CpuPhase);
+    frameSeries_.record = metrics_->addSeries("record", Metrics::Category::CpuPhase);
+    frameSeries_.submit = metrics_->addSeries("submit", Metrics::Category::CpuPhase);
+    frameSeries_.present = metrics_->addSeries("present", Metrics::Category::CpuPhase);
+    frameSeries_.pipelines = metrics_->addSeries("pipelines", Metrics::Category::Counter);
+    frameSeries_.setLayouts = metrics_->addSeries("descriptor set layouts", Metrics::Category::Counter);
+    frameSeries_.pipelineLayouts = metrics_->addSeries("pipeline layouts", Metrics::Category::Counter);
+    frameSeries_.descriptorSets = metrics_->addSeries("descriptor sets", Metrics::Category::Counter);
+}
+
+void VulkanApplication::recordFrameCounters() {
+    if (!metrics_->isEnabled()) {
+        return;
+    }
+    metrics_->record(frameSeries_.pipelines, static_cast<float>(pipelineManager_->getPipelineCount()));
+    metrics_->record(frameSeries_.setLayouts, static_cast<float>(layoutCache_->getSetLayoutCount()));
+    metrics_->record(frameSeries_.pipelineLayouts, static_cast<float>(layoutCache_->getPipelineLayoutCount()));
+    metrics_->record(frameSeries_.descriptorSets, static_cast<float>(descriptorManager_->getAllocatedSetCount()));
 }
 
 void VulkanApplication::createSyncObjects() {
     imageAvailableSemaphores_.resize(config_.maxFramesInFlight);
     renderFinishedSemaphores_.resize(config_.maxFramesInFlight);
     inFlightFences_.resize(config_.maxFramesInFlight);
+    slotFrames_.assign(config_.maxFramesInFlight, 0);
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -105,39 +218,117 @@ void VulkanApplication::createSyncObjects() {
     }
 }
 
+void VulkanApplication::setPresentMode(VkPresentModeKHR mode) {
+    vulkanSwapchain_->setPresentMode(mode);
+    swapchainSettingsChanged_ = true;
+}
+
+void VulkanApplication::setSwapchainImageCount(uint32_t count) {
+    vulkanSwapchain_->setImageCount(count);
+    swapchainSettingsChanged_ = true;
+}
+
+void VulkanApplication::setFramesInFlight(uint32_t count) {
+    requestedFramesInFlight_ = std::clamp(count, 1u, config_.maxFramesInFlight);
+}
+
+void VulkanApplication::setFrameRateLimit(double framesPerSecond) {
+    frameLimiter_->setTargetFrameRate(framesPerSecond);
+}
+
+void VulkanApplication::requestResize(uint32_t width, uint32_t height) {
+    if (!config_.headless) {
+        return;
+    }
+    vulkanSwapchain_->setFallbackExtent({width, height});
+    swapchainSettingsChanged_ = true;
+}
+
 void VulkanApplication::mainLoop() {
-    while (!glfwWindowShouldClose(window_)) {
-        glfwPollEvents();
+    // Input is polled inside drawFrame, as late as the frame pacing allows
+    while (!closeRequested_ && (window_ == nullptr || !glfwWindowShouldClose(window_))) {
         drawFrame();
     }
     vkDeviceWaitIdle(vulkanDevice_->getLogicalDevice());
 }
 
 void VulkanApplication::drawFrame() {
+    Metrics::PhaseTimer phases(*metrics_);
+
+    // Per-frame resources exist for every slot, so changing the rotation only needs the GPU to
+    // finish with all of them first
+    if (requestedFramesInFlight_ != framesInFlight_) {
+        vkWaitForFences(vulkanDevice_->getLogicalDevice(), config_.maxFramesInFlight, inFlightFences_.data(), VK_TRUE, UINT64_MAX);
+        framesInFlight_ = requestedFramesInFlight_;
+        currentFrame_ = 0;
+        completedFrames_ = frameNumber_;
+        std::cout << "Frames in flight - " << framesInFlight_ << std::endl;
+    }
+
     vkWaitForFences(vulkanDevice_->getLogicalDevice(), 1, &inFlightFences_[currentFrame_], VK_TRUE, UINT64_MAX);
-    vkResetFences(vulkanDevice_->getLogicalDevice(), 1, &inFlightFences_[currentFrame_]);
+    // One queue, so every frame up to the one this fence belonged to has finished too
+    completedFrames_ = std::max(completedFrames_, slotFrames_[currentFrame_]);
+    phases.mark(frameSeries_.fenceWait);
+
+    if (swapchainSettingsChanged_) {
+        swapchainSettingsChanged_ = false;
+        recreateSwapChain();
+    }
+
+    // Frame boundary: nothing is being recorded, so a reloaded pipeline can be swapped in
+    if (shaderHotReloader_) {
+        shaderHotReloader_->update(config_.maxFramesInFlight);
+    }
+
+    // Sleep off any spare frame time before acquiring, so the frame starts from the freshest state
+    FrameLimiter::Clock::time_point previousFrameStart = frameLimiter_->getFrameStart();
+    frameLimiter_->waitForNextFrame();
+    phases.mark(frameSeries_.limiter);
+    if (previousFrameStart != FrameLimiter::Clock::time_point{}) {
+        metrics_->record(frameSeries_.frameTime, std::chrono::duration<float, std::milli>(
+                                                     frameLimiter_->getFrameStart() - previousFrameStart).count());
+    }
 
     uint32_t imageIndex;
-    VkResult acquireNextImageResult = 
-        vkAcquireNextImageKHR(vulkanDevice_->getLogicalDevice(), vulkanSwapchain_->getSwapChain(), UINT64_MAX, imageAvailableSemaphores_[currentFrame_], VK_NULL_HANDLE, &imageIndex);
+    VkResult acquireNextImageResult;
+    {
+        std::lock_guard<std::mutex> swapchainLock(swapchainMutex_);
+        acquireNextImageResult = vkAcquireNextImageKHR(vulkanDevice_->getLogicalDevice(), vulkanSwapchain_->getSwapChain(), UINT64_MAX,
+                                                       imageAvailableSemaphores_[currentFrame_], VK_NULL_HANDLE, &imageIndex);
+    }
     if (acquireNextImageResult == VK_ERROR_OUT_OF_DATE_KHR) {
+        if (window_) {
+            glfwPollEvents();
+        }
         recreateSwapChain();
         return;
     } else if (acquireNextImageResult != VK_SUCCESS && acquireNextImageResult != VK_SUBOPTIMAL_KHR) {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
     vkResetFences(vulkanDevice_->getLogicalDevice(), 1, &inFlightFences_[currentFrame_]);
+    phases.mark(frameSeries_.acquire);
+
+    LatencyMonitor::Clock::time_point inputTime = LatencyMonitor::Clock::now();
+    if (window_) {
+        glfwPollEvents();
+    }
+    phases.mark(frameSeries_.input);
 
     updateUniforms(currentFrame_);
+    phases.mark(frameSeries_.update);
 
     // Start GUI frame if enabled
     if (config_.enableGui && guiManager_) {
-        guiManager_->newFrame();
-        renderGui();  // Call derived class GUI rendering
+        // Nothing to build when the previous GUI frame is replayed
+        if (guiManager_->newFrame()) {
+            renderGui();  // Call derived class GUI rendering
+        }
     }
+    phases.mark(frameSeries_.gui);
 
     // Record command buffer - delegate to derived class
     recordRenderCommands(commandManager_->getCommandBuffer(currentFrame_), imageIndex);
+    phases.mark(frameSeries_.record);
 
 
     VkSubmitInfo submitInfo{};
@@ -163,6 +354,8 @@ void VulkanApplication::drawFrame() {
     }else{
         // std::cout << "Successfully submmited command buffer - " << result << std::endl;
     }
+    slotFrames_[currentFrame_] = ++frameNumber_;
+    phases.mark(frameSeries_.submit);
 
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -174,7 +367,20 @@ void VulkanApplication::drawFrame() {
     presentInfo.pImageIndices = &imageIndex;
     presentInfo.pResults = nullptr;
 
-    VkResult queuePresentResult = vkQueuePresentKHR(vulkanDevice_->getPresentQueue(), &presentInfo);
+    VkPresentIdKHR presentId{};
+    uint64_t presentIdValue = latencyMonitor_->nextPresentId(vulkanSwapchain_->getSwapChain(), inputTime);
+    if (presentIdValue != 0) {
+        presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        presentId.swapchainCount = 1;
+        presentId.pPresentIds = &presentIdValue;
+        presentInfo.pNext = &presentId;
+    }
+
+    VkResult queuePresentResult;
+    {
+        std::lock_guard<std::mutex> swapchainLock(swapchainMutex_);
+        queuePresentResult = vkQueuePresentKHR(vulkanDevice_->getPresentQueue(), &presentInfo);
+    }
     if (queuePresentResult == VK_ERROR_OUT_OF_DATE_KHR || queuePresentResult == VK_SUBOPTIMAL_KHR || framebufferResized_) {
         framebufferResized_ = false;
         recreateSwapChain();
@@ -182,19 +388,28 @@ void VulkanApplication::drawFrame() {
         throw std::runtime_error("failed to present swap chain image!");
     }
 
-    currentFrame_ = (currentFrame_ + 1) % config_.maxFramesInFlight;
+    phases.mark(frameSeries_.present);
+    recordFrameCounters();
+
+    frameLimiter_->frameSubmitted();
+    currentFrame_ = (currentFrame_ + 1) % framesInFlight_;
+    onFrameEnd();
 }
 
 void VulkanApplication::recreateSwapChain() {
+    // Wait while minimized
     int width = 0, height = 0;
-    glfwGetFramebufferSize(window_, &width, &height);
-    while (width == 0 || height == 0) {
+    while (window_ && (width == 0 || height == 0)) {
         glfwGetFramebufferSize(window_, &width, &height);
-        glfwWaitEvents();
+        if (width == 0 || height == 0) {
+            glfwWaitEvents();
+        }
     }
     vkDeviceWaitIdle(vulkanDevice_->getLogicalDevice());
 
+    latencyMonitor_->flush();
     vulkanSwapchain_->recreate(window_);
+    onSwapchainRecreated();
 }
 
 void VulkanApplication::cleanup() {
@@ -202,6 +417,15 @@ void VulkanApplication::cleanup() {
         vkDeviceWaitIdle(vulkanDevice_->getLogicalDevice());
     }
 
+    if (shaderHotReloader_) {
+        shaderHotReloader_.reset();
+    }
+    latencyMonitor_.reset();
+    // Joins the compile workers before anything they build against is destroyed
+    if (pipelineManager_) {
+        pipelineManager_->cleanup();
+    }
+
     onCleanup();
 
     // Cleanup GUI
@@ -239,7 +463,9 @@ void VulkanApplication::cleanup() {
         glfwDestroyWindow(window_);
         window_ = nullptr;
     }
-    glfwTerminate();
+    if (!config_.headless) {
+        glfwTerminate();
+    }
 }
 
 void VulkanApplication::framebufferResizeCallback(GLFWwindow* window, int width, int height) {
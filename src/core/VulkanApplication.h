@@ -4,9 +4,13 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <memory> 
+#include <mutex>
+#include "Metrics.h"
 
 class VulkanInstance;
 class VulkanDevice;
+class LayoutCache;
+class PipelineManager;
 class VulkanSwapchain;
 class VulkanGraphicsPipeline;
 class CommandManager;
@@ -14,6 +18,11 @@ class BufferManager;
 class TextureManager;
 class DescriptorManager;
 class GuiManager;
+class ShaderHotReloader;
+class FrameLimiter;
+class LatencyMonitor;
+class AssetPack;
+class AsyncFileReader;
 
 class VulkanApplication{
     public:
@@ -21,11 +30,42 @@ class VulkanApplication{
             uint32_t windowWidth = 800;
             uint32_t windowHeight = 600;
             std::string windowTitle = "Vulkan Boilerplate";
+            // Frames the CPU may record ahead of the GPU. Per-frame resources are created for this
+            // many; setFramesInFlight() can use fewer at runtime.
             uint32_t maxFramesInFlight = 2;
+            // Frames in flight at startup, 0 for maxFramesInFlight
+            uint32_t framesInFlight = 0;
+            // Falls back to FIFO when the surface does not support it
+            VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+            // 0 for the surface minimum plus one
+            uint32_t swapchainImageCount = 0;
+            // CPU frame limiter target, 0 for unlimited
+            double frameRateLimit = 0.0;
             bool enableValidation = true;
+            // No window or display: frames go to a VK_EXT_headless_surface swapchain of
+            // windowWidth x windowHeight (see requestResize), e.g. for benchmarks on CI with
+            // lavapipe. Implies no GUI and no input.
+            bool headless = false;
             bool enableGui = true;
             std::string fontPath = "";
             float fontSize = 16.0f;
+            // Replay the last GUI frame while there is no input, see GuiManager::Config
+            bool cacheStaticGuiFrames = false;
+            // Samples kept per metrics series, rounded up to a power of two
+            uint32_t metricsHistory = 512;
+            // Recompile and swap the graphics pipeline when its GLSL sources change (needs glslc)
+            bool enableShaderHotReload = false;
+            // Render without render pass and framebuffer objects when the device supports
+            // dynamic rendering and synchronization2; otherwise render passes are used
+            bool enableDynamicRendering = true;
+            // Requested MSAA sample count, clamped to what the device supports (see msaaSamples_)
+            VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
+            // Pack built by vulkan_packer from the assets tree, mapped at startup. Paths under
+            // assetMountPoint are read from it; without the file, assets load from disk.
+            std::string assetPackPath = "";
+            std::string assetMountPoint = "../assets/";
+            // Loose asset files are read through io_uring where available, else a thread pool
+            bool enableIoUring = true;
         };
 
         VulkanApplication(const Config& config);
@@ -39,13 +79,43 @@ class VulkanApplication{
         virtual void recordRenderCommands(VkCommandBuffer commnadBuffer, uint32_t imageIndex) {}
         virtual void renderGui() {}
         virtual void onCleanup() {} 
+        // Called after the swapchain was recreated, with the device idle. Rebuild anything sized to it here.
+        virtual void onSwapchainRecreated() {}
+        // Called after each frame was presented, before the next one starts: nothing is being recorded,
+        // so settings that must apply to whole frames (metrics, capture) can be switched here
+        virtual void onFrameEnd() {}
+
+        // Latency and throughput controls, applied at the start of the next frame. Present mode and
+        // image count recreate the swapchain; the frame count is clamped to [1, maxFramesInFlight].
+        void setPresentMode(VkPresentModeKHR mode);
+        void setSwapchainImageCount(uint32_t count);
+        void setFramesInFlight(uint32_t count);
+        void setFrameRateLimit(double framesPerSecond);
+        uint32_t getFramesInFlight() const { return framesInFlight_; }
+        // Frames submitted so far; the one being recorded has this number
+        uint64_t getFrameNumber() const { return frameNumber_; }
+        // Frames [0, count) have finished executing on the GPU. Updated after the frame's fence wait,
+        // so work recorded in frame N can be read without waiting once this exceeds N.
+        uint64_t getCompletedFrameCount() const { return completedFrames_; }
+        // Headless only: the swapchain is recreated with this size at the start of the next frame
+        void requestResize(uint32_t width, uint32_t height);
+        // Leaves the main loop after the current frame
+        void requestClose() { closeRequested_ = true; }
 
         Config config_;
+        // Sample count the main pipeline and GUI are built for
+        VkSampleCountFlagBits msaaSamples_ = VK_SAMPLE_COUNT_1_BIT;
         GLFWwindow* window_;
         VkSurfaceKHR surface_;
 
+        // Declared first so the mapping outlives every loader reading from it; null without a pack
+        std::unique_ptr<AssetPack> assetPack_;
+        std::unique_ptr<AsyncFileReader> fileReader_;
         std::unique_ptr<VulkanInstance> vulkanInstance_;
         std::unique_ptr<VulkanDevice> vulkanDevice_;
+        // Declared after the device so cached layouts and pipelines outlive everything that uses them
+        std::unique_ptr<LayoutCache> layoutCache_;
+        std::unique_ptr<PipelineManager> pipelineManager_;
         std::unique_ptr<VulkanSwapchain> vulkanSwapchain_;
         std::unique_ptr<VulkanGraphicsPipeline> vulkanPipeline_;
         std::unique_ptr<CommandManager> commandManager_;
@@ -53,14 +123,50 @@ class VulkanApplication{
         std::unique_ptr<TextureManager> textureManager_;
         std::unique_ptr<DescriptorManager> descriptorManager_;
         std::unique_ptr<GuiManager> guiManager_;
+        std::unique_ptr<ShaderHotReloader> shaderHotReloader_;
+        std::unique_ptr<FrameLimiter> frameLimiter_;
+        // Acquire and present hold it, as does the latency monitor while it waits on a present
+        std::mutex swapchainMutex_;
+        std::unique_ptr<LatencyMonitor> latencyMonitor_;
+        // Shown in the GUI's performance panel; derived classes add their own series (passes, draws)
+        std::unique_ptr<Metrics> metrics_;
 
         std::vector<VkSemaphore> imageAvailableSemaphores_;
         std::vector<VkSemaphore> renderFinishedSemaphores_;
         std::vector<VkFence> inFlightFences_;
         uint32_t currentFrame_ = 0;
+        // Frame slots in rotation, at most config_.maxFramesInFlight
+        uint32_t framesInFlight_ = 0;
         bool framebufferResized_ = false;
+        uint64_t frameNumber_ = 0;
+        uint64_t completedFrames_ = 0;
+        // Number of the frame last submitted with each slot's fence, plus one (0 when unused)
+        std::vector<uint64_t> slotFrames_;
 
     private:
+        // Series recorded by drawFrame
+        struct FrameSeries {
+            Metrics::SeriesId frameTime;
+            Metrics::SeriesId fenceWait;
+            Metrics::SeriesId acquire;
+            Metrics::SeriesId limiter;
+            Metrics::SeriesId input;
+            Metrics::SeriesId update;
+            Metrics::SeriesId gui;
+            Metrics::SeriesId record;
+            Metrics::SeriesId submit;
+            Metrics::SeriesId present;
+            Metrics::SeriesId pipelines;
+            Metrics::SeriesId setLayouts;
+            Metrics::SeriesId pipelineLayouts;
+            Metrics::SeriesId descriptorSets;
+        };
+
+        uint32_t requestedFramesInFlight_ = 0;
+        bool swapchainSettingsChanged_ = false;
+        bool closeRequested_ = false;
+        FrameSeries frameSeries_{};
+
         void initWindow();
         void initVulkan();
         void mainLoop();
@@ -68,6 +174,10 @@ class VulkanApplication{
         void cleanup();
         void recreateSwapChain();
         void createSyncObjects();
+        void createSurface();
+        void createMetrics();
+        void openAssetPack();
+        void recordFrameCounters();
 
         static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 };
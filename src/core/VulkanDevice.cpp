@@ -3,6 +3,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <set>
+#include <string>
 
 VulkanDevice::VulkanDevice(){
 }
@@ -11,9 +12,10 @@ VulkanDevice::~VulkanDevice(){
     cleanup();
 }
 
-void VulkanDevice::initialize(const VulkanInstance& instance, VkSurfaceKHR surface){
+void VulkanDevice::initialize(const VulkanInstance& instance, VkSurfaceKHR surface, bool preferDynamicRendering){
     this->vulkanInstance = &instance;
     this->surface = surface;
+    this->preferDynamicRendering = preferDynamicRendering;
 
     pickPhysicalDevice();
     createLogicalDevice();
@@ -71,17 +73,28 @@ void VulkanDevice::createLogicalDevice(){
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    deviceFeatures.samplerAnisotropy = VK_TRUE;
+    selectFeatures();
+
+    VkPhysicalDeviceFeatures2 deviceFeatures{};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = apiVersion >= VK_API_VERSION_1_2 ? &enabledVulkan12Features : nullptr;
+    enabledVulkan12Features.pNext = apiVersion >= VK_API_VERSION_1_3 ? &enabledVulkan13Features : nullptr;
+    deviceFeatures.features = enabledFeatures;
+    if (isPresentWaitEnabled()) {
+        enabledPresentIdFeatures.pNext = &enabledPresentWaitFeatures;
+        enabledPresentWaitFeatures.pNext = deviceFeatures.pNext;
+        deviceFeatures.pNext = &enabledPresentIdFeatures;
+    }
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pEnabledFeatures = nullptr;
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
     if(vulkanInstance->isValidationEnabled()){
         const auto& validationLayers = vulkanInstance->getValidationLayers();
         createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -102,6 +115,83 @@ void VulkanDevice::createLogicalDevice(){
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
 }
 
+void VulkanDevice::selectFeatures(){
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    apiVersion = properties.apiVersion;
+
+    VkPhysicalDeviceVulkan13Features supportedVulkan13Features{};
+    supportedVulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features{};
+    supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (apiVersion >= VK_API_VERSION_1_3) {
+        supportedVulkan12Features.pNext = &supportedVulkan13Features;
+    }
+
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    if (apiVersion >= VK_API_VERSION_1_2) {
+        supportedFeatures.pNext = &supportedVulkan12Features;
+    }
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    enabledFeatures = {};
+    enabledFeatures.samplerAnisotropy = VK_TRUE;
+    // Optional features, only requested when the device offers them
+    enabledFeatures.multiDrawIndirect = supportedFeatures.features.multiDrawIndirect;
+    enabledFeatures.fillModeNonSolid = supportedFeatures.features.fillModeNonSolid;
+
+    enabledVulkan12Features = {};
+    enabledVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledVulkan12Features.drawIndirectCount = supportedVulkan12Features.drawIndirectCount;
+
+    // Both or neither, the render graph uses them together
+    enabledVulkan13Features = {};
+    enabledVulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    if (preferDynamicRendering && supportedVulkan13Features.dynamicRendering && supportedVulkan13Features.synchronization2) {
+        enabledVulkan13Features.dynamicRendering = VK_TRUE;
+        enabledVulkan13Features.synchronization2 = VK_TRUE;
+    }
+
+    // Present wait needs present ids, enabled together when both extensions are there
+    enabledExtensions = deviceExtensions;
+    enabledPresentIdFeatures = {};
+    enabledPresentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    enabledPresentWaitFeatures = {};
+    enabledPresentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    if (hasDeviceExtension(physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        hasDeviceExtension(physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+        VkPhysicalDevicePresentWaitFeaturesKHR supportedPresentWait{};
+        supportedPresentWait.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        VkPhysicalDevicePresentIdFeaturesKHR supportedPresentId{};
+        supportedPresentId.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        supportedPresentId.pNext = &supportedPresentWait;
+        VkPhysicalDeviceFeatures2 presentFeatures{};
+        presentFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        presentFeatures.pNext = &supportedPresentId;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &presentFeatures);
+
+        if (supportedPresentId.presentId && supportedPresentWait.presentWait) {
+            enabledPresentIdFeatures.presentId = VK_TRUE;
+            enabledPresentWaitFeatures.presentWait = VK_TRUE;
+            enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+            enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+        }
+    }
+
+    // Only adds properties, nothing to enable beyond the extension
+    memoryBudgetEnabled = hasDeviceExtension(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudgetEnabled) {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    std::cout << "Indirect count draws supported - " << isIndirectCountEnabled() << std::endl;
+    std::cout << "Dynamic rendering enabled - " << isDynamicRenderingEnabled() << std::endl;
+    std::cout << "Present wait enabled - " << isPresentWaitEnabled() << std::endl;
+    std::cout << "Memory budget enabled - " << isMemoryBudgetEnabled() << std::endl;
+}
+
 bool VulkanDevice::isDeviceSuitable(VkPhysicalDevice device) const {
     QueueFamilyIndices indices = findQueueFamilies(device);
     bool extensionsSupported = checkDeviceExtensionSupport(device);
@@ -130,6 +220,20 @@ bool VulkanDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) const {
     return requiredExtensions.empty();
 }
 
+bool VulkanDevice::hasDeviceExtension(VkPhysicalDevice device, const char* extensionName) const {
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& extension : availableExtensions) {
+        if (std::string(extension.extensionName) == extensionName) {
+            return true;
+        }
+    }
+    return false;
+}
+
 QueueFamilyIndices VulkanDevice::findQueueFamilies(VkPhysicalDevice device) const {
     QueueFamilyIndices indices;
 
@@ -194,4 +298,36 @@ uint32_t VulkanDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags
     throw std::runtime_error("Failed to find suitable memory type!");
 }
 
+VkSampleCountFlagBits VulkanDevice::getMaxUsableSampleCount() const {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
 
+    VkSampleCountFlags counts = properties.limits.framebufferColorSampleCounts & properties.limits.framebufferDepthSampleCounts;
+    for (VkSampleCountFlagBits samples : {VK_SAMPLE_COUNT_64_BIT, VK_SAMPLE_COUNT_32_BIT, VK_SAMPLE_COUNT_16_BIT,
+                                          VK_SAMPLE_COUNT_8_BIT, VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_2_BIT}) {
+        if (counts & samples) {
+            return samples;
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+std::vector<MemoryHeapUsage> VulkanDevice::getMemoryHeapUsage() const {
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties.pNext = memoryBudgetEnabled ? &budgetProperties : nullptr;
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &memoryProperties);
+
+    std::vector<MemoryHeapUsage> heaps(memoryProperties.memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < heaps.size(); i++) {
+        heaps[i].size = memoryProperties.memoryProperties.memoryHeaps[i].size;
+        heaps[i].flags = memoryProperties.memoryProperties.memoryHeaps[i].flags;
+        if (memoryBudgetEnabled) {
+            heaps[i].budget = budgetProperties.heapBudget[i];
+            heaps[i].usage = budgetProperties.heapUsage[i];
+        }
+    }
+    return heaps;
+}
@@ -20,6 +20,14 @@ struct SwapChainSupportDetails{
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+struct MemoryHeapUsage {
+    VkDeviceSize size = 0;
+    VkMemoryHeapFlags flags = 0;
+    // From VK_EXT_memory_budget, 0 without it
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+};
+
 class VulkanInstance;
 
 class VulkanDevice {
@@ -27,17 +35,32 @@ class VulkanDevice {
         VulkanDevice();
         ~VulkanDevice();
 
-        void initialize(const VulkanInstance& instance, VkSurfaceKHR surface);
+        // With preferDynamicRendering, dynamic rendering and synchronization2 are enabled when the
+        // device supports both
+        void initialize(const VulkanInstance& instance, VkSurfaceKHR surface, bool preferDynamicRendering = true);
         void cleanup();
 
         VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
         VkDevice getLogicalDevice() const { return device; }
         VkQueue getGraphicsQueue() const { return graphicsQueue; }
         VkQueue getPresentQueue() const { return presentQueue; }
+        const VkPhysicalDeviceFeatures& getEnabledFeatures() const { return enabledFeatures; }
+        // GPU driven draws (vkCmdDrawIndexedIndirectCount with more than one draw)
+        bool isIndirectCountEnabled() const { return enabledVulkan12Features.drawIndirectCount && enabledFeatures.multiDrawIndirect; }
+        // Rendering without VkRenderPass/VkFramebuffer objects, with vkCmdPipelineBarrier2 barriers
+        bool isDynamicRenderingEnabled() const { return enabledVulkan13Features.dynamicRendering && enabledVulkan13Features.synchronization2; }
+        // VK_KHR_present_id and VK_KHR_present_wait, for measuring when presented frames reach the display
+        bool isPresentWaitEnabled() const { return enabledPresentWaitFeatures.presentWait == VK_TRUE; }
+        // VK_EXT_memory_budget, for the current usage and budget of each memory heap
+        bool isMemoryBudgetEnabled() const { return memoryBudgetEnabled; }
 
         QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) const;
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device) const;
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+        // Highest sample count supported by both color and depth framebuffer attachments
+        VkSampleCountFlagBits getMaxUsableSampleCount() const;
+        // One entry per memory heap, with the process's usage and budget when the extension is enabled
+        std::vector<MemoryHeapUsage> getMemoryHeapUsage() const;
 
     private:
         const VulkanInstance* vulkanInstance = nullptr;
@@ -46,14 +69,26 @@ class VulkanDevice {
         VkDevice device = VK_NULL_HANDLE;
         VkQueue graphicsQueue = VK_NULL_HANDLE;
         VkQueue presentQueue = VK_NULL_HANDLE;
+        uint32_t apiVersion = 0;
+        bool preferDynamicRendering = true;
+        VkPhysicalDeviceFeatures enabledFeatures{};
+        VkPhysicalDeviceVulkan12Features enabledVulkan12Features{};
+        VkPhysicalDeviceVulkan13Features enabledVulkan13Features{};
+        VkPhysicalDevicePresentIdFeaturesKHR enabledPresentIdFeatures{};
+        VkPhysicalDevicePresentWaitFeaturesKHR enabledPresentWaitFeatures{};
+        bool memoryBudgetEnabled = false;
 
         const std::vector<const char*> deviceExtensions = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME
         };
+        // deviceExtensions plus the optional extensions the device supports
+        std::vector<const char*> enabledExtensions;
 
         void pickPhysicalDevice();
         void createLogicalDevice();
+        void selectFeatures();
         bool isDeviceSuitable(VkPhysicalDevice device) const;
         bool checkDeviceExtensionSupport(VkPhysicalDevice device) const;
+        bool hasDeviceExtension(VkPhysicalDevice device, const char* extensionName) const;
 };
 
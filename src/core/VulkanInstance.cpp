@@ -17,7 +17,8 @@ VulkanInstance::~VulkanInstance(){
     cleanup();
 }
 
-void VulkanInstance::initialize(){
+void VulkanInstance::initialize(bool headless){
+    this->headless = headless;
     createInstance();
     setupDebugMessenger();
 }
@@ -112,11 +113,16 @@ bool VulkanInstance::checkValidationLayerSupport(){
 }
 
 std::vector<const char*> VulkanInstance::getRequiredExtensions(){
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char*> extensions;
+    if (headless) {
+        extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    } else {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
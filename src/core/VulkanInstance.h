@@ -12,7 +12,9 @@ class VulkanInstance{
         VulkanInstance(const VulkanInstance&) = delete;
         VulkanInstance& operator=(const VulkanInstance&) = delete;
 
-        void initialize();
+        // Headless instances enable VK_EXT_headless_surface instead of the window system surface
+        // extensions, so no display (or GLFW) is needed
+        void initialize(bool headless = false);
         void cleanup();
 
         VkInstance getInstance() const { return instance; }
@@ -23,6 +25,7 @@ class VulkanInstance{
         VkInstance instance = VK_NULL_HANDLE;
         VkDebugUtilsMessengerEXT debugMessenger = VK_NULL_HANDLE;
         bool enableValidationLayers;
+        bool headless = false;
 
         const std::vector<const char*> validationLayers = {
             "VK_LAYER_KHRONOS_validation"
@@ -2,12 +2,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <glm/glm.hpp>
-
-struct UniformBufferObject{
-    glm::mat4 model;
-    glm::mat4 view;
-    glm::mat4 proj;
-};
+#include "../common/UniformTypes.h"
 
 DescriptorManager::DescriptorManager() {}
 
@@ -66,6 +61,7 @@ void DescriptorManager::createDescriptorSets(VkDescriptorSetLayout descriptorSet
     }else{
         std::cout << "Successfully created descriptor sets - " << descriptorSetsResult << std::endl;
     }
+    allocatedSetCount += maxFramesInFlight;
 
     for (size_t i = 0; i < maxFramesInFlight; i++) {
         VkDescriptorBufferInfo bufferInfo{};
@@ -103,5 +99,6 @@ void DescriptorManager::destroyDescriptorPool() {
     if (descriptorPool != VK_NULL_HANDLE) {
         vkDestroyDescriptorPool(vulkanDevice->getLogicalDevice(), descriptorPool, nullptr);
         descriptorPool = VK_NULL_HANDLE;
+        allocatedSetCount = 0;
     }
 }
\ No newline at end of file
@@ -5,8 +5,6 @@
 #include <array>
 #include "../core/VulkanDevice.h"
 
-struct UniformBufferObject;
-
 class DescriptorManager {
     public:
         DescriptorManager();
@@ -24,10 +22,13 @@ class DescriptorManager {
                              std::vector<VkDescriptorSet>& descriptorSets);
 
         VkDescriptorPool getDescriptorPool() const { return descriptorPool; }
+        // Sets allocated from the current pool
+        uint32_t getAllocatedSetCount() const { return allocatedSetCount; }
 
         void destroyDescriptorPool();
 
     private:
         const VulkanDevice* vulkanDevice = nullptr;
         VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        uint32_t allocatedSetCount = 0;
 };
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "LayoutCache.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include "../common/Hash.h"
+
+bool LayoutCache::SetLayoutKey::operator==(const SetLayoutKey& other) const {
+    if (bindings.size() != other.bindings.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const VkDescriptorSetLayoutBinding& a = bindings[i];
+        const VkDescriptorSetLayoutBinding& b = other.bindings[i];
+        if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+            a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t LayoutCache::SetLayoutKeyHash::operator()(const SetLayoutKey& key) const {
+    size_t seed = key.bindings.size();
+    for (const VkDescriptorSetLayoutBinding& binding : key.bindings) {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, binding.descriptorType);
+        hashCombine(seed, binding.descriptorCount);
+        hashCombine(seed, binding.stageFlags);
+    }
+    return seed;
+}
+
+bool LayoutCache::PipelineLayoutKey::operator==(const PipelineLayoutKey& other) const {
+    if (setLayouts != other.setLayouts || pushConstantRanges.size() != other.pushConstantRanges.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < pushConstantRanges.size(); i++) {
+        const VkPushConstantRange& a = pushConstantRanges[i];
+        const VkPushConstantRange& b = other.pushConstantRanges[i];
+        if (a.stageFlags != b.stageFlags || a.offset != b.offset || a.size != b.size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t LayoutCache::PipelineLayoutKeyHash::operator()(const PipelineLayoutKey& key) const {
+    size_t seed = key.setLayouts.size();
+    for (VkDescriptorSetLayout setLayout : key.setLayouts) {
+        hashCombine(seed, std::hash<VkDescriptorSetLayout>()(setLayout));
+    }
+    for (const VkPushConstantRange& range : key.pushConstantRanges) {
+        hashCombine(seed, range.stageFlags);
+        hashCombine(seed, range.offset);
+        hashCombine(seed, range.size);
+    }
+    return seed;
+}
+
+LayoutCache::LayoutCache() {}
+
+LayoutCache::~LayoutCache() {
+    cleanup();
+}
+
+void LayoutCache::initialize(const VulkanDevice& device) {
+    vulkanDevice = &device;
+}
+
+void LayoutCache::cleanup() {
+    if (!vulkanDevice) {
+        return;
+    }
+    for (auto& entry : pipelineLayouts) {
+        vkDestroyPipelineLayout(vulkanDevice->getLogicalDevice(), entry.second, nullptr);
+    }
+    for (auto& entry : setLayouts) {
+        vkDestroyDescriptorSetLayout(vulkanDevice->getLogicalDevice(), entry.second, nullptr);
+    }
+    pipelineLayouts.clear();
+    setLayouts.clear();
+    vulkanDevice = nullptr;
+}
+
+VkDescriptorSetLayout LayoutCache::getDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> bindings) {
+    // Binding order must not affect the key
+    std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs) {
+        return lhs.binding < rhs.binding;
+    });
+    SetLayoutKey key{bindings};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = setLayouts.find(key);
+    if (it != setLayouts.end()) {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    VkDescriptorSetLayout setLayout;
+    VkResult result = vkCreateDescriptorSetLayout(vulkanDevice->getLogicalDevice(), &layoutInfo, nullptr, &setLayout);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to create descriptor layout - " << result << std::endl;
+        throw std::runtime_error("Failed to create descriptor layout");
+    }
+
+    setLayouts.emplace(std::move(key), setLayout);
+    return setLayout;
+}
+
+VkPipelineLayout LayoutCache::getPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayoutHandles,
+                                                std::vector<VkPushConstantRange> pushConstantRanges) {
+    std::sort(pushConstantRanges.begin(), pushConstantRanges.end(), [](const VkPushConstantRange& lhs, const VkPushConstantRange& rhs) {
+        return lhs.offset != rhs.offset ? lhs.offset < rhs.offset : lhs.stageFlags < rhs.stageFlags;
+    });
+    PipelineLayoutKey key{setLayoutHandles, pushConstantRanges};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pipelineLayouts.find(key);
+    if (it != pipelineLayouts.end()) {
+        return it->second;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayoutHandles.size());
+    pipelineLayoutInfo.pSetLayouts = setLayoutHandles.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+    VkPipelineLayout pipelineLayout;
+    VkResult result = vkCreatePipelineLayout(vulkanDevice->getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to create pipeline layout - " << result << std::endl;
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    pipelineLayouts.emplace(std::move(key), pipelineLayout);
+    return pipelineLayout;
+}
+
+size_t LayoutCache::getSetLayoutCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return setLayouts.size();
+}
+
+size_t LayoutCache::getPipelineLayoutCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pipelineLayouts.size();
+}
+
+LayoutCache::PipelineLayoutInfo LayoutCache::getLayouts(const ShaderReflection& reflection) {
+    uint32_t setCount = 0;
+    for (const ReflectedBinding& binding : reflection.bindings) {
+        setCount = std::max(setCount, binding.set + 1);
+    }
+
+    // Unused set numbers in between get an empty layout so set indices stay stable
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> setBindings(setCount);
+    for (const ReflectedBinding& binding : reflection.bindings) {
+        VkDescriptorSetLayoutBinding layoutBinding{};
+        layoutBinding.binding = binding.binding;
+        layoutBinding.descriptorType = binding.type;
+        layoutBinding.descriptorCount = binding.count;
+        layoutBinding.stageFlags = binding.stages;
+        setBindings[binding.set].push_back(layoutBinding);
+    }
+
+    PipelineLayoutInfo info;
+    for (const auto& bindings : setBindings) {
+        info.setLayouts.push_back(getDescriptorSetLayout(bindings));
+    }
+    info.pipelineLayout = getPipelineLayout(info.setLayouts, reflection.pushConstantRanges);
+    return info;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "../core/VulkanDevice.h"
+#include "ShaderReflection.h"
+
+// Deduplicates descriptor set layouts and pipeline layouts. Identical binding lists (or identical
+// set layout + push constant combinations) return the same handle, so pipelines share layouts
+// and descriptor sets stay compatible between them. Safe to use from multiple threads.
+class LayoutCache {
+    public:
+        struct PipelineLayoutInfo {
+            std::vector<VkDescriptorSetLayout> setLayouts;  // indexed by set number
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        };
+
+        LayoutCache();
+        ~LayoutCache();
+
+        void initialize(const VulkanDevice& device);
+        void cleanup();
+
+        VkDescriptorSetLayout getDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> bindings);
+        VkPipelineLayout getPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayoutHandles,
+                                           std::vector<VkPushConstantRange> pushConstantRanges);
+
+        // Builds (or finds) every set layout and the pipeline layout of a merged shader interface
+        PipelineLayoutInfo getLayouts(const ShaderReflection& reflection);
+
+        size_t getSetLayoutCount() const;
+        size_t getPipelineLayoutCount() const;
+
+    private:
+        struct SetLayoutKey {
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            bool operator==(const SetLayoutKey& other) const;
+        };
+        struct SetLayoutKeyHash {
+            size_t operator()(const SetLayoutKey& key) const;
+        };
+
+        struct PipelineLayoutKey {
+            std::vector<VkDescriptorSetLayout> setLayouts;
+            std::vector<VkPushConstantRange> pushConstantRanges;
+            bool operator==(const PipelineLayoutKey& other) const;
+        };
+        struct PipelineLayoutKeyHash {
+            size_t operator()(const PipelineLayoutKey& key) const;
+        };
+
+        const VulkanDevice* vulkanDevice = nullptr;
+        mutable std::mutex mutex;
+        std::unordered_map<SetLayoutKey, VkDescriptorSetLayout, SetLayoutKeyHash> setLayouts;
+        std::unordered_map<PipelineLayoutKey, VkPipelineLayout, PipelineLayoutKeyHash> pipelineLayouts;
+};
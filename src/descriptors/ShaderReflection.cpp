@@ -0,0 +1,464 @@
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    const uint32_t SPIRV_MAGIC = 0x07230203;
+
+    // Opcodes, decorations and enums from the SPIR-V specification that the reflection needs
+    enum Op : uint32_t {
+        OpName = 5,
+        OpEntryPoint = 15,
+        OpTypeBool = 20,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpSpecConstantTrue = 48,
+        OpSpecConstantFalse = 49,
+        OpSpecConstant = 50,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeAccelerationStructureKHR = 5341
+    };
+
+    enum Decoration : uint32_t {
+        DecorationSpecId = 1,
+        DecorationBlock = 2,
+        DecorationBufferBlock = 3,
+        DecorationArrayStride = 6,
+        DecorationMatrixStride = 7,
+        DecorationBuiltIn = 11,
+        DecorationLocation = 30,
+        DecorationBinding = 33,
+        DecorationDescriptorSet = 34,
+        DecorationOffset = 35
+    };
+
+    enum StorageClass : uint32_t {
+        StorageClassUniformConstant = 0,
+        StorageClassInput = 1,
+        StorageClassUniform = 2,
+        StorageClassPushConstant = 9,
+        StorageClassStorageBuffer = 12
+    };
+
+    const uint32_t DIM_BUFFER = 5;
+    const uint32_t DIM_SUBPASS_DATA = 6;
+
+    struct Member {
+        uint32_t offset = 0;
+        uint32_t matrixStride = 0;
+    };
+
+    struct Id {
+        uint32_t opcode = 0;
+        std::vector<uint32_t> operands; // everything after the result id
+        std::string name;
+
+        uint32_t set = 0;
+        uint32_t binding = ~0u;
+        uint32_t location = ~0u;
+        uint32_t specId = ~0u;
+        uint32_t arrayStride = 0;
+        bool builtIn = false;
+        bool block = false;
+        bool bufferBlock = false;
+        std::vector<Member> members;
+    };
+
+    class Module {
+        public:
+            std::unordered_map<uint32_t, Id> ids;
+
+            Id& get(uint32_t id) {
+                return ids[id];
+            }
+
+            Member& member(uint32_t id, uint32_t index) {
+                Id& type = ids[id];
+                if (type.members.size() <= index) {
+                    type.members.resize(index + 1);
+                }
+                return type.members[index];
+            }
+
+            uint32_t constantValue(uint32_t id) {
+                Id& constant = ids[id];
+                if (constant.opcode != OpConstant || constant.operands.size() < 2) {
+                    return 1; // specialization constant sized arrays, treat as a single element
+                }
+                return constant.operands[1];
+            }
+
+            // Size in bytes following the explicit layout decorations (Offset, ArrayStride, MatrixStride)
+            uint32_t typeSize(uint32_t typeId, uint32_t matrixStride = 0) {
+                Id& type = ids[typeId];
+                switch (type.opcode) {
+                    case OpTypeBool:
+                        return 4;
+                    case OpTypeInt:
+                    case OpTypeFloat:
+                        return type.operands[0] / 8;
+                    case OpTypeVector:
+                        return typeSize(type.operands[0]) * type.operands[1];
+                    case OpTypeMatrix: {
+                        uint32_t columnSize = matrixStride != 0 ? matrixStride : typeSize(type.operands[0]);
+                        return columnSize * type.operands[1];
+                    }
+                    case OpTypeArray: {
+                        uint32_t stride = type.arrayStride != 0 ? type.arrayStride : typeSize(type.operands[0], matrixStride);
+                        return stride * constantValue(type.operands[1]);
+                    }
+                    case OpTypeRuntimeArray:
+                        return 0;
+                    case OpTypeStruct: {
+                        uint32_t size = 0;
+                        for (uint32_t i = 0; i < type.operands.size(); i++) {
+                            Member layout = i < type.members.size() ? type.members[i] : Member{};
+                            size = std::max(size, layout.offset + typeSize(type.operands[i], layout.matrixStride));
+                        }
+                        return size;
+                    }
+                    default:
+                        return 0;
+                }
+            }
+
+            // Lowest member offset of a block, push constant ranges start there
+            uint32_t firstOffset(uint32_t structId) {
+                Id& type = ids[structId];
+                uint32_t offset = ~0u;
+                for (uint32_t i = 0; i < type.operands.size(); i++) {
+                    offset = std::min(offset, i < type.members.size() ? type.members[i].offset : 0u);
+                }
+                return offset == ~0u ? 0 : offset;
+            }
+
+            VkFormat vertexFormat(uint32_t typeId) {
+                Id& type = ids[typeId];
+                uint32_t componentCount = 1;
+                Id* component = &type;
+                if (type.opcode == OpTypeVector) {
+                    componentCount = type.operands[1];
+                    component = &ids[type.operands[0]];
+                }
+
+                if (component->opcode == OpTypeFloat && component->operands[0] == 32) {
+                    const VkFormat formats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+                    return formats[componentCount - 1];
+                }
+                if (component->opcode == OpTypeInt && component->operands[0] == 32) {
+                    bool isSigned = component->operands[1] != 0;
+                    const VkFormat signedFormats[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+                    const VkFormat unsignedFormats[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+                    return isSigned ? signedFormats[componentCount - 1] : unsignedFormats[componentCount - 1];
+                }
+                return VK_FORMAT_UNDEFINED;
+            }
+    };
+
+    VkShaderStageFlagBits stageFromExecutionModel(uint32_t model) {
+        switch (model) {
+            case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+            case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+            default: return VK_SHADER_STAGE_ALL;
+        }
+    }
+
+    std::string readString(const uint32_t* words, size_t wordCount) {
+        const char* begin = reinterpret_cast<const char*>(words);
+        size_t length = 0;
+        while (length < wordCount * 4 && begin[length] != '\0') {
+            length++;
+        }
+        return std::string(begin, length);
+    }
+}
+
+ShaderReflection ShaderReflection::reflect(const std::vector<char>& spirv) {
+    if (spirv.size() % 4 != 0) {
+        throw std::runtime_error("SPIR-V code size is not a multiple of 4!");
+    }
+    std::vector<uint32_t> words(spirv.size() / 4);
+    std::copy(spirv.begin(), spirv.end(), reinterpret_cast<char*>(words.data()));
+    return reflect(words.data(), words.size());
+}
+
+ShaderReflection ShaderReflection::reflect(const uint32_t* code, size_t wordCount) {
+    if (wordCount < 5 || code[0] != SPIRV_MAGIC) {
+        throw std::runtime_error("invalid SPIR-V module!");
+    }
+
+    ShaderReflection reflection;
+    Module module;
+    std::vector<uint32_t> variables;
+
+    size_t position = 5;
+    while (position < wordCount) {
+        uint32_t opcode = code[position] & 0xffff;
+        uint32_t instructionWords = code[position] >> 16;
+        if (instructionWords == 0 || position + instructionWords > wordCount) {
+            throw std::runtime_error("truncated SPIR-V instruction!");
+        }
+        const uint32_t* operands = code + position + 1;
+        const uint32_t operandCount = instructionWords - 1;
+
+        switch (opcode) {
+            case OpEntryPoint:
+                // Only the first entry point is reflected, which is all glslc emits
+                if (reflection.entryPoint.empty() && operandCount >= 3) {
+                    reflection.stages = stageFromExecutionModel(operands[0]);
+                    reflection.entryPoint = readString(operands + 2, operandCount - 2);
+                }
+                break;
+            case OpName:
+                module.get(operands[0]).name = readString(operands + 1, operandCount - 1);
+                break;
+            case OpDecorate: {
+                Id& target = module.get(operands[0]);
+                uint32_t value = operandCount > 2 ? operands[2] : 0;
+                switch (operands[1]) {
+                    case DecorationSpecId: target.specId = value; break;
+                    case DecorationBlock: target.block = true; break;
+                    case DecorationBufferBlock: target.bufferBlock = true; break;
+                    case DecorationArrayStride: target.arrayStride = value; break;
+                    case DecorationBuiltIn: target.builtIn = true; break;
+                    case DecorationLocation: target.location = value; break;
+                    case DecorationBinding: target.binding = value; break;
+                    case DecorationDescriptorSet: target.set = value; break;
+                    default: break;
+                }
+                break;
+            }
+            case OpMemberDecorate: {
+                uint32_t value = operandCount > 3 ? operands[3] : 0;
+                if (operands[2] == DecorationOffset) {
+                    module.member(operands[0], operands[1]).offset = value;
+                } else if (operands[2] == DecorationMatrixStride) {
+                    module.member(operands[0], operands[1]).matrixStride = value;
+                } else if (operands[2] == DecorationBuiltIn) {
+                    module.get(operands[0]).builtIn = true;
+                }
+                break;
+            }
+            case OpTypeBool:
+            case OpTypeInt:
+            case OpTypeFloat:
+            case OpTypeVector:
+            case OpTypeMatrix:
+            case OpTypeImage:
+            case OpTypeSampler:
+            case OpTypeSampledImage:
+            case OpTypeArray:
+            case OpTypeRuntimeArray:
+            case OpTypeStruct:
+            case OpTypePointer:
+            case OpTypeAccelerationStructureKHR: {
+                Id& id = module.get(operands[0]);
+                id.opcode = opcode;
+                id.operands.assign(operands + 1, operands + operandCount);
+                break;
+            }
+            case OpConstant:
+            case OpSpecConstant:
+            case OpSpecConstantTrue:
+            case OpSpecConstantFalse: {
+                // Result type comes first for constants, keep it as operand 0
+                Id& id = module.get(operands[1]);
+                id.opcode = opcode;
+                id.operands.assign(operands, operands + operandCount);
+                id.operands.erase(id.operands.begin() + 1);
+                break;
+            }
+            case OpVariable: {
+                Id& id = module.get(operands[1]);
+                id.opcode = opcode;
+                id.operands = {operands[0], operands[2]}; // pointer type, storage class
+                variables.push_back(operands[1]);
+                break;
+            }
+            default:
+                break;
+        }
+
+        position += instructionWords;
+    }
+
+    for (uint32_t variableId : variables) {
+        Id& variable = module.get(variableId);
+        uint32_t storageClass = variable.operands[1];
+        Id& pointer = module.get(variable.operands[0]);
+        if (pointer.opcode != OpTypePointer) {
+            continue;
+        }
+        uint32_t typeId = pointer.operands[1];
+
+        if (storageClass == StorageClassInput) {
+            if (reflection.stages == VK_SHADER_STAGE_VERTEX_BIT && !variable.builtIn && !module.get(typeId).builtIn && variable.location != ~0u) {
+                reflection.vertexInputs.push_back({variable.location, module.vertexFormat(typeId), variable.name});
+            }
+            continue;
+        }
+
+        if (storageClass == StorageClassPushConstant) {
+            VkPushConstantRange range{};
+            range.stageFlags = reflection.stages;
+            range.offset = module.firstOffset(typeId);
+            range.size = module.typeSize(typeId) - range.offset;
+            reflection.pushConstantRanges.push_back(range);
+            continue;
+        }
+
+        if (storageClass != StorageClassUniform && storageClass != StorageClassUniformConstant &&
+            storageClass != StorageClassStorageBuffer) {
+            continue;
+        }
+        if (variable.binding == ~0u) {
+            continue;
+        }
+
+        ReflectedBinding binding;
+        binding.set = variable.set;
+        binding.binding = variable.binding;
+        binding.stages = reflection.stages;
+        binding.name = variable.name;
+
+        // Arrays of resources become the descriptor count
+        Id* type = &module.get(typeId);
+        while (type->opcode == OpTypeArray || type->opcode == OpTypeRuntimeArray) {
+            binding.count *= type->opcode == OpTypeArray ? module.constantValue(type->operands[1]) : 1;
+            typeId = type->operands[0];
+            type = &module.get(typeId);
+        }
+
+        switch (type->opcode) {
+            case OpTypeSampledImage:
+                binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                break;
+            case OpTypeSampler:
+                binding.type = VK_DESCRIPTOR_TYPE_SAMPLER;
+                break;
+            case OpTypeImage: {
+                uint32_t dim = type->operands[1];
+                uint32_t sampled = type->operands[5];
+                if (dim == DIM_BUFFER) {
+                    binding.type = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                } else if (dim == DIM_SUBPASS_DATA) {
+                    binding.type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                } else {
+                    binding.type = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                }
+                break;
+            }
+            case OpTypeStruct:
+                if (storageClass == StorageClassStorageBuffer || type->bufferBlock) {
+                    binding.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                } else {
+                    binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                }
+                binding.size = module.typeSize(typeId);
+                if (binding.name.empty()) {
+                    binding.name = type->name;
+                }
+                break;
+            case OpTypeAccelerationStructureKHR:
+                binding.type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+                break;
+            default:
+                continue;
+        }
+
+        reflection.bindings.push_back(binding);
+    }
+
+    for (auto& entry : module.ids) {
+        const Id& id = entry.second;
+        bool isSpecConstant = id.opcode == OpSpecConstant || id.opcode == OpSpecConstantTrue || id.opcode == OpSpecConstantFalse;
+        if (isSpecConstant && id.specId != ~0u) {
+            uint32_t size = id.opcode == OpSpecConstant ? module.typeSize(id.operands[0]) : 4;
+            reflection.specializationConstants.push_back({id.specId, size, id.name});
+        }
+    }
+
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ReflectedBinding& lhs, const ReflectedBinding& rhs) {
+        return lhs.set != rhs.set ? lhs.set < rhs.set : lhs.binding < rhs.binding;
+    });
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const ReflectedVertexInput& lhs, const ReflectedVertexInput& rhs) {
+        return lhs.location < rhs.location;
+    });
+    std::sort(reflection.specializationConstants.begin(), reflection.specializationConstants.end(),
+              [](const ReflectedSpecializationConstant& lhs, const ReflectedSpecializationConstant& rhs) {
+        return lhs.constantId < rhs.constantId;
+    });
+
+    return reflection;
+}
+
+ShaderReflection ShaderReflection::merge(const std::vector<ShaderReflection>& stages) {
+    ShaderReflection merged;
+
+    for (const ShaderReflection& stage : stages) {
+        merged.stages |= stage.stages;
+        if (stage.stages == VK_SHADER_STAGE_VERTEX_BIT) {
+            merged.vertexInputs = stage.vertexInputs;
+        }
+
+        for (const ReflectedBinding& binding : stage.bindings) {
+            auto existing = std::find_if(merged.bindings.begin(), merged.bindings.end(), [&](const ReflectedBinding& other) {
+                return other.set == binding.set && other.binding == binding.binding;
+            });
+            if (existing == merged.bindings.end()) {
+                merged.bindings.push_back(binding);
+                continue;
+            }
+            if (existing->type != binding.type || existing->count != binding.count) {
+                throw std::runtime_error("shader stages disagree on descriptor set " + std::to_string(binding.set) +
+                                         " binding " + std::to_string(binding.binding) + "!");
+            }
+            existing->stages |= binding.stages;
+            existing->size = std::max(existing->size, binding.size);
+        }
+
+        for (const VkPushConstantRange& range : stage.pushConstantRanges) {
+            auto existing = std::find_if(merged.pushConstantRanges.begin(), merged.pushConstantRanges.end(), [&](const VkPushConstantRange& other) {
+                return other.offset == range.offset && other.size == range.size;
+            });
+            if (existing == merged.pushConstantRanges.end()) {
+                merged.pushConstantRanges.push_back(range);
+            } else {
+                existing->stageFlags |= range.stageFlags;
+            }
+        }
+
+        for (const ReflectedSpecializationConstant& constant : stage.specializationConstants) {
+            auto existing = std::find_if(merged.specializationConstants.begin(), merged.specializationConstants.end(),
+                                         [&](const ReflectedSpecializationConstant& other) {
+                return other.constantId == constant.constantId;
+            });
+            if (existing == merged.specializationConstants.end()) {
+                merged.specializationConstants.push_back(constant);
+            }
+        }
+    }
+
+    std::sort(merged.bindings.begin(), merged.bindings.end(), [](const ReflectedBinding& lhs, const ReflectedBinding& rhs) {
+        return lhs.set != rhs.set ? lhs.set < rhs.set : lhs.binding < rhs.binding;
+    });
+    return merged;
+}
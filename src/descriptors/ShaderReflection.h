@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ReflectedBinding {
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    uint32_t count = 1;
+    VkShaderStageFlags stages = 0;
+    // Block size in bytes for uniform/storage buffers (runtime arrays count as zero)
+    uint32_t size = 0;
+    std::string name;
+};
+
+struct ReflectedVertexInput {
+    uint32_t location = 0;
+    // 32-bit format of the shader side type, e.g. vec3 -> VK_FORMAT_R32G32B32_SFLOAT
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    std::string name;
+};
+
+struct ReflectedSpecializationConstant {
+    uint32_t constantId = 0;
+    uint32_t size = 0;
+    std::string name;
+};
+
+// Interface of a single SPIR-V module, extracted by walking its instructions
+struct ShaderReflection {
+    // Stage of the entry point, or the union of all stages after merge()
+    VkShaderStageFlags stages = 0;
+    std::string entryPoint;
+    std::vector<ReflectedBinding> bindings;
+    std::vector<VkPushConstantRange> pushConstantRanges;
+    std::vector<ReflectedVertexInput> vertexInputs;
+    std::vector<ReflectedSpecializationConstant> specializationConstants;
+
+    // Throws std::runtime_error if the code is not a valid SPIR-V module
+    static ShaderReflection reflect(const std::vector<char>& spirv);
+    static ShaderReflection reflect(const uint32_t* code, size_t wordCount);
+
+    // Combines the interfaces of all stages of a pipeline: matching bindings merge their stage flags,
+    // push constant ranges become one range per stage set
+    static ShaderReflection merge(const std::vector<ShaderReflection>& stages);
+};
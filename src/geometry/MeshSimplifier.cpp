@@ -0,0 +1,280 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <limits>
+
+namespace {
+    struct CollapseCandidate {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    uint64_t edgeKey(uint32_t a, uint32_t b) {
+        if (a > b) {
+            std::swap(a, b);
+        }
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    // Vertex -> triangle adjacency in CSR form
+    void buildAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount,
+                        std::vector<uint32_t>& offsets, std::vector<uint32_t>& adjacency) {
+        offsets.assign(vertexCount + 1, 0);
+        for (uint32_t index : indices) {
+            offsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (uint32_t i = 0; i < indices.size(); i++) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+}
+
+std::vector<uint32_t> MeshSimplifier::simplify(const std::vector<uint32_t>& indices, const std::vector<StandardVertex>& vertices,
+                                               size_t targetIndexCount, float maxError, float& resultError) {
+    std::vector<uint32_t> result = indices;
+    resultError = 0.0f;
+    const size_t vertexCount = vertices.size();
+
+    // Vertices split along UV or normal seams share a position. Collapsing one side of a seam
+    // would tear the surface, so seam vertices and open borders stay locked.
+    std::vector<uint32_t> positionId(vertexCount);
+    std::vector<uint32_t> positionUses;
+    std::unordered_map<glm::vec3, uint32_t> uniquePositions;
+    for (size_t v = 0; v < vertexCount; v++) {
+        auto inserted = uniquePositions.emplace(vertices[v].pos, static_cast<uint32_t>(positionUses.size()));
+        if (inserted.second) {
+            positionUses.push_back(0);
+        }
+        positionId[v] = inserted.first->second;
+        positionUses[positionId[v]]++;
+    }
+
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            uint32_t a = positionId[result[i + corner]];
+            uint32_t b = positionId[result[i + (corner + 1) % 3]];
+            edgeUses[edgeKey(a, b)]++;
+        }
+    }
+
+    std::vector<bool> lockedPosition(positionUses.size(), false);
+    for (size_t p = 0; p < positionUses.size(); p++) {
+        lockedPosition[p] = positionUses[p] > 1;
+    }
+    for (const auto& edge : edgeUses) {
+        if (edge.second == 1) {
+            lockedPosition[edge.first >> 32] = true;
+            lockedPosition[edge.first & 0xffffffffu] = true;
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        Quadric quadric = planeQuadric(vertices[result[i]].pos, vertices[result[i + 1]].pos, vertices[result[i + 2]].pos);
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            addQuadric(quadrics[result[i + corner]], quadric);
+        }
+    }
+
+    const double maxCost = static_cast<double>(maxError) * maxError;
+    double largestCost = 0.0;
+    std::vector<uint32_t> adjacencyOffsets;
+    std::vector<uint32_t> adjacency;
+    std::vector<CollapseCandidate> candidates;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+
+    while (result.size() > targetIndexCount) {
+        buildAdjacency(result, vertexCount, adjacencyOffsets, adjacency);
+
+        // Each edge collapses into whichever endpoint yields the smaller error; vertices stay in
+        // place so the cost is the merged quadric evaluated at the surviving vertex
+        candidates.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                uint32_t a = result[i + corner];
+                uint32_t b = result[i + (corner + 1) % 3];
+                if (a > b) {
+                    continue;
+                }
+
+                CollapseCandidate best{a, b, std::numeric_limits<double>::max()};
+                for (int direction = 0; direction < 2; direction++) {
+                    uint32_t from = direction == 0 ? a : b;
+                    uint32_t to = direction == 0 ? b : a;
+                    if (lockedPosition[positionId[from]]) {
+                        continue;
+                    }
+                    Quadric merged = quadrics[from];
+                    addQuadric(merged, quadrics[to]);
+                    double cost = evaluateQuadric(merged, vertices[to].pos);
+                    if (cost < best.cost) {
+                        best = {from, to, cost};
+                    }
+                }
+                if (best.cost <= maxCost) {
+                    candidates.push_back(best);
+                }
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const CollapseCandidate& lhs, const CollapseCandidate& rhs) {
+            return lhs.cost < rhs.cost;
+        });
+
+        // A collapse removes about two triangles. Collapses within one pass must not share triangles,
+        // otherwise the flip test would run against stale connectivity.
+        const size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t collapses = 0;
+        for (size_t v = 0; v < vertexCount; v++) {
+            remap[v] = static_cast<uint32_t>(v);
+        }
+        std::fill(touched.begin(), touched.end(), false);
+
+        for (const CollapseCandidate& candidate : candidates) {
+            if (touched[candidate.from] || touched[candidate.to]) {
+                continue;
+            }
+            if (collapseFlipsTriangle(result, adjacencyOffsets, adjacency, vertices, candidate.from, candidate.to)) {
+                continue;
+            }
+
+            remap[candidate.from] = candidate.to;
+            addQuadric(quadrics[candidate.to], quadrics[candidate.from]);
+            for (uint32_t a = adjacencyOffsets[candidate.from]; a < adjacencyOffsets[candidate.from + 1]; a++) {
+                uint32_t t = adjacency[a];
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    touched[result[t * 3 + corner]] = true;
+                }
+            }
+            largestCost = std::max(largestCost, candidate.cost);
+
+            collapses++;
+            if (collapses * 2 >= trianglesToRemove) {
+                break;
+            }
+        }
+
+        if (collapses == 0) {
+            break;
+        }
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]];
+            uint32_t b = remap[result[i + 1]];
+            uint32_t c = remap[result[i + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            result[writeIndex++] = a;
+            result[writeIndex++] = b;
+            result[writeIndex++] = c;
+        }
+        result.resize(writeIndex);
+    }
+
+    resultError = static_cast<float>(std::sqrt(largestCost));
+    return result;
+}
+
+uint32_t MeshSimplifier::selectLod(const std::vector<MeshLod>& lods, float distance, float objectScale,
+                                   float projectionScale, float viewportHeight, float pixelThreshold) {
+    // World space error e at distance d covers e * projectionScale / d of the half viewport height
+    const float pixelsPerUnit = std::abs(projectionScale) * viewportHeight * 0.5f / std::max(distance, 1e-4f);
+
+    uint32_t selected = 0;
+    for (uint32_t i = 1; i < lods.size(); i++) {
+        if (lods[i].error * objectScale * pixelsPerUnit > pixelThreshold) {
+            break;
+        }
+        selected = i;
+    }
+    return selected;
+}
+
+MeshSimplifier::Quadric MeshSimplifier::planeQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+    Quadric quadric;
+    glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+    float length = glm::length(normal);
+    if (length <= 0.0f) {
+        return quadric;
+    }
+    normal /= length;
+
+    // Area weighted so large triangles dominate the error of the surrounding vertices
+    double weight = length * 0.5;
+    double a = normal.x, b = normal.y, c = normal.z;
+    double d = -glm::dot(normal, p0);
+    quadric.a2 = a * a * weight;
+    quadric.b2 = b * b * weight;
+    quadric.c2 = c * c * weight;
+    quadric.d2 = d * d * weight;
+    quadric.ab = a * b * weight;
+    quadric.ac = a * c * weight;
+    quadric.ad = a * d * weight;
+    quadric.bc = b * c * weight;
+    quadric.bd = b * d * weight;
+    quadric.cd = c * d * weight;
+    quadric.weight = weight;
+    return quadric;
+}
+
+void MeshSimplifier::addQuadric(Quadric& target, const Quadric& source) {
+    target.a2 += source.a2;
+    target.b2 += source.b2;
+    target.c2 += source.c2;
+    target.d2 += source.d2;
+    target.ab += source.ab;
+    target.ac += source.ac;
+    target.ad += source.ad;
+    target.bc += source.bc;
+    target.bd += source.bd;
+    target.cd += source.cd;
+    target.weight += source.weight;
+}
+
+double MeshSimplifier::evaluateQuadric(const Quadric& quadric, const glm::vec3& point) {
+    if (quadric.weight <= 0.0) {
+        return 0.0;
+    }
+    double x = point.x, y = point.y, z = point.z;
+    double value = quadric.a2 * x * x + quadric.b2 * y * y + quadric.c2 * z * z + quadric.d2
+                 + 2.0 * (quadric.ab * x * y + quadric.ac * x * z + quadric.ad * x
+                        + quadric.bc * y * z + quadric.bd * y + quadric.cd * z);
+    return std::max(value, 0.0) / quadric.weight;
+}
+
+bool MeshSimplifier::collapseFlipsTriangle(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& adjacencyOffsets,
+                                           const std::vector<uint32_t>& adjacency, const std::vector<StandardVertex>& vertices,
+                                           uint32_t from, uint32_t to) {
+    for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; a++) {
+        const uint32_t* triangle = &indices[adjacency[a] * 3];
+        if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+            continue; // becomes degenerate and is removed
+        }
+
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            before[corner] = vertices[triangle[corner]].pos;
+            after[corner] = triangle[corner] == from ? vertices[to].pos : before[corner];
+        }
+
+        glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normalBefore, normalAfter) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "../common/VertexTypes.h"
+
+// One level of detail over the shared vertex buffer: a range of the mesh index buffer and,
+// when meshlets were built, the matching range of clusters
+struct MeshLod {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
+    // Object space geometric error relative to LOD 0, never decreases along the chain
+    float error = 0.0f;
+};
+
+// Quadric error metric edge collapse simplification. Vertices are never moved or created,
+// every LOD indexes the original vertex buffer.
+class MeshSimplifier {
+    public:
+        // Collapses edges until the index count reaches targetIndexCount or the next collapse would
+        // exceed maxError (object space distance). resultError receives the largest error introduced.
+        static std::vector<uint32_t> simplify(const std::vector<uint32_t>& indices, const std::vector<StandardVertex>& vertices,
+                                              size_t targetIndexCount, float maxError, float& resultError);
+
+        // Coarsest LOD whose error, projected at the given distance, stays below pixelThreshold.
+        // projectionScale is proj[1][1], i.e. cot(fovy / 2).
+        static uint32_t selectLod(const std::vector<MeshLod>& lods, float distance, float objectScale,
+                                  float projectionScale, float viewportHeight, float pixelThreshold);
+
+    private:
+        struct Quadric {
+            double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+            double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+            double weight = 0;
+        };
+
+        static Quadric planeQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2);
+        static void addQuadric(Quadric& target, const Quadric& source);
+        // Mean squared distance of the point to the planes accumulated in the quadric
+        static double evaluateQuadric(const Quadric& quadric, const glm::vec3& point);
+        static bool collapseFlipsTriangle(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& adjacencyOffsets,
+                                          const std::vector<uint32_t>& adjacency, const std::vector<StandardVertex>& vertices,
+                                          uint32_t from, uint32_t to);
+};
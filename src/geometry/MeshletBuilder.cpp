@@ -0,0 +1,188 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+MeshletData MeshletBuilder::build(const std::vector<uint32_t>& indices, const std::vector<StandardVertex>& vertices) {
+    MeshletData result;
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+    if (triangleCount == 0) {
+        return result;
+    }
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t index : indices) {
+        adjacencyOffsets[index + 1]++;
+    }
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (uint32_t t = 0; t < triangleCount; t++) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            adjacency[fill[indices[t * 3 + corner]]++] = t;
+        }
+    }
+
+    const uint32_t noMeshlet = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> vertexMeshlet(vertexCount, noMeshlet);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> meshletVertices;
+    uint32_t meshletTriangles = 0;
+    uint32_t meshletFirstIndex = 0;
+    uint32_t seed = 0;
+
+    result.indices.reserve(indices.size());
+
+    auto flush = [&]() {
+        if (meshletTriangles == 0) {
+            return;
+        }
+        uint32_t indexCount = meshletTriangles * 3;
+        Meshlet meshlet = computeBounds(result.indices.data() + meshletFirstIndex, indexCount, vertices);
+        meshlet.firstIndex = meshletFirstIndex;
+        meshlet.indexCount = indexCount;
+        meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+        result.meshlets.push_back(meshlet);
+
+        meshletFirstIndex += indexCount;
+        meshletTriangles = 0;
+        meshletVertices.clear();
+    };
+
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        const uint32_t currentMeshlet = static_cast<uint32_t>(result.meshlets.size());
+        auto newVertexCount = [&](uint32_t t) {
+            uint32_t count = 0;
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                count += vertexMeshlet[indices[t * 3 + corner]] != currentMeshlet;
+            }
+            return count;
+        };
+
+        // Grow the current cluster through the triangle that adds the fewest new vertices
+        uint32_t best = noMeshlet;
+        uint32_t bestScore = 4;
+        for (uint32_t v : meshletVertices) {
+            for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1] && bestScore > 0; a++) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) {
+                    continue;
+                }
+                uint32_t score = newVertexCount(t);
+                if (score < bestScore) {
+                    best = t;
+                    bestScore = score;
+                }
+            }
+            if (bestScore == 0) {
+                break;
+            }
+        }
+
+        if (best == noMeshlet) {
+            while (emitted[seed]) {
+                seed++;
+            }
+            best = seed;
+            bestScore = newVertexCount(best);
+        }
+
+        // The triangle starts the next cluster, which keeps neighbouring clusters spatially coherent
+        if (meshletVertices.size() + bestScore > MAX_VERTICES || meshletTriangles + 1 > MAX_TRIANGLES) {
+            flush();
+        }
+
+        // Vertices are tagged with the id of the cluster they belong to
+        const uint32_t meshletId = static_cast<uint32_t>(result.meshlets.size());
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            uint32_t v = indices[best * 3 + corner];
+            if (vertexMeshlet[v] != meshletId) {
+                vertexMeshlet[v] = meshletId;
+                meshletVertices.push_back(v);
+            }
+            result.indices.push_back(v);
+        }
+        emitted[best] = true;
+        meshletTriangles++;
+    }
+    flush();
+
+    return result;
+}
+
+Meshlet MeshletBuilder::computeBounds(const uint32_t* indices, uint32_t indexCount, const std::vector<StandardVertex>& vertices) {
+    Meshlet meshlet{};
+
+    glm::vec3 boundsMin = vertices[indices[0]].pos;
+    glm::vec3 boundsMax = boundsMin;
+    for (uint32_t i = 0; i < indexCount; i++) {
+        boundsMin = glm::min(boundsMin, vertices[indices[i]].pos);
+        boundsMax = glm::max(boundsMax, vertices[indices[i]].pos);
+    }
+
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t i = 0; i < indexCount; i++) {
+        radius = std::max(radius, glm::length(vertices[indices[i]].pos - center));
+    }
+    meshlet.boundingSphere = glm::vec4(center, radius);
+
+    // Normal cone: average of the triangle normals, widened to the least aligned one.
+    // Degenerate triangles keep a zero normal and are ignored.
+    std::vector<glm::vec3> normals(indexCount / 3, glm::vec3(0.0f));
+    glm::vec3 axis(0.0f);
+    bool hasNormals = false;
+    for (uint32_t t = 0; t < indexCount / 3; t++) {
+        const glm::vec3& p0 = vertices[indices[t * 3 + 0]].pos;
+        const glm::vec3& p1 = vertices[indices[t * 3 + 1]].pos;
+        const glm::vec3& p2 = vertices[indices[t * 3 + 2]].pos;
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float area = glm::length(normal);
+        if (area <= 0.0f) {
+            continue;
+        }
+        normals[t] = normal / area;
+        axis += normals[t];
+        hasNormals = true;
+    }
+
+    meshlet.coneAxisCutoff = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    meshlet.coneApex = glm::vec4(center, 0.0f);
+    float axisLength = glm::length(axis);
+    if (!hasNormals || axisLength <= 0.0f) {
+        return meshlet;
+    }
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals) {
+        if (normal != glm::vec3(0.0f)) {
+            minDot = std::min(minDot, glm::dot(normal, axis));
+        }
+    }
+
+    // Cones wider than ~84 degrees half-angle cull almost nothing, leave them disabled
+    if (minDot <= 0.1f) {
+        return meshlet;
+    }
+
+    // Move the apex back along the axis until it lies behind every triangle plane, which makes
+    // "view direction from the apex inside the cone" a conservative backface test
+    float maxT = 0.0f;
+    for (uint32_t t = 0; t < indexCount / 3; t++) {
+        if (normals[t] == glm::vec3(0.0f)) {
+            continue;
+        }
+        const glm::vec3& p0 = vertices[indices[t * 3]].pos;
+        maxT = std::max(maxT, glm::dot(center - p0, normals[t]) / glm::dot(axis, normals[t]));
+    }
+
+    meshlet.coneApex = glm::vec4(center - axis * maxT, 0.0f);
+    meshlet.coneAxisCutoff = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+    return meshlet;
+}
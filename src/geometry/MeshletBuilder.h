@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "../common/VertexTypes.h"
+
+// GPU visible cluster description, mirrors the Meshlet struct in shaders/cluster_cull.comp (std430)
+struct Meshlet {
+    glm::vec4 boundingSphere;   // xyz center, w radius (object space)
+    glm::vec4 coneApex;         // xyz apex of the backface cone, w unused
+    glm::vec4 coneAxisCutoff;   // xyz cone axis, w cutoff (1.0 disables cone culling)
+    uint32_t firstIndex;        // into MeshletData::indices, rebased by the owner of the index buffer
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    int32_t vertexOffset;       // base vertex added to every index of the meshlet
+};
+
+static_assert(sizeof(Meshlet) == 64, "Meshlet layout must match cluster_cull.comp");
+
+struct MeshletData {
+    std::vector<Meshlet> meshlets;
+    // Triangles reordered so each meshlet is a contiguous range, still indexing the original vertices
+    std::vector<uint32_t> indices;
+};
+
+class MeshletBuilder {
+    public:
+        static constexpr uint32_t MAX_VERTICES = 64;
+        static constexpr uint32_t MAX_TRIANGLES = 124;
+
+        static MeshletData build(const std::vector<uint32_t>& indices, const std::vector<StandardVertex>& vertices);
+
+    private:
+        static Meshlet computeBounds(const uint32_t* indices, uint32_t indexCount, const std::vector<StandardVertex>& vertices);
+};
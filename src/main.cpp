@@ -1,6 +1,3 @@
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
@@ -16,40 +13,48 @@
 #include <stdexcept>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include <vector>
 #include <cstdint>
 #include <array>
 #include <unordered_map>
+#include <memory>
+#include <algorithm>
 
 #include "common/VertexTypes.h"
+#include "common/UniformTypes.h"
 #include "core/VulkanApplication.h"
+#include "core/FrameLimiter.h"
+#include "core/LatencyMonitor.h"
 #include "rendering/VulkanGraphicsPipeline.h"
 #include "rendering/CommandManager.h"
+#include "rendering/ClusterCuller.h"
+#include "rendering/PipelineManager.h"
+#include "rendering/RenderGraph.h"
+#include "rendering/GpuTimer.h"
+#include "rendering/DynamicResolution.h"
+#include "rendering/FrameCapture.h"
 #include "resources/BufferManager.h"
 #include "resources/TextureManager.h"
+#include "resources/ModelLoader.h"
+#include "resources/GeometryPool.h"
 #include "descriptors/DescriptorManager.h"
+#include "scene/Scene.h"
 #include "ui/GuiManager.h"
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
-const int MAX_FRAMES_IN_FLIGHT = 2;
 const std::string MODEL_PATH = "../assets/models/viking_room.obj";
 const std::string TEXTURE_PATH = "../assets/textures/viking_room.png";
-struct UniformBufferObject {
-    glm::mat4 model;
-    glm::mat4 view;
-    glm::mat4 proj;
-};
+const uint32_t GEOMETRY_POOL_VERTICES = 1u << 20;
+const uint32_t GEOMETRY_POOL_INDICES = 1u << 22;
 
 class MyVulkanApp : public VulkanApplication {
 
 private:
-    std::vector<StandardVertex> vertices_;
-    std::vector<uint32_t> indices_;
-    VkBuffer vertexBuffer_;
-    VkDeviceMemory vertexBufferMemory_;
-    VkBuffer indexBuffer_;
-    VkDeviceMemory indexBufferMemory_;
+    MeshData mesh_;
+    std::unique_ptr<GeometryPool> geometryPool_;
+    MeshAllocation meshAllocation_;
     std::vector<VkBuffer> uniformBuffers_;
     std::vector<VkDeviceMemory> uniformBuffersMemory_;
     std::vector<void*> uniformBuffersMapped_;
@@ -58,29 +63,89 @@ private:
     VkDeviceMemory textureImageMemory_;
     VkImageView textureImageView_;
     VkSampler textureSampler_;
-    VkImage depthImage_;
-    VkDeviceMemory depthImageMemory_;
-    VkImageView depthImageView_;
-    std::vector<VkFramebuffer> swapChainFramebuffers_;
+    std::unique_ptr<ClusterCuller> clusterCuller_;
+    // Owns the depth buffer and framebuffers, rebuilt with the swapchain
+    std::unique_ptr<RenderGraph> renderGraph_;
+    std::unique_ptr<GpuTimer> gpuTimer_;
+    DynamicResolution dynamicResolution_;
+    // Swapchain image of the frame being recorded, for passes that address it directly
+    uint32_t imageIndex_ = 0;
+    // Part of the swapchain extent the scene is drawn into this frame
+    VkExtent2D renderExtent_{};
+    double gpuFrameMs_ = 0.0;
+    // Draws and triangles recorded this frame, for the performance panel. Indirect draws count the
+    // clusters the culling pass kept a few frames ago.
+    uint32_t drawCount_ = 0;
+    uint64_t triangleCount_ = 0;
+    Metrics::SeriesId gpuFrameSeries_ = 0;
+    Metrics::SeriesId drawSeries_ = 0;
+    Metrics::SeriesId triangleSeries_ = 0;
+    // By render graph pass index, resolved whenever the graph is rebuilt
+    std::vector<Metrics::SeriesId> passSeries_;
+
+    // Nodes drawn with the loaded mesh; for now just the one the GUI edits
+    Scene scene_;
+    Scene::NodeId modelNode_ = 0;
+
+    // Matrices of the current frame, kept for the culling pass. model_ is the model node's world
+    // matrix, pushed per draw.
+    glm::mat4 model_{1.0f};
+    glm::mat4 view_{1.0f};
+    glm::mat4 proj_{1.0f};
+    glm::vec3 cameraPosition_{2.0f, 2.0f, 2.0f};
 
     ImVec4 clear_color = ImVec4(1.0f, 1.0f, 1.0f, 1.00f);
     
-    // Transformation control variables
+    // Local transform of the model node as edited in the GUI, applied to the scene when it changes
     glm::vec3 modelPosition = glm::vec3(0.0f, 0.0f, 0.0f);
     glm::vec3 modelRotation = glm::vec3(0.0f, 0.0f, 0.0f); // Euler angles in degrees
     glm::vec3 modelScale = glm::vec3(1.0f, 1.0f, 1.0f);
     bool show_transform_window = true;
+    bool enableClusterCulling = true;
+    bool enableConeCulling = true;
+    bool automaticLod = true;
+    float lodPixelError = 1.0f;
+    int forcedLod = 0;
+    uint32_t currentLod_ = 0;
+    // Material state, drawn with a pipeline variant from the PipelineManager
+    bool materialAlphaBlend = false;
+    bool materialDoubleSided = false;
+    bool materialWireframe = false;
+    // Depth prepass: positions only, then the main pass shades with an EQUAL test and no depth writes
+    bool enableDepthPrepass = false;
+    bool depthPrepassBuilt_ = false;
+    // Pipelines of the frame being recorded, see selectFramePipelines
+    VkPipeline depthPipeline_ = VK_NULL_HANDLE;
+    VkPipeline mainPipeline_ = VK_NULL_HANDLE;
+    // Scene rendered at a GPU time driven fraction of the output resolution, then upscaled
+    bool enableDynamicResolution = true;
+    bool dynamicResolutionBuilt_ = false;
+    // Presentation settings as shown in the GUI, applied through the VulkanApplication setters
+    int swapchainImageCount = 0;
+    int framesInFlight = 2;
+    float frameRateLimit = 0.0f;
+    // Frame capture to disk, started and stopped from the GUI like the prepass toggle
+    std::unique_ptr<FrameCapture> frameCapture_;
+    int captureFormat = 0;
+    bool enableCapture = false;
+    bool captureBuilt_ = false;
 
 public:
-    MyVulkanApp() : VulkanApplication({
+    // Assets load from loose files unless assetPackPath names a pack built by vulkan_packer
+    explicit MyVulkanApp(const std::string& assetPackPath) : VulkanApplication({
         .windowWidth = 1280,
         .windowHeight = 800,
         .windowTitle = "Vulkan Boilerplate with ImGui",
-        .maxFramesInFlight = 2,
+        .maxFramesInFlight = 3,
+        .framesInFlight = 2,
         .enableValidation = true,
         .enableGui = true,
         .fontPath = "../assets/fonts/Roboto-Regular.ttf",
-        .fontSize = 16.0f
+        .fontSize = 16.0f,
+        .cacheStaticGuiFrames = true,
+        .enableShaderHotReload = true,
+        .msaaSamples = VK_SAMPLE_COUNT_4_BIT,
+        .assetPackPath = assetPackPath
     }) {}
 
 protected:
@@ -92,26 +157,27 @@ protected:
             ImGui::Separator();
             
             // Position controls
+            bool transformChanged = false;
             ImGui::Text("Position:");
-            ImGui::SliderFloat("X Position", &modelPosition.x, -5.0f, 5.0f, "%.2f");
-            ImGui::SliderFloat("Y Position", &modelPosition.y, -5.0f, 5.0f, "%.2f");
-            ImGui::SliderFloat("Z Position", &modelPosition.z, -5.0f, 5.0f, "%.2f");
+            transformChanged |= ImGui::SliderFloat("X Position", &modelPosition.x, -5.0f, 5.0f, "%.2f");
+            transformChanged |= ImGui::SliderFloat("Y Position", &modelPosition.y, -5.0f, 5.0f, "%.2f");
+            transformChanged |= ImGui::SliderFloat("Z Position", &modelPosition.z, -5.0f, 5.0f, "%.2f");
             
             ImGui::Separator();
             
             // Rotation controls (in degrees)
             ImGui::Text("Rotation (degrees):");
-            ImGui::SliderFloat("X Rotation", &modelRotation.x, -180.0f, 180.0f, "%.1f°");
-            ImGui::SliderFloat("Y Rotation", &modelRotation.y, -180.0f, 180.0f, "%.1f°");
-            ImGui::SliderFloat("Z Rotation", &modelRotation.z, -180.0f, 180.0f, "%.1f°");
+            transformChanged |= ImGui::SliderFloat("X Rotation", &modelRotation.x, -180.0f, 180.0f, "%.1f°");
+            transformChanged |= ImGui::SliderFloat("Y Rotation", &modelRotation.y, -180.0f, 180.0f, "%.1f°");
+            transformChanged |= ImGui::SliderFloat("Z Rotation", &modelRotation.z, -180.0f, 180.0f, "%.1f°");
             
             ImGui::Separator();
             
             // Scale controls
             ImGui::Text("Scale:");
-            ImGui::SliderFloat("X Scale", &modelScale.x, 0.1f, 3.0f, "%.2f");
-            ImGui::SliderFloat("Y Scale", &modelScale.y, 0.1f, 3.0f, "%.2f");
-            ImGui::SliderFloat("Z Scale", &modelScale.z, 0.1f, 3.0f, "%.2f");
+            transformChanged |= ImGui::SliderFloat("X Scale", &modelScale.x, 0.1f, 3.0f, "%.2f");
+            transformChanged |= ImGui::SliderFloat("Y Scale", &modelScale.y, 0.1f, 3.0f, "%.2f");
+            transformChanged |= ImGui::SliderFloat("Z Scale", &modelScale.z, 0.1f, 3.0f, "%.2f");
             
             // Uniform scale option
             static bool uniform_scale = false;
@@ -120,6 +186,7 @@ protected:
                 static float uniform_scale_value = 1.0f;
                 if (ImGui::SliderFloat("Scale Value", &uniform_scale_value, 0.1f, 3.0f, "%.2f")) {
                     modelScale = glm::vec3(uniform_scale_value);
+                    transformChanged = true;
                 }
             }
             
@@ -130,6 +197,156 @@ protected:
                 modelPosition = glm::vec3(0.0f, 0.0f, 0.0f);
                 modelRotation = glm::vec3(0.0f, 0.0f, 0.0f);
                 modelScale = glm::vec3(1.0f, 1.0f, 1.0f);
+                transformChanged = true;
+            }
+            if (transformChanged) {
+                applyModelTransform();
+            }
+
+            ImGui::Separator();
+
+            // Level of detail controls
+            ImGui::Text("Level of Detail:");
+            ImGui::Checkbox("Automatic LOD", &automaticLod);
+            if (automaticLod) {
+                ImGui::SliderFloat("Max Error (px)", &lodPixelError, 0.25f, 16.0f, "%.2f");
+            } else {
+                ImGui::SliderInt("LOD", &forcedLod, 0, static_cast<int>(mesh_.lods.size()) - 1);
+            }
+            ImGui::Text("LOD %u / %zu - %u triangles", currentLod_, mesh_.lods.size() - 1, mesh_.lods[currentLod_].indexCount / 3);
+
+            ImGui::Separator();
+
+            // Material state controls
+            ImGui::Text("Material:");
+            ImGui::Checkbox("Alpha Blend", &materialAlphaBlend);
+            ImGui::Checkbox("Double Sided", &materialDoubleSided);
+            if (vulkanDevice_->getEnabledFeatures().fillModeNonSolid) {
+                ImGui::Checkbox("Wireframe", &materialWireframe);
+            }
+            ImGui::Text("Pipeline variants: %zu", pipelineManager_->getPipelineCount());
+            ImGui::Checkbox("Depth Prepass", &enableDepthPrepass);
+            if (enableDepthPrepass && materialAlphaBlend) {
+                ImGui::Text("Depth prepass skipped for blended materials");
+            }
+
+            ImGui::Separator();
+
+            // Cluster culling controls
+            if (clusterCuller_) {
+                ImGui::Text("Cluster Culling:");
+                ImGui::Checkbox("GPU Cluster Culling", &enableClusterCulling);
+                ImGui::Checkbox("Backface Cone Culling", &enableConeCulling);
+                if (enableClusterCulling) {
+                    ImGui::Text("Visible clusters: %u / %u", clusterCuller_->getVisibleCount(currentFrame_), mesh_.lods[currentLod_].meshletCount);
+                }
+            } else {
+                ImGui::Text("Cluster culling unavailable (no drawIndirectCount)");
+            }
+
+            ImGui::Separator();
+
+            ImGui::Text("Render graph: %u passes, %u culled", renderGraph_->getPassCount(), renderGraph_->getCulledPassCount());
+            ImGui::Text("Transient memory: %.1f MiB (%.1f MiB unaliased)",
+                        renderGraph_->getTransientBytesAllocated() / (1024.0f * 1024.0f),
+                        renderGraph_->getTransientBytesRequested() / (1024.0f * 1024.0f));
+            ImGui::Text("MSAA: %ux, %.1f MiB lazily allocated", static_cast<uint32_t>(msaaSamples_),
+                        renderGraph_->getLazilyAllocatedBytes() / (1024.0f * 1024.0f));
+
+            ImGui::Separator();
+
+            // Dynamic resolution controls
+            if (supportsDynamicResolution()) {
+                ImGui::Text("Dynamic Resolution:");
+                ImGui::Checkbox("Dynamic Resolution", &enableDynamicResolution);
+                if (enableDynamicResolution) {
+                    DynamicResolution::Config resolutionConfig = dynamicResolution_.getConfig();
+                    bool changed = ImGui::SliderFloat("Target GPU ms", &resolutionConfig.targetFrameMs, 2.0f, 50.0f, "%.1f");
+                    changed |= ImGui::SliderFloat("Min Scale", &resolutionConfig.minScale, 0.25f, 1.0f, "%.2f");
+                    resolutionConfig.maxScale = std::max(resolutionConfig.maxScale, resolutionConfig.minScale);
+                    if (changed) {
+                        dynamicResolution_.setConfig(resolutionConfig);
+                    }
+                    ImGui::Text("Scene %ux%u (%.0f%%), GPU %.2f ms", renderExtent_.width, renderExtent_.height,
+                                dynamicResolution_.getScale() * 100.0f, dynamicResolution_.getSmoothedFrameTime());
+                }
+            } else {
+                ImGui::Text("Dynamic resolution unavailable (no GPU timestamps or swapchain blits)");
+            }
+            if (gpuTimer_->isSupported()) {
+                ImGui::Text("GPU frame: %.2f ms", gpuFrameMs_);
+            }
+
+            ImGui::Separator();
+
+            // Presentation and latency controls
+            ImGui::Text("Presentation:");
+            if (ImGui::BeginCombo("Present Mode", presentModeName(vulkanSwapchain_->getPresentMode()))) {
+                for (VkPresentModeKHR mode : vulkanSwapchain_->getSupportedPresentModes()) {
+                    if (presentModeName(mode) == nullptr) {
+                        continue;
+                    }
+                    bool selected = mode == vulkanSwapchain_->getPresentMode();
+                    if (ImGui::Selectable(presentModeName(mode), selected) && !selected) {
+                        setPresentMode(mode);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            // Applied on release, every change recreates the swapchain
+            int maxImageCount = vulkanSwapchain_->getMaxImageCount() > 0 ? static_cast<int>(vulkanSwapchain_->getMaxImageCount()) : 8;
+            ImGui::SliderInt("Swapchain Images", &swapchainImageCount, static_cast<int>(vulkanSwapchain_->getMinImageCount()), maxImageCount);
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                setSwapchainImageCount(static_cast<uint32_t>(swapchainImageCount));
+            }
+            if (ImGui::SliderInt("Frames In Flight", &framesInFlight, 1, static_cast<int>(config_.maxFramesInFlight))) {
+                setFramesInFlight(static_cast<uint32_t>(framesInFlight));
+            }
+            if (ImGui::SliderFloat("Frame Limit (0 = off)", &frameRateLimit, 0.0f, 240.0f, "%.0f fps")) {
+                setFrameRateLimit(frameRateLimit);
+            }
+            ImGui::Text("CPU frame: %.2f ms", frameLimiter_->getCpuFrameTime());
+            if (latencyMonitor_->isSupported()) {
+                ImGui::Text("Input to photon: %.1f ms (last %.1f ms)", latencyMonitor_->getAverageLatency(),
+                            latencyMonitor_->getLastLatency());
+            } else {
+                ImGui::Text("Input to photon latency unavailable (no VK_KHR_present_wait)");
+            }
+            bool cacheStaticGui = guiManager_->getCacheStaticFrames();
+            if (ImGui::Checkbox("Reuse Static GUI Frames", &cacheStaticGui)) {
+                guiManager_->setCacheStaticFrames(cacheStaticGui);
+            }
+            uint64_t guiFrames = guiManager_->getBuiltFrameCount() + guiManager_->getReusedFrameCount();
+            ImGui::Text("GUI frames reused: %.0f%%",
+                        guiFrames > 0 ? 100.0 * guiManager_->getReusedFrameCount() / guiFrames : 0.0);
+
+            ImGui::Separator();
+
+            // Frame capture controls, the GUI itself is not captured
+            if (supportsCapture()) {
+                ImGui::Text("Frame Capture:");
+                if (frameCapture_) {
+                    FrameCapture::Stats stats = frameCapture_->getStats();
+                    ImGui::Text("%llu captured, %llu written, %llu skipped",
+                                static_cast<unsigned long long>(stats.capturedFrames),
+                                static_cast<unsigned long long>(stats.writtenFrames),
+                                static_cast<unsigned long long>(stats.skippedFrames));
+                    ImGui::Text("Waited for encoders: %.1f ms", stats.blockedMilliseconds);
+                    std::string captureError = frameCapture_->getError();
+                    if (!captureError.empty()) {
+                        ImGui::Text("Capture failed: %s", captureError.c_str());
+                    }
+                    if (ImGui::Button("Stop Capture")) {
+                        enableCapture = false;
+                    }
+                } else {
+                    ImGui::Combo("Capture Format", &captureFormat, "PNG Sequence\0Raw RGBA\0Y4M Video\0");
+                    if (ImGui::Button("Start Capture")) {
+                        enableCapture = true;
+                    }
+                }
+            } else {
+                ImGui::Text("Frame capture unavailable (swapchain images cannot be copied)");
             }
             
             ImGui::End();
@@ -137,15 +354,56 @@ protected:
     }
 
     void initializeResources() override {
-        textureManager_->createDepthResources(vulkanSwapchain_->getExtent(), depthImage_, depthImageMemory_, depthImageView_);
-        createFramebuffers();
-        textureManager_->createTextureFromFile(TEXTURE_PATH, textureImage_, textureImageMemory_, textureImageView_);
+        // Scenes with more textures list them all here so their reads overlap
+        std::vector<TextureManager::Texture> textures;
+        textureManager_->createTexturesFromFiles({TEXTURE_PATH}, textures);
+        textureImage_ = textures[0].image;
+        textureImageMemory_ = textures[0].memory;
+        textureImageView_ = textures[0].view;
         textureSampler_ = textureManager_->createTextureSampler();
 
-        loadModel();
+        ModelLoader::Options modelOptions;
+        modelOptions.assetPack = assetPack_.get();
+        modelOptions.fileReader = fileReader_.get();
+        mesh_ = ModelLoader::loadObj(MODEL_PATH, modelOptions);
+        vulkanPipeline_->setVertexFormat(mesh_.format);
+        // The only mesh and material; more nodes can share them or be parented to this one
+        modelNode_ = scene_.createNode();
+        scene_.setMesh(modelNode_, 0, 0);
+        applyModelTransform();
+
+        // Standard vertices are 32 bytes, so the depth prepass reads a separate position stream.
+        // Compact vertices are small enough to be read as they are.
+        bool positionStream = mesh_.format == VertexFormat::Standard;
+        std::vector<BasicVertex> positions;
+        if (positionStream) {
+            positions.reserve(mesh_.vertices.size());
+            for (const StandardVertex& vertex : mesh_.vertices) {
+                positions.push_back({vertex.pos});
+            }
+        }
+
+        geometryPool_ = std::make_unique<GeometryPool>();
+        geometryPool_->initialize(*vulkanDevice_, *bufferManager_, mesh_.vertexStride(),
+                                  std::max(GEOMETRY_POOL_VERTICES, static_cast<uint32_t>(mesh_.vertexCount())),
+                                  std::max(GEOMETRY_POOL_INDICES, static_cast<uint32_t>(mesh_.indices.size())),
+                                  positionStream);
+        meshAllocation_ = geometryPool_->allocate(mesh_.vertexData(), static_cast<uint32_t>(mesh_.vertexCount()), mesh_.indices,
+                                                  positionStream ? positions.data() : nullptr);
+
+        if (vulkanDevice_->isIndirectCountEnabled() && !mesh_.meshlets.empty()) {
+            // Meshlets address the pool directly
+            std::vector<Meshlet> meshlets = mesh_.meshlets;
+            for (Meshlet& meshlet : meshlets) {
+                meshlet.firstIndex += meshAllocation_.firstIndex;
+                meshlet.vertexOffset = meshAllocation_.vertexOffset;
+            }
+
+            clusterCuller_ = std::make_unique<ClusterCuller>();
+            clusterCuller_->initialize(*vulkanDevice_, *bufferManager_, *layoutCache_, config_.maxFramesInFlight);
+            clusterCuller_->setMeshlets(meshlets);
+        }
 
-        bufferManager_->createVertexBuffer(vertices_, vertexBuffer_, vertexBufferMemory_);
-        bufferManager_->createIndexBuffer(indices_, indexBuffer_, indexBufferMemory_);
         bufferManager_->createUniformBuffer(config_.maxFramesInFlight, uniformBuffers_, uniformBuffersMemory_, uniformBuffersMapped_);
 
         descriptorManager_->createDescriptorPool(config_.maxFramesInFlight);
@@ -155,51 +413,98 @@ protected:
                                                     textureImageView_, 
                                                     textureSampler_, 
                                                     descriptorSets_);
+
+        swapchainImageCount = static_cast<int>(vulkanSwapchain_->getImages().size());
+        framesInFlight = static_cast<int>(getFramesInFlight());
+        frameRateLimit = static_cast<float>(config_.frameRateLimit);
+
+        gpuTimer_ = std::make_unique<GpuTimer>();
+        gpuTimer_->initialize(*vulkanDevice_, config_.maxFramesInFlight);
+
+        renderGraph_ = std::make_unique<RenderGraph>();
+        renderGraph_->initialize(*vulkanDevice_);
+        buildRenderGraph();
+
+        gpuFrameSeries_ = metrics_->addSeries("GPU frame time", Metrics::Category::Frame);
+        drawSeries_ = metrics_->addSeries("draw calls", Metrics::Category::Counter);
+        triangleSeries_ = metrics_->addSeries("triangles", Metrics::Category::Counter);
+    }
+
+    void onSwapchainRecreated() override {
+        swapchainImageCount = static_cast<int>(vulkanSwapchain_->getImages().size());
+        buildRenderGraph();
+    }
+
+    // Toggling the prepass, dynamic resolution or capture changes the passes, so the graph is rebuilt
+    // between frames rather than branching inside it; the frames in flight still reference the old
+    // render passes
+    void onFrameEnd() override {
+        if (enableDepthPrepass != depthPrepassBuilt_ || useDynamicResolution() != dynamicResolutionBuilt_ ||
+            enableCapture != captureBuilt_) {
+            vkDeviceWaitIdle(vulkanDevice_->getLogicalDevice());
+            if (enableCapture != captureBuilt_) {
+                toggleCapture();
+            }
+            buildRenderGraph();
+        }
     }
 
     void updateUniforms(uint32_t currentImage) override {
-        UniformBufferObject ubo{};
-        
-        glm::mat4 translation = glm::translate(glm::mat4(1.0f), modelPosition);
-        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(modelRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotation = glm::rotate(rotation, glm::radians(modelRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotation = glm::rotate(rotation, glm::radians(modelRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::mat4 scaling = glm::scale(glm::mat4(1.0f), modelScale);
+        // Only nodes changed since the last frame are recomputed. The model matrix is pushed per
+        // draw, only the frame constants go through the uniform buffer.
+        scene_.update();
+        model_ = scene_.getWorldMatrix(modelNode_);
         
-        ubo.model = translation * rotation * scaling;
-        
-        ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.proj = glm::perspective(glm::radians(45.0f), vulkanSwapchain_->getExtent().width / (float) vulkanSwapchain_->getExtent().height, 0.1f, 10.0f);
-        ubo.proj[1][1] *= -1;
+        view_ = glm::lookAt(cameraPosition_, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        proj_ = glm::perspective(glm::radians(45.0f), vulkanSwapchain_->getExtent().width / (float) vulkanSwapchain_->getExtent().height, 0.1f, 10.0f);
+        proj_[1][1] *= -1;
+        currentLod_ = selectLod();
 
+        UniformBufferObject ubo{};
+        ubo.viewProj = proj_ * view_;
         memcpy(uniformBuffersMapped_[currentImage], &ubo, sizeof(ubo));
     }
 
     void recordRenderCommands(VkCommandBuffer commandBuffer, uint32_t imageIndex) override {
         commandManager_->resetCommandBuffer(currentFrame_);
-        commandManager_->recordCommandBuffer(
-            commandBuffer, 
-            imageIndex,
-            vulkanPipeline_->getRenderPass(),
-            swapChainFramebuffers_[imageIndex],
-            vulkanSwapchain_->getExtent(),
-            vulkanPipeline_->getGraphicsPipeline(),
-            vulkanPipeline_->getPipelineLayout(),
-            vertexBuffer_,
-            indexBuffer_,
-            descriptorSets_,
-            currentFrame_,
-            static_cast<uint32_t>(indices_.size())
-        );
-        
-        // Render GUI if enabled (still within the render pass)
-        if (config_.enableGui && guiManager_) {
-            guiManager_->render(commandBuffer);
+        commandManager_->beginCommandBuffer(commandBuffer);
+        selectFramePipelines();
+
+        // The fence of this slot has signaled, so its previous frame's timestamps are available
+        if (gpuTimer_->getFrameTime(currentFrame_, gpuFrameMs_)) {
+            metrics_->record(gpuFrameSeries_, static_cast<float>(gpuFrameMs_));
+            if (dynamicResolutionBuilt_) {
+                dynamicResolution_.update(gpuFrameMs_);
+            }
         }
-        
-        // End render pass and command buffer
-        vkCmdEndRenderPass(commandBuffer);
-        
+        // Pass timestamps are only written while the performance panel is open
+        if (metrics_->isEnabled()) {
+            for (uint32_t passIndex = 0; passIndex < renderGraph_->getPassCount(); passIndex++) {
+                double passMs;
+                if (renderGraph_->getPassTime(passIndex, currentFrame_, passMs)) {
+                    metrics_->record(passSeries_[passIndex], static_cast<float>(passMs));
+                }
+            }
+        }
+        renderGraph_->setPassTimingEnabled(metrics_->isEnabled(), config_.maxFramesInFlight);
+        renderExtent_ = dynamicResolutionBuilt_ ? dynamicResolution_.getRenderExtent(vulkanSwapchain_->getExtent())
+                                                : vulkanSwapchain_->getExtent();
+        renderGraph_->setRenderArea("depth prepass", renderExtent_);
+        renderGraph_->setRenderArea("main", renderExtent_);
+        imageIndex_ = imageIndex;
+        // Frames that completed since the last one are handed to the encoders
+        if (frameCapture_) {
+            frameCapture_->collect(getCompletedFrameCount());
+        }
+
+        drawCount_ = 0;
+        triangleCount_ = 0;
+        gpuTimer_->begin(commandBuffer, currentFrame_);
+        renderGraph_->execute(commandBuffer, currentFrame_, imageIndex);
+        gpuTimer_->end(commandBuffer, currentFrame_);
+        metrics_->record(drawSeries_, static_cast<float>(drawCount_));
+        metrics_->record(triangleSeries_, static_cast<float>(triangleCount_));
+
         VkResult result = vkEndCommandBuffer(commandBuffer);
         if (result != VK_SUCCESS) {
             throw std::runtime_error("Failed to end command buffer recording!");
@@ -207,19 +512,17 @@ protected:
     }
     
     void onCleanup() override {
-        textureManager_->destroyImageView(depthImageView_);
-        textureManager_->destroyImage(depthImage_, depthImageMemory_);
-        
-        for (auto framebuffer : swapChainFramebuffers_) {
-            vkDestroyFramebuffer(vulkanDevice_->getLogicalDevice(), framebuffer, nullptr);
-        }
-        
+        // Writes out the frames still in the readback ring
+        frameCapture_.reset();
+        renderGraph_.reset();
+        gpuTimer_.reset();
+        clusterCuller_.reset();
+
         textureManager_->destroySampler(textureSampler_);
         textureManager_->destroyImageView(textureImageView_);
         textureManager_->destroyImage(textureImage_, textureImageMemory_);
 
-        bufferManager_->destroyBuffer(indexBuffer_, indexBufferMemory_);
-        bufferManager_->destroyBuffer(vertexBuffer_, vertexBufferMemory_);
+        geometryPool_.reset();
         for (size_t i = 0; i < config_.maxFramesInFlight; i++) {
             bufferManager_->destroyBuffer(uniformBuffers_[i], uniformBuffersMemory_[i]);
         }
@@ -228,78 +531,335 @@ protected:
     }
 
 private:
-    void loadModel() {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
-
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, MODEL_PATH.c_str())) {
-            throw std::runtime_error(err);
+    // nullptr for modes without a GUI entry (the shared refresh modes)
+    static const char* presentModeName(VkPresentModeKHR mode) {
+        switch (mode) {
+            case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+            case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO Relaxed";
+            case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+            case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+            default: return nullptr;
         }
+    }
 
-        std::unordered_map<StandardVertex, uint32_t> uniqueVertices{};
+    // Copies the GUI transform to the model node; the Euler angles make a rotation of Rx * Ry * Rz
+    void applyModelTransform() {
+        glm::quat rotation = glm::angleAxis(glm::radians(modelRotation.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+                             glm::angleAxis(glm::radians(modelRotation.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                             glm::angleAxis(glm::radians(modelRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        scene_.setPosition(modelNode_, modelPosition);
+        scene_.setRotation(modelNode_, rotation);
+        scene_.setScale(modelNode_, modelScale);
+    }
 
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                StandardVertex vertex{};
+    // Picks the LOD from the screen space size of its simplification error at the model's bounding sphere
+    uint32_t selectLod() const {
+        if (!automaticLod) {
+            return static_cast<uint32_t>(std::clamp(forcedLod, 0, static_cast<int>(mesh_.lods.size()) - 1));
+        }
 
-                vertex.pos = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]
-                };
+        glm::vec3 center = glm::vec3(model_ * glm::vec4((mesh_.boundsMin + mesh_.boundsMax) * 0.5f, 1.0f));
+        float scale = std::max({glm::length(glm::vec3(model_[0])), glm::length(glm::vec3(model_[1])), glm::length(glm::vec3(model_[2]))});
+        float radius = glm::length(mesh_.boundsMax - mesh_.boundsMin) * 0.5f * scale;
+        float distance = glm::length(center - cameraPosition_) - radius;
 
-                vertex.texCoord = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                };
+        return MeshSimplifier::selectLod(mesh_.lods, distance, scale, proj_[1][1],
+                                         static_cast<float>(vulkanSwapchain_->getExtent().height), lodPixelError);
+    }
 
-                vertex.color = {1.0f, 1.0f, 1.0f};
+    // The upscale blits into the swapchain image, so it needs transfer usage and linear blits of
+    // its format; the controller needs GPU timestamps
+    bool supportsDynamicResolution() const {
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(vulkanDevice_->getPhysicalDevice(), vulkanSwapchain_->getImageFormat(), &properties);
+        VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return gpuTimer_->isSupported() && (vulkanSwapchain_->getImageUsage() & VK_IMAGE_USAGE_TRANSFER_DST_BIT) &&
+               (properties.optimalTilingFeatures & required) == required;
+    }
 
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices_.size());
-                    vertices_.push_back(vertex);
-                }
+    bool useDynamicResolution() const {
+        return enableDynamicResolution && supportsDynamicResolution();
+    }
 
-                indices_.push_back(uniqueVertices[vertex]);
-            }
+    bool supportsCapture() const {
+        return (vulkanSwapchain_->getImageUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) &&
+               FrameCapture::isFormatSupported(vulkanSwapchain_->getImageFormat());
+    }
+
+    // Starts or stops capturing as requested from the GUI. The device must be idle: stopping writes
+    // out every frame still in the readback ring.
+    void toggleCapture() {
+        if (!enableCapture) {
+            frameCapture_.reset();
+            return;
+        }
+
+        static const char* const outputPaths[] = {"capture", "capture.rgba", "capture.y4m"};
+        FrameCapture::Config captureConfig;
+        captureConfig.format = static_cast<FrameCapture::Format>(captureFormat);
+        captureConfig.outputPath = outputPaths[captureFormat];
+        try {
+            frameCapture_ = std::make_unique<FrameCapture>();
+            frameCapture_->initialize(*vulkanDevice_, *bufferManager_, config_.maxFramesInFlight, captureConfig);
+        } catch (const std::exception& e) {
+            std::cout << "Failed to start frame capture - " << e.what() << std::endl;
+            frameCapture_.reset();
+            enableCapture = false;
+        }
+    }
+
+    PipelineState getMaterialState() const {
+        PipelineState state = vulkanPipeline_->getPipelineState();
+        if (materialAlphaBlend) {
+            state.setAlphaBlend();
+        }
+        if (materialDoubleSided) {
+            state.cullMode = VK_CULL_MODE_NONE;
+        }
+        if (materialWireframe && vulkanDevice_->getEnabledFeatures().fillModeNonSolid) {
+            state.polygonMode = VK_POLYGON_MODE_LINE;
         }
+        return state;
     }
 
-    void createFramebuffers(){
-        const std::vector<VkImageView>& swapChainImageViews = vulkanSwapchain_->getImageViews();
-        swapChainFramebuffers_.resize(swapChainImageViews.size());
-
-        for (size_t i = 0; i < swapChainImageViews.size(); i++) {
-            std::array<VkImageView, 2> attachments = {
-                swapChainImageViews[i],
-                depthImageView_
-            };
-
-            VkFramebufferCreateInfo framebufferInfo{};
-            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferInfo.renderPass = vulkanPipeline_->getRenderPass();
-            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-            framebufferInfo.pAttachments = attachments.data();
-            framebufferInfo.width = vulkanSwapchain_->getExtent().width;
-            framebufferInfo.height = vulkanSwapchain_->getExtent().height;
-            framebufferInfo.layers = 1;
-
-            VkResult result = vkCreateFramebuffer(vulkanDevice_->getLogicalDevice(), &framebufferInfo, nullptr, &swapChainFramebuffers_[i]);
-            if (result != VK_SUCCESS) {
-                std::cout<< "failed to create framebuffer - " << i << " - " << result <<std::endl;
-                throw std::runtime_error("failed to create framebuffer!");
-            }else{
-                std::cout<< "successfully created framebuffer - " << i << " - " << result <<std::endl;
+    // Variants compile in the background; until one is ready the default pipeline is used
+    VkPipeline selectMaterialPipeline(const PipelineState& state) {
+        if (state == vulkanPipeline_->getPipelineState()) {
+            return vulkanPipeline_->getGraphicsPipeline();
+        }
+
+        VkPipeline variant = pipelineManager_->requestPipeline(vulkanPipeline_->getPipelineKey(state));
+        return variant != VK_NULL_HANDLE ? variant : vulkanPipeline_->getGraphicsPipeline();
+    }
+
+    // With the prepass in the graph, the main pass draws with an EQUAL depth test and no depth
+    // writes. Both variants have to be ready: until then, and for blended materials, the prepass
+    // only clears depth and the main pass tests LESS as without it.
+    void selectFramePipelines() {
+        PipelineState state = getMaterialState();
+        depthPipeline_ = VK_NULL_HANDLE;
+        if (depthPrepassBuilt_ && !state.blendEnable) {
+            PipelineState equalState = state;
+            equalState.depthCompareOp = VK_COMPARE_OP_EQUAL;
+            equalState.depthWriteEnable = VK_FALSE;
+            VkPipeline depthPipeline = pipelineManager_->requestPipeline(vulkanPipeline_->getDepthOnlyPipelineKey(state));
+            VkPipeline equalPipeline = pipelineManager_->requestPipeline(vulkanPipeline_->getPipelineKey(equalState));
+            if (depthPipeline != VK_NULL_HANDLE && equalPipeline != VK_NULL_HANDLE) {
+                depthPipeline_ = depthPipeline;
+                mainPipeline_ = equalPipeline;
+                return;
             }
         }
+        mainPipeline_ = selectMaterialPipeline(state);
+    }
+
+    // Culled cluster draws when culling is on, otherwise the whole LOD
+    void drawMesh(VkCommandBuffer commandBuffer) {
+        const MeshLod& lod = mesh_.lods[currentLod_];
+        if (clusterCuller_ && enableClusterCulling) {
+            commandManager_->drawIndexedIndirectCount(commandBuffer, clusterCuller_->getDrawBuffer(currentFrame_),
+                                                      clusterCuller_->getCountBuffer(currentFrame_), lod.meshletCount);
+            uint32_t visible = clusterCuller_->getVisibleCount(currentFrame_);
+            drawCount_ += visible;
+            triangleCount_ += lod.meshletCount > 0 ? static_cast<uint64_t>(lod.indexCount / 3) * visible / lod.meshletCount : 0;
+        } else {
+            vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, meshAllocation_.firstIndex + lod.firstIndex,
+                             meshAllocation_.vertexOffset, 0);
+            drawCount_++;
+            triangleCount_ += lod.indexCount / 3;
+        }
+    }
+
+    // The culling pass writes the indirect buffers the main pass draws from; the graph places the
+    // barrier between the two. Called again after a resize, since depth and framebuffers follow the swapchain.
+    //
+    // With dynamic resolution the scene passes draw into the top left renderExtent_ of full size
+    // targets, so the scale can change every frame without reallocating anything, and an upscale
+    // pass blits that region over the whole swapchain image. The GUI is always drawn last, in its
+    // own pass at native resolution.
+    void buildRenderGraph() {
+        renderGraph_->reset();
+        depthPrepassBuilt_ = enableDepthPrepass;
+        dynamicResolutionBuilt_ = useDynamicResolution();
+        captureBuilt_ = frameCapture_ != nullptr;
+
+        VkExtent2D extent = vulkanSwapchain_->getExtent();
+        RenderGraph::ImportedImage backbufferImage;
+        backbufferImage.images = vulkanSwapchain_->getImages();
+        backbufferImage.views = vulkanSwapchain_->getImageViews();
+        backbufferImage.format = vulkanSwapchain_->getImageFormat();
+        backbufferImage.extent = extent;
+        backbufferImage.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        backbufferImage.waitStage = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        RenderGraph::ResourceHandle backbuffer = renderGraph_->importImage("backbuffer", backbufferImage);
+
+        RenderGraph::ResourceHandle sceneColor = backbuffer;
+        if (dynamicResolutionBuilt_) {
+            RenderGraph::ImageDesc sceneDesc;
+            sceneDesc.format = vulkanSwapchain_->getImageFormat();
+            sceneDesc.extent = extent;
+            sceneColor = renderGraph_->createImage("scene color", sceneDesc);
+        }
+
+        // Multisampled targets only live inside the main pass, so the graph keeps them in lazily
+        // allocated memory where the device has it
+        RenderGraph::ResourceHandle color = sceneColor;
+        if (msaaSamples_ != VK_SAMPLE_COUNT_1_BIT) {
+            RenderGraph::ImageDesc colorDesc;
+            colorDesc.format = vulkanSwapchain_->getImageFormat();
+            colorDesc.extent = extent;
+            colorDesc.samples = msaaSamples_;
+            color = renderGraph_->createImage("color msaa", colorDesc);
+        }
+
+        RenderGraph::ImageDesc depthDesc;
+        depthDesc.format = vulkanPipeline_->getDepthFormat();
+        depthDesc.extent = extent;
+        depthDesc.samples = msaaSamples_;
+        RenderGraph::ResourceHandle depth = renderGraph_->createImage("depth", depthDesc);
+
+        RenderGraph::ResourceHandle clusterDraws = RenderGraph::INVALID_RESOURCE;
+        RenderGraph::ResourceHandle clusterCount = RenderGraph::INVALID_RESOURCE;
+        if (clusterCuller_) {
+            clusterDraws = renderGraph_->importBuffers("cluster draws", clusterCuller_->getDrawBuffers());
+            clusterCount = renderGraph_->importBuffers("cluster count", clusterCuller_->getCountBuffers());
+
+            renderGraph_->addPass("cluster cull",
+                [&](RenderGraph::PassBuilder& builder) {
+                    builder.write(clusterDraws, RenderGraph::ResourceUsage::StorageWriteCompute);
+                    builder.write(clusterCount, RenderGraph::ResourceUsage::StorageWriteCompute);
+                },
+                [this](VkCommandBuffer commandBuffer) {
+                    if (!enableClusterCulling) {
+                        return;
+                    }
+                    uint32_t cullFlags = ClusterCuller::CULL_FRUSTUM;
+                    if (enableConeCulling) {
+                        cullFlags |= ClusterCuller::CULL_BACKFACE_CONE;
+                    }
+                    const MeshLod& lod = mesh_.lods[currentLod_];
+                    clusterCuller_->recordCulling(commandBuffer, currentFrame_, lod.firstMeshlet, lod.meshletCount,
+                                                  model_, proj_ * view_, cameraPosition_, cullFlags);
+                });
+        }
+
+        // The prepass draws the same culled clusters with positions only. Depth stays writable in
+        // the main pass so it can fall back to LESS while the prepass variants compile.
+        if (depthPrepassBuilt_) {
+            renderGraph_->addPass("depth prepass",
+                [&](RenderGraph::PassBuilder& builder) {
+                    builder.writeDepth(depth);
+                    if (clusterCuller_) {
+                        builder.read(clusterDraws, RenderGraph::ResourceUsage::IndirectRead);
+                        builder.read(clusterCount, RenderGraph::ResourceUsage::IndirectRead);
+                    }
+                },
+                [this](VkCommandBuffer commandBuffer) {
+                    if (depthPipeline_ == VK_NULL_HANDLE) {
+                        return;
+                    }
+                    const QuantizationParams* quantization = mesh_.format == VertexFormat::Compact ? &mesh_.quantization : nullptr;
+                    VkBuffer positionBuffer = mesh_.format == VertexFormat::Compact ? geometryPool_->getVertexBuffer()
+                                                                                    : geometryPool_->getPositionBuffer();
+
+                    commandManager_->bindGeometry(commandBuffer, renderExtent_,
+                                                  depthPipeline_, vulkanPipeline_->getPipelineLayout(),
+                                                  positionBuffer, geometryPool_->getIndexBuffer(),
+                                                  descriptorSets_[currentFrame_]);
+                    commandManager_->pushDrawConstants(commandBuffer, vulkanPipeline_->getPipelineLayout(), model_, quantization);
+                    drawMesh(commandBuffer);
+                });
+        }
+
+        renderGraph_->addPass("main",
+            [&](RenderGraph::PassBuilder& builder) {
+                builder.writeColor(color, VK_ATTACHMENT_LOAD_OP_CLEAR, {{0.0f, 0.0f, 0.0f, 1.0f}});
+                if (color != sceneColor) {
+                    builder.resolveColor(color, sceneColor);
+                }
+                builder.writeDepth(depth, depthPrepassBuilt_ ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR);
+                if (clusterCuller_) {
+                    builder.read(clusterDraws, RenderGraph::ResourceUsage::IndirectRead);
+                    builder.read(clusterCount, RenderGraph::ResourceUsage::IndirectRead);
+                }
+            },
+            [this](VkCommandBuffer commandBuffer) {
+                const QuantizationParams* quantization = mesh_.format == VertexFormat::Compact ? &mesh_.quantization : nullptr;
+
+                commandManager_->bindGeometry(commandBuffer, renderExtent_,
+                                              mainPipeline_, vulkanPipeline_->getPipelineLayout(),
+                                              geometryPool_->getVertexBuffer(), geometryPool_->getIndexBuffer(),
+                                              descriptorSets_[currentFrame_]);
+                commandManager_->pushDrawConstants(commandBuffer, vulkanPipeline_->getPipelineLayout(), model_, quantization);
+                drawMesh(commandBuffer);
+            });
+
+        if (dynamicResolutionBuilt_) {
+            renderGraph_->addPass("upscale",
+                [&](RenderGraph::PassBuilder& builder) {
+                    builder.read(sceneColor, RenderGraph::ResourceUsage::TransferSrc);
+                    builder.write(backbuffer, RenderGraph::ResourceUsage::TransferDst);
+                },
+                [this, sceneColor, backbuffer](VkCommandBuffer commandBuffer) {
+                    VkExtent2D extent = vulkanSwapchain_->getExtent();
+                    VkImageBlit blit{};
+                    blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                    blit.srcOffsets[1] = {static_cast<int32_t>(renderExtent_.width), static_cast<int32_t>(renderExtent_.height), 1};
+                    blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                    blit.dstOffsets[1] = {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1};
+                    vkCmdBlitImage(commandBuffer, renderGraph_->getImage(sceneColor), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   renderGraph_->getImage(backbuffer, imageIndex_), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   1, &blit, VK_FILTER_LINEAR);
+                });
+        }
+
+        // Copies the finished frame before the GUI is drawn over it
+        if (captureBuilt_) {
+            renderGraph_->addPass("capture",
+                [&](RenderGraph::PassBuilder& builder) {
+                    builder.read(backbuffer, RenderGraph::ResourceUsage::TransferSrc);
+                    builder.setSideEffect();
+                },
+                [this, backbuffer](VkCommandBuffer commandBuffer) {
+                    frameCapture_->captureFrame(commandBuffer, getFrameNumber(), renderGraph_->getImage(backbuffer, imageIndex_),
+                                                vulkanSwapchain_->getImageFormat(), vulkanSwapchain_->getExtent());
+                });
+        }
+
+        if (config_.enableGui && guiManager_) {
+            renderGraph_->addPass("gui",
+                [&](RenderGraph::PassBuilder& builder) {
+                    builder.writeColor(backbuffer, VK_ATTACHMENT_LOAD_OP_LOAD);
+                },
+                [this](VkCommandBuffer commandBuffer) {
+                    guiManager_->render(commandBuffer);
+                });
+        }
+
+        renderGraph_->compile();
+        passSeries_.clear();
+        for (uint32_t passIndex = 0; passIndex < renderGraph_->getPassCount(); passIndex++) {
+            passSeries_.push_back(metrics_->addSeries(renderGraph_->getPassName(passIndex), Metrics::Category::GpuPass));
+        }
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
+    std::string assetPackPath;
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--asset-pack" && i + 1 < argc) {
+            assetPackPath = argv[++i];
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--asset-pack <file>]\n"
+                      << "  --asset-pack <file> load assets from a pack built by vulkan_packer\n";
+            return option == "--help" || option == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
     try {
-        MyVulkanApp app;
+        MyVulkanApp app(assetPackPath);
         app.run();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
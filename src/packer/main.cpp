@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../common/FileUtils.h"
+#include "../resources/AssetPack.h"
+#include "../resources/TextureManager.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --assets <dir>     assets tree to pack (default ../assets)\n"
+                  << "  --output <file>    pack file (default assets.pack)\n"
+                  << "  --raw-images       store images as they are instead of decoded to RGBA8\n";
+    }
+
+    bool isImage(const std::filesystem::path& path) {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+               extension == ".bmp";
+    }
+
+    void pad(std::ofstream& out, uint64_t& offset) {
+        static const char zeros[AssetPack::BLOB_ALIGNMENT] = {};
+        uint64_t padding = (AssetPack::BLOB_ALIGNMENT - offset % AssetPack::BLOB_ALIGNMENT) % AssetPack::BLOB_ALIGNMENT;
+        out.write(zeros, static_cast<std::streamsize>(padding));
+        offset += padding;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::filesystem::path assetsDir = "../assets";
+    std::string outputPath = "assets.pack";
+    bool rawImages = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--raw-images") {
+            rawImages = true;
+        } else if (option == "--help" || option == "-h") {
+            printUsage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (option == "--assets" && i + 1 < argc) {
+            assetsDir = argv[++i];
+        } else if (option == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            std::cerr << "Unknown option " << option << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        // Sorted so the same tree always gives the same pack
+        std::vector<std::filesystem::path> files;
+        for (const auto& item : std::filesystem::recursive_directory_iterator(assetsDir)) {
+            if (item.is_regular_file()) {
+                files.push_back(item.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("failed to open " + outputPath);
+        }
+
+        // The table is written last, once every blob's offset is known; the paths follow it
+        AssetPack::Header header;
+        header.entryCount = static_cast<uint32_t>(files.size());
+        std::vector<AssetPack::Entry> entries;
+        entries.reserve(files.size());
+        std::vector<std::string> relativePaths;
+        for (const std::filesystem::path& file : files) {
+            relativePaths.push_back(std::filesystem::relative(file, assetsDir).generic_string());
+        }
+        uint64_t offset = sizeof(AssetPack::Header) + files.size() * sizeof(AssetPack::Entry);
+        out.write(std::string(static_cast<size_t>(offset), '\0').data(), static_cast<std::streamsize>(offset));
+        uint64_t pathOffset = offset;
+        for (const std::string& relativePath : relativePaths) {
+            out.write(relativePath.data(), static_cast<std::streamsize>(relativePath.size()));
+            offset += relativePath.size();
+        }
+        pad(out, offset);
+
+        for (size_t i = 0; i < files.size(); i++) {
+            const std::filesystem::path& file = files[i];
+            const std::string& relativePath = relativePaths[i];
+            AssetPack::Entry entry;
+            entry.pathHash = AssetPack::hashPath(relativePath);
+            entry.offset = offset;
+            entry.pathOffset = pathOffset;
+            entry.pathLength = static_cast<uint32_t>(relativePath.size());
+            pathOffset += relativePath.size();
+
+            // Decoded once here instead of on every load; images stb_image cannot read stay as they are
+            ImageRgba8 image;
+            std::vector<uint8_t> data;
+            if (!rawImages && isImage(file) && TextureManager::loadPixels(file.string(), image)) {
+                entry.format = AssetPack::Format::Rgba8;
+                entry.width = image.width;
+                entry.height = image.height;
+                data = std::move(image.pixels);
+            } else if (!readFile(file.string(), data)) {
+                throw std::runtime_error("failed to open " + file.string());
+            }
+            entry.size = data.size();
+            out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            offset += data.size();
+            pad(out, offset);
+
+            entries.push_back(entry);
+            std::cout << relativePath << " - " << (entry.format == AssetPack::Format::Rgba8 ? "rgba8, " : "raw, ")
+                      << entry.size << " bytes" << std::endl;
+        }
+
+        // Stable, so assets whose paths share a hash keep a fixed order
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const AssetPack::Entry& a, const AssetPack::Entry& b) { return a.pathHash < b.pathHash; });
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AssetPack::Entry)));
+        if (!out.good()) {
+            throw std::runtime_error("failed to write " + outputPath);
+        }
+
+        std::cout << "Packed " << entries.size() << " assets into " << outputPath << " - "
+                  << offset / (1024 * 1024) << " MiB" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
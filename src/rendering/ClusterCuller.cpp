@@ -0,0 +1,234 @@
+#include "ClusterCuller.h"
+#include "../descriptors/ShaderReflection.h"
+#include "../common/FileUtils.h"
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <array>
+#include <algorithm>
+
+ClusterCuller::ClusterCuller() {}
+
+ClusterCuller::~ClusterCuller() {
+    cleanup();
+}
+
+void ClusterCuller::initialize(const VulkanDevice& device, BufferManager& bufMgr, LayoutCache& layoutCache, uint32_t maxFramesInFlight) {
+    this->vulkanDevice = &device;
+    this->bufferManager = &bufMgr;
+    this->layoutCache = &layoutCache;
+    this->maxFramesInFlight = maxFramesInFlight;
+
+    createPipeline();
+}
+
+void ClusterCuller::cleanup() {
+    if (vulkanDevice) {
+        destroyMeshletBuffers();
+        vkDestroyPipeline(vulkanDevice->getLogicalDevice(), pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+        pipelineLayout = VK_NULL_HANDLE;
+        descriptorSetLayout = VK_NULL_HANDLE;
+        vulkanDevice = nullptr;
+    }
+}
+
+void ClusterCuller::createPipeline() {
+    auto computeShaderCode = readFile("../shaders/cluster_cull_comp.spv");
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = computeShaderCode.size();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(computeShaderCode.data());
+    VkShaderModule computeShaderModule;
+    if (vkCreateShaderModule(vulkanDevice->getLogicalDevice(), &moduleInfo, nullptr, &computeShaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    // Storage buffer bindings and the CullParams push range come from the shader itself
+    ShaderReflection reflection = ShaderReflection::reflect(computeShaderCode);
+    if (reflection.pushConstantRanges.empty() || reflection.pushConstantRanges[0].size != sizeof(CullParams)) {
+        std::cout << "Warning: cluster_cull.comp push constants do not match CullParams" << std::endl;
+    }
+    LayoutCache::PipelineLayoutInfo layouts = layoutCache->getLayouts(reflection);
+    descriptorSetLayout = layouts.setLayouts.at(0);
+    pipelineLayout = layouts.pipelineLayout;
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = computeShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(vulkanDevice->getLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to create cluster culling pipeline - " << result << std::endl;
+        throw std::runtime_error("failed to create cluster culling pipeline!");
+    } else {
+        std::cout << "Successfully created cluster culling pipeline - " << result << std::endl;
+    }
+
+    vkDestroyShaderModule(vulkanDevice->getLogicalDevice(), computeShaderModule, nullptr);
+}
+
+void ClusterCuller::setMeshlets(const std::vector<Meshlet>& meshlets) {
+    destroyMeshletBuffers();
+    totalMeshletCount = static_cast<uint32_t>(meshlets.size());
+    if (totalMeshletCount == 0) {
+        return;
+    }
+
+    bufferManager->createDeviceLocalBuffer(meshlets.data(), sizeof(Meshlet) * meshlets.size(),
+                                           VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, meshletBuffer, meshletBufferMemory);
+
+    drawBuffers.resize(maxFramesInFlight);
+    drawBuffersMemory.resize(maxFramesInFlight);
+    countBuffers.resize(maxFramesInFlight);
+    countBuffersMemory.resize(maxFramesInFlight);
+    countBuffersMapped.resize(maxFramesInFlight);
+
+    for (uint32_t i = 0; i < maxFramesInFlight; i++) {
+        bufferManager->createBuffer(sizeof(VkDrawIndexedIndirectCommand) * totalMeshletCount,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, drawBuffers[i], drawBuffersMemory[i]);
+        // Host visible so the surviving cluster count can be shown without an explicit readback
+        bufferManager->createBuffer(sizeof(uint32_t),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    countBuffers[i], countBuffersMemory[i]);
+        vkMapMemory(vulkanDevice->getLogicalDevice(), countBuffersMemory[i], 0, sizeof(uint32_t), 0, &countBuffersMapped[i]);
+        *static_cast<uint32_t*>(countBuffersMapped[i]) = 0;
+    }
+
+    createDescriptorSets();
+}
+
+void ClusterCuller::createDescriptorSets() {
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 3 * maxFramesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = maxFramesInFlight;
+
+    if (vkCreateDescriptorPool(vulkanDevice->getLogicalDevice(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create cluster culling descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(maxFramesInFlight, descriptorSetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = maxFramesInFlight;
+    allocInfo.pSetLayouts = layouts.data();
+
+    descriptorSets.resize(maxFramesInFlight);
+    if (vkAllocateDescriptorSets(vulkanDevice->getLogicalDevice(), &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate cluster culling descriptor sets!");
+    }
+
+    for (uint32_t i = 0; i < maxFramesInFlight; i++) {
+        std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+        bufferInfos[0] = {meshletBuffer, 0, VK_WHOLE_SIZE};
+        bufferInfos[1] = {drawBuffers[i], 0, VK_WHOLE_SIZE};
+        bufferInfos[2] = {countBuffers[i], 0, VK_WHOLE_SIZE};
+
+        std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+        for (uint32_t binding = 0; binding < descriptorWrites.size(); binding++) {
+            descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[binding].dstSet = descriptorSets[i];
+            descriptorWrites[binding].dstBinding = binding;
+            descriptorWrites[binding].dstArrayElement = 0;
+            descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[binding].descriptorCount = 1;
+            descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+        }
+
+        vkUpdateDescriptorSets(vulkanDevice->getLogicalDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+    }
+}
+
+void ClusterCuller::recordCulling(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                                  uint32_t firstMeshlet, uint32_t meshletCount,
+                                  const glm::mat4& model, const glm::mat4& viewProj, const glm::vec3& cameraPosition,
+                                  uint32_t flags) {
+    vkCmdFillBuffer(commandBuffer, countBuffers[currentFrame], 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    // Culling runs in object space: planes become transpose(model) * plane, which keeps distances
+    // in world units, and the sphere radius is scaled by the largest axis scale
+    CullParams params{};
+    glm::vec4 worldPlanes[6];
+    extractFrustumPlanes(viewProj, worldPlanes);
+    for (int i = 0; i < 6; i++) {
+        params.frustumPlanes[i] = worldPlanes[i] * model;
+    }
+    glm::vec3 objectCamera = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+    float radiusScale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+    params.cameraPositionRadiusScale = glm::vec4(objectCamera, radiusScale);
+    params.firstMeshlet = firstMeshlet;
+    params.meshletCount = meshletCount;
+    params.firstIndexOffset = 0;
+    params.flags = flags;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullParams), &params);
+    vkCmdDispatch(commandBuffer, (meshletCount + 63) / 64, 1, 1);
+}
+
+uint32_t ClusterCuller::getVisibleCount(uint32_t currentFrame) const {
+    if (currentFrame >= countBuffersMapped.size()) {
+        return 0;
+    }
+    return *static_cast<const uint32_t*>(countBuffersMapped[currentFrame]);
+}
+
+void ClusterCuller::extractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]) {
+    glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+    planes[0] = row3 + row0;  // left
+    planes[1] = row3 - row0;  // right
+    planes[2] = row3 + row1;  // bottom
+    planes[3] = row3 - row1;  // top
+    planes[4] = row2;         // near (depth range starts at 0)
+    planes[5] = row3 - row2;  // far
+
+    for (int i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+}
+
+void ClusterCuller::destroyMeshletBuffers() {
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(vulkanDevice->getLogicalDevice(), descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    descriptorSets.clear();
+
+    bufferManager->destroyBuffer(meshletBuffer, meshletBufferMemory);
+    for (size_t i = 0; i < drawBuffers.size(); i++) {
+        bufferManager->destroyBuffer(drawBuffers[i], drawBuffersMemory[i]);
+        bufferManager->destroyBuffer(countBuffers[i], countBuffersMemory[i]);
+    }
+    drawBuffers.clear();
+    drawBuffersMemory.clear();
+    countBuffers.clear();
+    countBuffersMemory.clear();
+    countBuffersMapped.clear();
+    totalMeshletCount = 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include "../core/VulkanDevice.h"
+#include "../resources/BufferManager.h"
+#include "../descriptors/LayoutCache.h"
+#include "../geometry/MeshletBuilder.h"
+
+// Compute pass that frustum and normal-cone culls meshlets and compacts the survivors into
+// a VkDrawIndexedIndirectCommand buffer plus draw count, consumed by vkCmdDrawIndexedIndirectCount
+class ClusterCuller {
+    public:
+        enum CullFlags : uint32_t {
+            CULL_FRUSTUM = 1u << 0,
+            CULL_BACKFACE_CONE = 1u << 1
+        };
+
+        // Matches the push constant block in shaders/cluster_cull.comp
+        struct CullParams {
+            glm::vec4 frustumPlanes[6];
+            glm::vec4 cameraPositionRadiusScale;
+            uint32_t firstMeshlet;
+            uint32_t meshletCount;
+            uint32_t firstIndexOffset;
+            uint32_t flags;
+        };
+
+        ClusterCuller();
+        ~ClusterCuller();
+
+        void initialize(const VulkanDevice& device, BufferManager& bufferManager, LayoutCache& layoutCache, uint32_t maxFramesInFlight);
+        void cleanup();
+
+        // Uploads the cluster list (all LODs) and sizes the per-frame draw buffers for it
+        void setMeshlets(const std::vector<Meshlet>& meshlets);
+
+        // Records the culling dispatch over meshlets [firstMeshlet, firstMeshlet + meshletCount). Must be
+        // recorded outside of a render pass; the caller orders the indirect reads after it (the render
+        // graph does so from the pass declarations).
+        void recordCulling(VkCommandBuffer commandBuffer, uint32_t currentFrame,
+                           uint32_t firstMeshlet, uint32_t meshletCount,
+                           const glm::mat4& model, const glm::mat4& viewProj, const glm::vec3& cameraPosition,
+                           uint32_t flags = CULL_FRUSTUM | CULL_BACKFACE_CONE);
+
+        VkBuffer getDrawBuffer(uint32_t currentFrame) const { return drawBuffers[currentFrame]; }
+        VkBuffer getCountBuffer(uint32_t currentFrame) const { return countBuffers[currentFrame]; }
+        const std::vector<VkBuffer>& getDrawBuffers() const { return drawBuffers; }
+        const std::vector<VkBuffer>& getCountBuffers() const { return countBuffers; }
+        uint32_t getMeshletCount() const { return totalMeshletCount; }
+        // Surviving cluster count of the last completed frame that used this slot
+        uint32_t getVisibleCount(uint32_t currentFrame) const;
+
+        // Gribb/Hartmann planes (xyz normal, w distance) for a [0, 1] depth range projection
+        static void extractFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]);
+
+    private:
+        const VulkanDevice* vulkanDevice = nullptr;
+        BufferManager* bufferManager = nullptr;
+        LayoutCache* layoutCache = nullptr;
+        uint32_t maxFramesInFlight = 0;
+        uint32_t totalMeshletCount = 0;
+
+        // Owned by the LayoutCache
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> descriptorSets;
+
+        VkBuffer meshletBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory meshletBufferMemory = VK_NULL_HANDLE;
+        std::vector<VkBuffer> drawBuffers;
+        std::vector<VkDeviceMemory> drawBuffersMemory;
+        std::vector<VkBuffer> countBuffers;
+        std::vector<VkDeviceMemory> countBuffersMemory;
+        std::vector<void*> countBuffersMapped;
+
+        void createPipeline();
+        void createDescriptorSets();
+        void destroyMeshletBuffers();
+};
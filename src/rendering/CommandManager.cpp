@@ -97,12 +97,7 @@ void CommandManager::resetCommandBuffer(uint32_t frameIndex) {
     vkResetCommandBuffer(commandBuffers[frameIndex], 0);
 }
 
-void CommandManager::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, 
-                           VkRenderPass renderPass, VkFramebuffer framebuffer,
-                           VkExtent2D extent, VkPipeline graphicsPipeline,
-                           VkPipelineLayout pipelineLayout, VkBuffer vertexBuffer,
-                           VkBuffer indexBuffer, const std::vector<VkDescriptorSet>& descriptorSets,
-                           uint32_t currentFrame, uint32_t indexCount) {
+void CommandManager::beginCommandBuffer(VkCommandBuffer commandBuffer) {
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0; // Optional
@@ -115,7 +110,10 @@ void CommandManager::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     }else{
         //std::cout << "Successfully started recording command buffer - " << beginCommandBufferResult << std::endl;
     }
+}
 
+void CommandManager::beginRenderPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass,
+                           VkFramebuffer framebuffer, VkExtent2D extent) {
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassInfo.renderPass = renderPass;
@@ -131,7 +129,11 @@ void CommandManager::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     renderPassInfo.pClearValues = clearValues.data();
 
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
 
+void CommandManager::bindGeometry(VkCommandBuffer commandBuffer, VkExtent2D extent,
+                           VkPipeline graphicsPipeline, VkPipelineLayout pipelineLayout,
+                           VkBuffer vertexBuffer, VkBuffer indexBuffer, VkDescriptorSet descriptorSet) {
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 
     VkBuffer vertexBuffers[] = {vertexBuffer};
@@ -153,6 +155,39 @@ void CommandManager::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t
     scissor.extent = extent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indexCount), 1, 0, 0, 0);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+}
+
+void CommandManager::pushDrawConstants(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout,
+                           const glm::mat4& model, const QuantizationParams* quantization) {
+    DrawPushConstants constants{};
+    constants.model = model;
+    // Standard vertex shaders only declare the model matrix
+    uint32_t size = sizeof(glm::mat4);
+    if (quantization) {
+        constants.quantization = *quantization;
+        size = sizeof(DrawPushConstants);
+    }
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, size, &constants);
+}
+
+void CommandManager::drawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer drawBuffer,
+                           VkBuffer countBuffer, uint32_t maxDrawCount) {
+    vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer, 0, countBuffer, 0, maxDrawCount,
+                                  sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void CommandManager::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, 
+                           VkRenderPass renderPass, VkFramebuffer framebuffer,
+                           VkExtent2D extent, VkPipeline graphicsPipeline,
+                           VkPipelineLayout pipelineLayout, VkBuffer vertexBuffer,
+                           VkBuffer indexBuffer, const std::vector<VkDescriptorSet>& descriptorSets,
+                           uint32_t currentFrame, uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset,
+                           const glm::mat4& model, const QuantizationParams* quantization) {
+    beginCommandBuffer(commandBuffer);
+    beginRenderPass(commandBuffer, renderPass, framebuffer, extent);
+    bindGeometry(commandBuffer, extent, graphicsPipeline, pipelineLayout, vertexBuffer, indexBuffer,
+                 descriptorSets[currentFrame]);
+    pushDrawConstants(commandBuffer, pipelineLayout, model, quantization);
+    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indexCount), 1, firstIndex, vertexOffset, 0);
 }
@@ -3,6 +3,8 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include "../core/VulkanDevice.h"
+#include "../common/VertexTypes.h"
+#include "../common/UniformTypes.h"
 
 class CommandManager {
     public:
@@ -20,12 +22,28 @@ class CommandManager {
         void endSingleTimeCommands(VkCommandBuffer commmandBuffer);
 
         void resetCommandBuffer(uint32_t frameIndex);
+
+        // Building blocks of recordCommandBuffer, for frames that record work before the render pass
+        void beginCommandBuffer(VkCommandBuffer commandBuffer);
+        void beginRenderPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass,
+                           VkFramebuffer framebuffer, VkExtent2D extent);
+        void bindGeometry(VkCommandBuffer commandBuffer, VkExtent2D extent,
+                           VkPipeline graphicsPipeline, VkPipelineLayout pipelineLayout,
+                           VkBuffer vertexBuffer, VkBuffer indexBuffer, VkDescriptorSet descriptorSet);
+        // Per-draw data goes through push constants, so changing it between draws needs no buffer
+        // writes or descriptor binds. Pass quantization only for pipelines using CompactVertex.
+        void pushDrawConstants(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout,
+                           const glm::mat4& model, const QuantizationParams* quantization = nullptr);
+        void drawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer drawBuffer,
+                           VkBuffer countBuffer, uint32_t maxDrawCount);
+
         void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, 
                            VkRenderPass renderPass, VkFramebuffer framebuffer,
                            VkExtent2D extent, VkPipeline graphicsPipeline,
                            VkPipelineLayout pipelineLayout, VkBuffer vertexBuffer,
                            VkBuffer indexBuffer, const std::vector<VkDescriptorSet>& descriptorSets,
-                           uint32_t currentFrame, uint32_t indexCount);
+                           uint32_t currentFrame, uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset,
+                           const glm::mat4& model, const QuantizationParams* quantization = nullptr);
 
     private:
         const VulkanDevice* vulkanDevice = nullptr;
@@ -0,0 +1,47 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution() {
+    reset();
+}
+
+DynamicResolution::DynamicResolution(const Config& config) : config(config) {
+    reset();
+}
+
+void DynamicResolution::setConfig(const Config& config) {
+    this->config = config;
+    scale = std::clamp(scale, config.minScale, config.maxScale);
+}
+
+void DynamicResolution::reset() {
+    scale = config.maxScale;
+    smoothedFrameMs = 0.0;
+    hasSample = false;
+}
+
+float DynamicResolution::update(double gpuFrameMs) {
+    if (gpuFrameMs <= 0.0) {
+        return scale;
+    }
+    smoothedFrameMs = hasSample ? smoothedFrameMs + config.smoothing * (gpuFrameMs - smoothedFrameMs) : gpuFrameMs;
+    hasSample = true;
+
+    double ratio = config.targetFrameMs / smoothedFrameMs;
+    if (std::abs(1.0 - ratio) <= config.deadBand) {
+        return scale;
+    }
+
+    float step = static_cast<float>(std::sqrt(ratio));
+    step = std::clamp(step, 1.0f - config.maxStep, 1.0f + config.maxStep);
+    scale = std::clamp(scale * step, config.minScale, config.maxScale);
+    return scale;
+}
+
+VkExtent2D DynamicResolution::getRenderExtent(VkExtent2D fullExtent) const {
+    VkExtent2D extent;
+    extent.width = std::clamp(static_cast<uint32_t>(std::lround(fullExtent.width * scale)), 1u, std::max(fullExtent.width, 1u));
+    extent.height = std::clamp(static_cast<uint32_t>(std::lround(fullExtent.height * scale)), 1u, std::max(fullExtent.height, 1u));
+    return extent;
+}
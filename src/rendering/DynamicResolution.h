@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// Picks the fraction of the output resolution the scene is rendered at from measured GPU frame
+// times. Cost is roughly proportional to the pixel count, so the scale follows the square root of
+// the ratio between the target and the smoothed frame time. Steps are limited per update and a
+// dead band around the target lets the scale settle instead of oscillating.
+class DynamicResolution {
+    public:
+        struct Config {
+            // Per axis, relative to the output extent
+            float minScale = 0.5f;
+            float maxScale = 1.0f;
+            // GPU time budget per frame
+            float targetFrameMs = 16.0f;
+            // No change while the smoothed time is within this fraction of the target
+            float deadBand = 0.05f;
+            // Largest relative scale change per update
+            float maxStep = 0.05f;
+            // Weight of a new sample in the moving average of frame times
+            float smoothing = 0.1f;
+        };
+
+        DynamicResolution();
+        DynamicResolution(const Config& config);
+
+        void setConfig(const Config& config);
+        const Config& getConfig() const { return config; }
+        // Back to full scale, e.g. after the output resolution changed
+        void reset();
+
+        // Feeds one GPU frame time and returns the new scale
+        float update(double gpuFrameMs);
+
+        float getScale() const { return scale; }
+        double getSmoothedFrameTime() const { return smoothedFrameMs; }
+        // fullExtent scaled down, at least 1x1
+        VkExtent2D getRenderExtent(VkExtent2D fullExtent) const;
+
+    private:
+        Config config;
+        float scale = 1.0f;
+        double smoothedFrameMs = 0.0;
+        bool hasSample = false;
+};
@@ -0,0 +1,255 @@
+#include "FrameCapture.h"
+#include "../common/PixelConvert.h"
+#include "../resources/ImageWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+FrameCapture::FrameCapture() {}
+
+FrameCapture::~FrameCapture() {
+    cleanup();
+}
+
+void FrameCapture::initialize(const VulkanDevice& device, BufferManager& bufferManager, uint32_t maxFramesInFlight, const Config& config) {
+    this->config = config;
+
+    if (config.format == Format::Png) {
+        std::filesystem::create_directories(config.outputPath);
+    } else {
+        stream.open(config.outputPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            throw std::runtime_error("failed to open capture file: " + config.outputPath);
+        }
+    }
+
+    uint32_t depth = std::max(config.readbackDepth, maxFramesInFlight + 1);
+    frameReadback.initialize(device, bufferManager, depth);
+
+    stopping = false;
+    uint32_t workerCount = std::max(config.workerCount, 1u);
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&FrameCapture::workerLoop, this);
+    }
+    std::cout << "Successfully started frame capture - " << config.outputPath << ", " << depth << " readback buffers, "
+              << workerCount << " workers" << std::endl;
+}
+
+void FrameCapture::cleanup() {
+    if (workers.empty()) {
+        return;
+    }
+
+    // Everything recorded has completed once the device is idle
+    collect(UINT64_MAX);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    if (stream.is_open()) {
+        finishY4mHeader();
+        stream.close();
+    }
+    frameReadback.cleanup();
+
+    Stats finalStats = getStats();
+    std::cout << "Frame capture finished - " << finalStats.writtenFrames << " frames written to " << config.outputPath
+              << ", " << finalStats.skippedFrames << " skipped, " << finalStats.blockedMilliseconds << " ms blocked" << std::endl;
+}
+
+void FrameCapture::collect(uint64_t completedFrames) {
+    this->completedFrames = completedFrames;
+
+    // acquire() returns the oldest frame first, so sequence numbers follow frame order
+    FrameReadback::Readback readback;
+    bool queued = false;
+    while (frameReadback.acquire(completedFrames, readback)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back({readback, nextSequence++});
+        queued = true;
+    }
+    if (queued) {
+        queueCondition.notify_all();
+    }
+}
+
+bool FrameCapture::captureFrame(VkCommandBuffer commandBuffer, uint64_t frame, VkImage image, VkFormat format, VkExtent2D extent) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error.empty()) {
+            return false;
+        }
+        if (config.format != Format::Png) {
+            if (streamExtent.width == 0) {
+                streamExtent = extent;
+            } else if (extent.width != streamExtent.width || extent.height != streamExtent.height) {
+                stats.skippedFrames++;
+                return false;
+            }
+        }
+    }
+
+    auto blockStart = std::chrono::steady_clock::now();
+    bool recorded = frameReadback.copyImage(commandBuffer, frame, image, format, extent);
+    while (!recorded) {
+        // Frames completed since collect() may have freed up their buffers' encoders; otherwise
+        // wait for a worker to release one
+        collect(completedFrames);
+        if (!frameReadback.waitForFreeBuffer()) {
+            break;
+        }
+        recorded = frameReadback.copyImage(commandBuffer, frame, image, format, extent);
+    }
+    double blocked = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - blockStart).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (recorded) {
+        lastCaptureTime = std::chrono::steady_clock::now();
+        if (stats.capturedFrames == 0) {
+            firstCaptureTime = lastCaptureTime;
+        }
+        stats.capturedFrames++;
+    } else {
+        stats.skippedFrames++;
+    }
+    stats.blockedMilliseconds += blocked;
+    return recorded;
+}
+
+FrameCapture::Stats FrameCapture::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::string FrameCapture::getError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+void FrameCapture::workerLoop() {
+    std::vector<uint8_t> encoded;
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueCondition.wait(lock, [this] { return stopping || !jobs.empty(); });
+            // Drains the queue before stopping
+            if (jobs.empty()) {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        bool encodedOk = true;
+        try {
+            encode(job.readback, encoded);
+        } catch (const std::exception& e) {
+            setError(e.what());
+            encodedOk = false;
+        }
+        // The encoded copy is all that is needed from here on
+        frameReadback.release(job.readback.buffer);
+
+        writeFrame(job, encoded, encodedOk);
+    }
+}
+
+void FrameCapture::encode(const FrameReadback::Readback& readback, std::vector<uint8_t>& encoded) const {
+    uint32_t width = readback.extent.width;
+    uint32_t height = readback.extent.height;
+    switch (config.format) {
+        case Format::Png:
+            ImageWriter::encodePng(readback.data, width, height, readback.isBgra(), encoded);
+            break;
+        case Format::Raw:
+            if (readback.isBgra()) {
+                encoded.resize(static_cast<size_t>(width) * height * 4);
+                PixelConvert::swapRedBlue(readback.data, encoded.data(), static_cast<size_t>(width) * height);
+            } else {
+                encoded.assign(readback.data, readback.data + static_cast<size_t>(width) * height * 4);
+            }
+            break;
+        case Format::Y4m:
+            ImageWriter::encodeI420(readback.data, width, height, readback.isBgra(), encoded);
+            break;
+    }
+}
+
+void FrameCapture::writeFrame(const Job& job, const std::vector<uint8_t>& encoded, bool encodedOk) {
+    if (config.format == Format::Png) {
+        if (!encodedOk) {
+            return;
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%06llu.png", static_cast<unsigned long long>(job.sequence));
+        std::string path = (std::filesystem::path(config.outputPath) / name).string();
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        if (!file.good()) {
+            setError("failed to write capture frame: " + path);
+            return;
+        }
+    } else {
+        std::unique_lock<std::mutex> lock(streamMutex);
+        streamCondition.wait(lock, [&] { return nextWrite == job.sequence; });
+        // A failed frame still takes its turn, so the workers behind it are not stuck waiting
+        if (encodedOk && stream.good()) {
+            if (config.format == Format::Y4m) {
+                if (!streamHeaderWritten) {
+                    stream << ImageWriter::getY4mHeader(streamExtent.width, streamExtent.height, config.frameRate);
+                    streamHeaderWritten = true;
+                }
+                stream << ImageWriter::getY4mFrameHeader();
+            }
+            stream.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            if (!stream.good()) {
+                setError("failed to write capture file: " + config.outputPath);
+            }
+        }
+        nextWrite++;
+        bool written = encodedOk && stream.good();
+        lock.unlock();
+        streamCondition.notify_all();
+        if (!written) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.writtenFrames++;
+}
+
+void FrameCapture::setError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error.empty()) {
+        std::cout << "Failed to capture frame - " << message << std::endl;
+        error = message;
+    }
+}
+
+// The header went out with the first frame, before the capture cadence was known. Frames are
+// captured as they are rendered, so the rate is the average interval between the recorded ones.
+void FrameCapture::finishY4mHeader() {
+    if (config.format != Format::Y4m || !streamHeaderWritten || stats.capturedFrames < 2) {
+        return;
+    }
+    double seconds = std::chrono::duration<double>(lastCaptureTime - firstCaptureTime).count();
+    if (seconds <= 0.0) {
+        return;
+    }
+    double frameRate = static_cast<double>(stats.capturedFrames - 1) / seconds;
+    stream.seekp(0);
+    stream << ImageWriter::getY4mHeader(streamExtent.width, streamExtent.height, frameRate);
+    std::cout << "Capture frame rate - " << frameRate << " fps" << std::endl;
+}
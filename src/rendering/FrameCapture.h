@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/VulkanDevice.h"
+#include "../resources/BufferManager.h"
+#include "FrameReadback.h"
+
+// Records rendered frames to disk without stalling the GPU. Each frame's color image is copied into
+// a FrameReadback ring from the frame's own command buffer; once the frame has completed, a few
+// frames later, the buffer is handed to worker threads that encode straight from the mapped memory
+// and release it again.
+//
+// The ring is the only queue: when every buffer is still waiting for an encoder, captureFrame blocks
+// until one is released, so a slow disk or encoder slows rendering down instead of growing memory
+// or dropping frames.
+class FrameCapture {
+    public:
+        enum class Format {
+            Png,    // numbered files in a directory, frame_000000.png ...
+            Raw,    // tightly packed RGBA8 frames in one file
+            Y4m     // YUV4MPEG2 4:2:0 video, e.g. ffmpeg -i capture.y4m capture.mp4
+        };
+
+        struct Config {
+            // Directory for Png, file otherwise
+            std::string outputPath;
+            Format format = Format::Png;
+            // Readback buffers; at least maxFramesInFlight + 1 so completed frames can always be
+            // collected while the others are in flight
+            uint32_t readbackDepth = 8;
+            uint32_t workerCount = 2;
+            // Written to the Y4M header until the stream closes, then replaced by the rate frames were
+            // captured at; only kept for captures of a single frame
+            double frameRate = 60.0;
+        };
+
+        struct Stats {
+            uint64_t capturedFrames = 0;
+            uint64_t writtenFrames = 0;
+            // Frames that did not match the stream's size, or found no buffer after an error
+            uint64_t skippedFrames = 0;
+            // Time captureFrame spent waiting for an encoder to release a buffer
+            double blockedMilliseconds = 0.0;
+        };
+
+        FrameCapture();
+        ~FrameCapture();
+
+        void initialize(const VulkanDevice& device, BufferManager& bufferManager, uint32_t maxFramesInFlight, const Config& config);
+        // Encodes every frame recorded so far, stops the workers and closes the output. The device
+        // must be idle.
+        void cleanup();
+
+        static bool isFormatSupported(VkFormat format) { return FrameReadback::isFormatSupported(format); }
+
+        // Hands the readbacks of frames [0, completedFrames) to the encoders. Call once per frame,
+        // before captureFrame.
+        void collect(uint64_t completedFrames);
+        // Records a copy of the image (see FrameReadback::copyImage) for frame `frame`. Returns false
+        // if the frame was skipped.
+        bool captureFrame(VkCommandBuffer commandBuffer, uint64_t frame, VkImage image, VkFormat format, VkExtent2D extent);
+
+        Stats getStats() const;
+        // First encoder or file error; capturing stops once one occurred
+        std::string getError() const;
+
+    private:
+        struct Job {
+            FrameReadback::Readback readback;
+            uint64_t sequence = 0;
+        };
+
+        Config config;
+        FrameReadback frameReadback;
+        uint64_t completedFrames = 0;
+        uint64_t nextSequence = 0;
+        // Every frame of a stream has the size of the first one
+        VkExtent2D streamExtent{};
+        // When the first and last recorded frames were captured, for the Y4M frame rate
+        std::chrono::steady_clock::time_point firstCaptureTime;
+        std::chrono::steady_clock::time_point lastCaptureTime;
+
+        mutable std::mutex mutex;
+        std::condition_variable queueCondition;
+        std::deque<Job> jobs;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+        Stats stats;
+        std::string error;
+
+        // Raw and Y4M frames are appended in sequence order, whichever worker finishes first
+        std::mutex streamMutex;
+        std::condition_variable streamCondition;
+        std::ofstream stream;
+        uint64_t nextWrite = 0;
+        bool streamHeaderWritten = false;
+
+        void workerLoop();
+        void encode(const FrameReadback::Readback& readback, std::vector<uint8_t>& encoded) const;
+        void writeFrame(const Job& job, const std::vector<uint8_t>& encoded, bool encodedOk);
+        void setError(const std::string& message);
+        void finishY4mHeader();
+};
@@ -0,0 +1,173 @@
+#include "FrameReadback.h"
+#include "../common/PixelConvert.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+FrameReadback::FrameReadback() {}
+
+FrameReadback::~FrameReadback() {
+    cleanup();
+}
+
+void FrameReadback::initialize(const VulkanDevice& device, BufferManager& bufferManager, uint32_t bufferCount) {
+    this->vulkanDevice = &device;
+    this->bufferManager = &bufferManager;
+    buffers.resize(std::max(bufferCount, 1u));
+
+    VkPhysicalDeviceMemoryProperties properties;
+    vkGetPhysicalDeviceMemoryProperties(device.getPhysicalDevice(), &properties);
+    memoryProperties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+        VkMemoryPropertyFlags cached = memoryProperties | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        if ((properties.memoryTypes[i].propertyFlags & cached) == cached) {
+            memoryProperties = cached;
+            break;
+        }
+    }
+}
+
+void FrameReadback::cleanup() {
+    if (vulkanDevice) {
+        for (Buffer& buffer : buffers) {
+            destroyBuffer(buffer);
+        }
+        buffers.clear();
+        vulkanDevice = nullptr;
+    }
+}
+
+bool FrameReadback::isFormatSupported(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool FrameReadback::copyImage(VkCommandBuffer commandBuffer, uint64_t frame, VkImage image, VkFormat format, VkExtent2D extent) {
+    if (!isFormatSupported(format)) {
+        throw std::runtime_error("unsupported readback format!");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto free = std::find_if(buffers.begin(), buffers.end(), [](const Buffer& buffer) { return buffer.state == State::Free; });
+    if (free == buffers.end()) {
+        return false;
+    }
+
+    // A free buffer is not used by the GPU or any reader, so it can be replaced when the size grew
+    Buffer& buffer = *free;
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    if (size > buffer.size) {
+        destroyBuffer(buffer);
+        bufferManager->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, memoryProperties, buffer.buffer, buffer.memory);
+        VkResult result = vkMapMemory(vulkanDevice->getLogicalDevice(), buffer.memory, 0, size, 0, &buffer.mapped);
+        if (result != VK_SUCCESS) {
+            std::cout << "Failed to map readback buffer - " << result << std::endl;
+            throw std::runtime_error("failed to map readback buffer!");
+        }
+        buffer.size = size;
+    }
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer.buffer, 1, &region);
+
+    // Makes the copy visible to host reads once the frame's fence has signaled
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer.buffer;
+    barrier.offset = 0;
+    barrier.size = size;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &barrier, 0, nullptr);
+
+    buffer.state = State::Recorded;
+    buffer.frame = frame;
+    buffer.format = format;
+    buffer.extent = extent;
+    return true;
+}
+
+bool FrameReadback::waitForFreeBuffer() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto hasState = [this](State state) {
+        return std::any_of(buffers.begin(), buffers.end(), [state](const Buffer& buffer) { return buffer.state == state; });
+    };
+    releasedCondition.wait(lock, [&] { return hasState(State::Free) || !hasState(State::Acquired); });
+    return hasState(State::Free);
+}
+
+bool FrameReadback::acquire(uint64_t completedFrames, Readback& readback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Buffer* oldest = nullptr;
+    for (Buffer& buffer : buffers) {
+        if (buffer.state == State::Recorded && buffer.frame < completedFrames && (!oldest || buffer.frame < oldest->frame)) {
+            oldest = &buffer;
+        }
+    }
+    if (!oldest) {
+        return false;
+    }
+
+    oldest->state = State::Acquired;
+    readback.buffer = static_cast<uint32_t>(oldest - buffers.data());
+    readback.frame = oldest->frame;
+    readback.data = static_cast<const uint8_t*>(oldest->mapped);
+    readback.format = oldest->format;
+    readback.extent = oldest->extent;
+    return true;
+}
+
+void FrameReadback::release(uint32_t buffer) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers[buffer].state = State::Free;
+    }
+    releasedCondition.notify_all();
+}
+
+bool FrameReadback::readImage(uint64_t completedFrames, ImageRgba8& image) {
+    Readback readback;
+    if (!acquire(completedFrames, readback)) {
+        return false;
+    }
+
+    image.width = readback.extent.width;
+    image.height = readback.extent.height;
+    size_t pixelCount = static_cast<size_t>(readback.extent.width) * readback.extent.height;
+    image.pixels.resize(pixelCount * 4);
+    if (readback.isBgra()) {
+        PixelConvert::swapRedBlue(readback.data, image.pixels.data(), pixelCount);
+    } else {
+        std::memcpy(image.pixels.data(), readback.data, image.pixels.size());
+    }
+
+    release(readback.buffer);
+    return true;
+}
+
+void FrameReadback::destroyBuffer(Buffer& buffer) {
+    if (buffer.mapped) {
+        vkUnmapMemory(vulkanDevice->getLogicalDevice(), buffer.memory);
+        buffer.mapped = nullptr;
+    }
+    if (buffer.buffer != VK_NULL_HANDLE) {
+        bufferManager->destroyBuffer(buffer.buffer, buffer.memory);
+    }
+    buffer.size = 0;
+    buffer.state = State::Free;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "../core/VulkanDevice.h"
+#include "../resources/BufferManager.h"
+#include "../common/ImageTypes.h"
+
+// Ring of persistently mapped host visible buffers that color images are copied into from the
+// frame's own command buffer, so nothing waits for the GPU. Each copy is tagged with the number
+// of the frame that recorded it and can be read once that frame has completed, i.e. several
+// frames later (see VulkanApplication::getCompletedFrameCount).
+//
+// Buffers are acquired by the reader and stay reserved until released, which may happen on
+// another thread: encoders can read the mapped memory directly instead of a copy of it.
+class FrameReadback {
+    public:
+        struct Readback {
+            uint32_t buffer = 0;
+            uint64_t frame = 0;
+            const uint8_t* data = nullptr;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent{};
+
+            // BGRA byte order, otherwise RGBA
+            bool isBgra() const { return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB; }
+        };
+
+        FrameReadback();
+        ~FrameReadback();
+
+        void initialize(const VulkanDevice& device, BufferManager& bufferManager, uint32_t bufferCount);
+        // The device must be idle and every buffer released
+        void cleanup();
+
+        // 8-bit RGBA and BGRA formats, the ones swapchains use
+        static bool isFormatSupported(VkFormat format);
+
+        // Records a copy of the image, which must be in TRANSFER_SRC_OPTIMAL (e.g. read by a render
+        // graph pass with ResourceUsage::TransferSrc) and have TRANSFER_SRC usage. Returns false
+        // without recording anything when every buffer holds a copy that was not released yet.
+        bool copyImage(VkCommandBuffer commandBuffer, uint64_t frame, VkImage image, VkFormat format, VkExtent2D extent);
+        // Blocks until a buffer is free; false right away if none can become free without more
+        // frames completing, i.e. when no buffer is held by a reader
+        bool waitForFreeBuffer();
+
+        // Oldest copy recorded by one of the first completedFrames frames. The buffer stays reserved
+        // until release().
+        bool acquire(uint64_t completedFrames, Readback& readback);
+        // Thread safe
+        void release(uint32_t buffer);
+
+        // acquire() converted to RGBA, then release()
+        bool readImage(uint64_t completedFrames, ImageRgba8& image);
+
+    private:
+        enum class State {
+            Free,
+            Recorded,   // copy recorded, frame may still be running
+            Acquired
+        };
+
+        struct Buffer {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            void* mapped = nullptr;
+            VkDeviceSize size = 0;
+            State state = State::Free;
+            uint64_t frame = 0;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent{};
+        };
+
+        const VulkanDevice* vulkanDevice = nullptr;
+        BufferManager* bufferManager = nullptr;
+        // Host cached when the device has it: uncached reads are slow on discrete GPUs
+        VkMemoryPropertyFlags memoryProperties = 0;
+
+        std::mutex mutex;
+        std::condition_variable releasedCondition;
+        std::vector<Buffer> buffers;
+
+        void destroyBuffer(Buffer& buffer);
+};
@@ -0,0 +1,84 @@
+#include "GpuTimer.h"
+#include <iostream>
+#include <stdexcept>
+
+GpuTimer::GpuTimer() {}
+
+GpuTimer::~GpuTimer() {
+    cleanup();
+}
+
+void GpuTimer::initialize(const VulkanDevice& device, uint32_t maxFramesInFlight, uint32_t scopeCount) {
+    this->vulkanDevice = &device;
+    this->scopeCount = scopeCount;
+    recorded.assign(maxFramesInFlight * scopeCount, false);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device.getPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device.getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+    uint32_t validBits = queueFamilies[device.findQueueFamilies(device.getPhysicalDevice()).graphicsFamily.value()].timestampValidBits;
+
+    if (validBits == 0 || properties.limits.timestampPeriod == 0.0f) {
+        std::cout << "GPU timestamps not supported on the graphics queue" << std::endl;
+        return;
+    }
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * maxFramesInFlight * scopeCount;
+
+    VkResult result = vkCreateQueryPool(device.getLogicalDevice(), &queryPoolInfo, nullptr, &queryPool);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to create timestamp query pool - " << result << std::endl;
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+}
+
+void GpuTimer::cleanup() {
+    if (vulkanDevice) {
+        vkDestroyQueryPool(vulkanDevice->getLogicalDevice(), queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+        vulkanDevice = nullptr;
+    }
+}
+
+void GpuTimer::begin(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t scope) {
+    if (!isSupported()) {
+        return;
+    }
+    uint32_t firstQuery = getFirstQuery(currentFrame, scope);
+    vkCmdResetQueryPool(commandBuffer, queryPool, firstQuery, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, firstQuery);
+}
+
+void GpuTimer::end(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t scope) {
+    if (!isSupported()) {
+        return;
+    }
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, getFirstQuery(currentFrame, scope) + 1);
+    recorded[currentFrame * scopeCount + scope] = true;
+}
+
+bool GpuTimer::getFrameTime(uint32_t currentFrame, double& milliseconds, uint32_t scope) const {
+    if (!isSupported() || !recorded[currentFrame * scopeCount + scope]) {
+        return false;
+    }
+
+    uint64_t timestamps[2];
+    VkResult result = vkGetQueryPoolResults(vulkanDevice->getLogicalDevice(), queryPool, getFirstQuery(currentFrame, scope), 2,
+                                            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return false;
+    }
+
+    uint64_t ticks = ((timestamps[1] & timestampMask) - (timestamps[0] & timestampMask)) & timestampMask;
+    milliseconds = static_cast<double>(ticks) * timestampPeriod * 1e-6;
+    return true;
+}
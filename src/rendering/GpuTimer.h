@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+#include "../core/VulkanDevice.h"
+
+// GPU time of whole frames from a pair of timestamp queries per frame in flight. Results are read
+// back without waiting: a slot's time becomes available once the fence of the frame that last used
+// it has signaled, i.e. maxFramesInFlight frames later. Each slot can hold several scopes, e.g. one
+// per render graph pass; scope 0 is the whole frame for the single scope case.
+class GpuTimer {
+    public:
+        GpuTimer();
+        ~GpuTimer();
+
+        void initialize(const VulkanDevice& device, uint32_t maxFramesInFlight, uint32_t scopeCount = 1);
+        void cleanup();
+
+        // False when the graphics queue cannot write timestamps; begin/end then record nothing
+        bool isSupported() const { return queryPool != VK_NULL_HANDLE; }
+
+        uint32_t getScopeCount() const { return scopeCount; }
+
+        // Record around the timed commands (for scope 0 the start and end of the frame's command
+        // buffer), outside of any render pass
+        void begin(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t scope = 0);
+        void end(VkCommandBuffer commandBuffer, uint32_t currentFrame, uint32_t scope = 0);
+
+        // Duration of the scope in the last frame recorded into this slot. Call after its fence was
+        // waited on and before begin() reuses the slot; false if there is no result yet.
+        bool getFrameTime(uint32_t currentFrame, double& milliseconds, uint32_t scope = 0) const;
+
+    private:
+        const VulkanDevice* vulkanDevice = nullptr;
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        // Nanoseconds per timestamp tick
+        double timestampPeriod = 1.0;
+        uint64_t timestampMask = ~0ull;
+        uint32_t scopeCount = 1;
+        // Per slot and scope
+        std::vector<bool> recorded;
+
+        uint32_t getFirstQuery(uint32_t currentFrame, uint32_t scope) const { return 2 * (currentFrame * scopeCount + scope); }
+};
@@ -0,0 +1,423 @@
+#include "PipelineManager.h"
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <functional>
+#include "../common/FileUtils.h"
+#include "../common/Hash.h"
+#include "../common/UniformTypes.h"
+#include "../descriptors/ShaderReflection.h"
+
+bool PipelineKey::operator==(const PipelineKey& other) const {
+    return vertexShader == other.vertexShader && fragmentShader == other.fragmentShader &&
+           vertexFormat == other.vertexFormat && renderPass == other.renderPass &&
+           colorFormat == other.colorFormat && depthFormat == other.depthFormat && layout == other.layout &&
+           state == other.state;
+}
+
+size_t PipelineKeyHash::operator()(const PipelineKey& key) const {
+    size_t seed = std::hash<std::string>()(key.vertexShader);
+    hashCombine(seed, std::hash<std::string>()(key.fragmentShader));
+    hashCombine(seed, static_cast<size_t>(key.vertexFormat));
+    hashCombine(seed, std::hash<VkRenderPass>()(key.renderPass));
+    hashCombine(seed, static_cast<size_t>(key.colorFormat));
+    hashCombine(seed, static_cast<size_t>(key.depthFormat));
+    hashCombine(seed, std::hash<VkPipelineLayout>()(key.layout));
+    hashCombine(seed, key.state.hash());
+    return seed;
+}
+
+PipelineManager::PipelineManager() {}
+
+PipelineManager::~PipelineManager() {
+    cleanup();
+}
+
+void PipelineManager::initialize(const VulkanDevice& device, LayoutCache& layoutCache, uint32_t workerCount) {
+    this->vulkanDevice = &device;
+    this->layoutCache = &layoutCache;
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    VkResult result = vkCreatePipelineCache(vulkanDevice->getLogicalDevice(), &cacheInfo, nullptr, &pipelineCache);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to create pipeline cache - " << result << std::endl;
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    stopping = false;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&PipelineManager::workerLoop, this);
+    }
+    std::cout << "Successfully created pipeline manager - " << workerCount << " workers" << std::endl;
+}
+
+void PipelineManager::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        buildQueue.clear();
+    }
+    queueCondition.notify_all();
+    builtCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    if (vulkanDevice) {
+        for (auto& entry : pipelines) {
+            vkDestroyPipeline(vulkanDevice->getLogicalDevice(), entry.second.pipeline, nullptr);
+        }
+        vkDestroyPipelineCache(vulkanDevice->getLogicalDevice(), pipelineCache, nullptr);
+        pipelineCache = VK_NULL_HANDLE;
+        vulkanDevice = nullptr;
+    }
+    pipelines.clear();
+}
+
+VkPipeline PipelineManager::getPipeline(const PipelineKey& key) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = pipelines.find(key);
+        if (it == pipelines.end()) {
+            // Claim the key so a concurrent request waits instead of building it twice
+            pipelines[key].pending = true;
+        } else {
+            builtCondition.wait(lock, [&] {
+                it = pipelines.find(key);
+                return it == pipelines.end() || !it->second.pending || stopping;
+            });
+            return it != pipelines.end() ? it->second.pipeline : VK_NULL_HANDLE;
+        }
+    }
+
+    buildVariant(key);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pipelines.find(key);
+    return it != pipelines.end() ? it->second.pipeline : VK_NULL_HANDLE;
+}
+
+VkPipeline PipelineManager::requestPipeline(const PipelineKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pipelines.find(key);
+    if (it != pipelines.end()) {
+        return it->second.pipeline;
+    }
+
+    pipelines[key].pending = true;
+    buildQueue.push_back(key);
+    queueCondition.notify_one();
+    return VK_NULL_HANDLE;
+}
+
+void PipelineManager::releaseRenderPass(VkRenderPass renderPass) {
+    if (renderPass == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // Queued builds have not started, so they can be dropped with their entries
+    for (auto it = buildQueue.begin(); it != buildQueue.end();) {
+        if (it->renderPass == renderPass) {
+            pipelines.erase(*it);
+            it = buildQueue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    builtCondition.notify_all();
+    builtCondition.wait(lock, [&] {
+        for (const auto& entry : pipelines) {
+            if (entry.first.renderPass == renderPass && entry.second.pending) {
+                return stopping;
+            }
+        }
+        return true;
+    });
+
+    for (auto it = pipelines.begin(); it != pipelines.end();) {
+        if (it->first.renderPass == renderPass && !it->second.pending) {
+            vkDestroyPipeline(vulkanDevice->getLogicalDevice(), it->second.pipeline, nullptr);
+            it = pipelines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<VkPipeline> PipelineManager::invalidateShader(const std::string& path) {
+    auto usesShader = [&](const PipelineKey& key) { return key.vertexShader == path || key.fragmentShader == path; };
+
+    std::vector<VkPipeline> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = buildQueue.begin(); it != buildQueue.end();) {
+            if (usesShader(*it)) {
+                pipelines.erase(*it);
+                it = buildQueue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto it = pipelines.begin(); it != pipelines.end();) {
+            if (!usesShader(it->first)) {
+                ++it;
+            } else if (it->second.pending) {
+                it->second.stale = true;
+                ++it;
+            } else {
+                if (it->second.pipeline != VK_NULL_HANDLE) {
+                    removed.push_back(it->second.pipeline);
+                }
+                it = pipelines.erase(it);
+            }
+        }
+    }
+    // Waiters on dropped queued builds fall back to VK_NULL_HANDLE
+    builtCondition.notify_all();
+    return removed;
+}
+
+size_t PipelineManager::getPipelineCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& entry : pipelines) {
+        count += entry.second.pipeline != VK_NULL_HANDLE ? 1 : 0;
+    }
+    return count;
+}
+
+void PipelineManager::workerLoop() {
+    while (true) {
+        PipelineKey key;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueCondition.wait(lock, [this] { return stopping || !buildQueue.empty(); });
+            if (stopping) {
+                return;
+            }
+            key = std::move(buildQueue.front());
+            buildQueue.pop_front();
+        }
+        buildVariant(key);
+    }
+}
+
+void PipelineManager::buildVariant(const PipelineKey& key) {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = VK_ERROR_INITIALIZATION_FAILED;
+    try {
+        auto vertShaderCode = readFile(key.vertexShader);
+        std::vector<char> fragShaderCode;
+        if (!key.fragmentShader.empty()) {
+            fragShaderCode = readFile(key.fragmentShader);
+        }
+        VkPipelineLayout pipelineLayout = key.layout;
+        if (pipelineLayout == VK_NULL_HANDLE) {
+            pipelineLayout = reflectLayouts(key.vertexFormat, vertShaderCode, fragShaderCode).pipelineLayout;
+        }
+        result = createPipeline(key, vertShaderCode, fragShaderCode, pipelineLayout, pipeline);
+    } catch (const std::exception& e) {
+        std::cout << "Failed to build pipeline variant - " << e.what() << std::endl;
+    }
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to build pipeline variant - " << result << std::endl;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = pipelines[key];
+        if (entry.stale) {
+            // Never handed out, so nothing can be using it yet
+            vkDestroyPipeline(vulkanDevice->getLogicalDevice(), pipeline, nullptr);
+            pipelines.erase(key);
+        } else {
+            entry.pipeline = result == VK_SUCCESS ? pipeline : VK_NULL_HANDLE;
+            entry.pending = false;
+        }
+    }
+    builtCondition.notify_all();
+}
+
+LayoutCache::PipelineLayoutInfo PipelineManager::reflectLayouts(VertexFormat vertexFormat, const std::vector<char>& vertShaderCode,
+                                                                const std::vector<char>& fragShaderCode) const {
+    ShaderReflection vertexReflection = ShaderReflection::reflect(vertShaderCode);
+    ShaderReflection reflection = fragShaderCode.empty()
+                                      ? vertexReflection
+                                      : ShaderReflection::merge({vertexReflection, ShaderReflection::reflect(fragShaderCode)});
+
+    // The CPU side structs are not generated, so report when they drift from the shaders
+    for (const ReflectedBinding& binding : reflection.bindings) {
+        if (binding.set == 0 && binding.binding == 0 && binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER &&
+            binding.size != sizeof(UniformBufferObject)) {
+            std::cout << "Warning: shader uniform block '" << binding.name << "' is " << binding.size
+                      << " bytes, UniformBufferObject is " << sizeof(UniformBufferObject) << std::endl;
+        }
+    }
+    for (const VkPushConstantRange& range : reflection.pushConstantRanges) {
+        if (range.offset + range.size > sizeof(DrawPushConstants)) {
+            std::cout << "Warning: shader push constants end at " << range.offset + range.size
+                      << " bytes, DrawPushConstants is " << sizeof(DrawPushConstants) << std::endl;
+        }
+    }
+    auto attributeDescriptions = getAttributeDescriptions(vertexFormat);
+    for (const ReflectedVertexInput& input : vertexReflection.vertexInputs) {
+        bool found = false;
+        for (const VkVertexInputAttributeDescription& attribute : attributeDescriptions) {
+            found = found || attribute.location == input.location;
+        }
+        if (!found) {
+            std::cout << "Warning: vertex input '" << input.name << "' at location " << input.location
+                      << " has no matching vertex attribute" << std::endl;
+        }
+    }
+
+    return layoutCache->getLayouts(reflection);
+}
+
+VkResult PipelineManager::createPipeline(const PipelineKey& key, const std::vector<char>& vertShaderCode,
+                                         const std::vector<char>& fragShaderCode, VkPipelineLayout pipelineLayout,
+                                         VkPipeline& pipeline) const {
+    const PipelineState& state = key.state;
+    bool depthOnly = fragShaderCode.empty();
+
+    auto createShaderModule = [this](const std::vector<char>& code, VkShaderModule& shaderModule) {
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+        return vkCreateShaderModule(vulkanDevice->getLogicalDevice(), &createInfo, nullptr, &shaderModule);
+    };
+
+    VkShaderModule vertShaderModule = VK_NULL_HANDLE;
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    VkResult moduleResult = createShaderModule(vertShaderCode, vertShaderModule);
+    if (moduleResult == VK_SUCCESS && !depthOnly) {
+        moduleResult = createShaderModule(fragShaderCode, fragShaderModule);
+    }
+    if (moduleResult != VK_SUCCESS) {
+        vkDestroyShaderModule(vulkanDevice->getLogicalDevice(), vertShaderModule, nullptr);
+        return moduleResult;
+    }
+
+    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module = vertShaderModule;
+    vertShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragShaderStageInfo.module = fragShaderModule;
+    fragShaderStageInfo.pName = "main";
+
+    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
+
+    auto bindingDescription = getBindingDescription(key.vertexFormat);
+    auto attributeDescriptions = getAttributeDescriptions(key.vertexFormat);
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = state.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    std::vector<VkDynamicState> dynamicStates = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    // Viewport and scissor are set when recording
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = state.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = state.cullMode;
+    rasterizer.frontFace = state.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = state.rasterizationSamples;
+    multisampling.minSampleShading = 1.0f;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = state.blendEnable;
+    colorBlendAttachment.srcColorBlendFactor = state.srcColorBlendFactor;
+    colorBlendAttachment.dstColorBlendFactor = state.dstColorBlendFactor;
+    colorBlendAttachment.colorBlendOp = state.colorBlendOp;
+    colorBlendAttachment.srcAlphaBlendFactor = state.srcAlphaBlendFactor;
+    colorBlendAttachment.dstAlphaBlendFactor = state.dstAlphaBlendFactor;
+    colorBlendAttachment.alphaBlendOp = state.alphaBlendOp;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = depthOnly ? 0 : 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = state.depthTestEnable;
+    depthStencil.depthWriteEnable = state.depthWriteEnable;
+    depthStencil.depthCompareOp = state.depthCompareOp;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.minDepthBounds = 0.0f;
+    depthStencil.maxDepthBounds = 1.0f;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
+    VkPipelineRenderingCreateInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.colorAttachmentCount = depthOnly || key.colorFormat == VK_FORMAT_UNDEFINED ? 0 : 1;
+    renderingInfo.pColorAttachmentFormats = &key.colorFormat;
+    renderingInfo.depthAttachmentFormat = key.depthFormat;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = key.renderPass == VK_NULL_HANDLE ? &renderingInfo : nullptr;
+    pipelineInfo.stageCount = depthOnly ? 1 : 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.renderPass = key.renderPass;
+    pipelineInfo.subpass = 0;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkResult result = vkCreateGraphicsPipelines(vulkanDevice->getLogicalDevice(), pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+
+    vkDestroyShaderModule(vulkanDevice->getLogicalDevice(), fragShaderModule, nullptr);
+    vkDestroyShaderModule(vulkanDevice->getLogicalDevice(), vertShaderModule, nullptr);
+    return result;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../core/VulkanDevice.h"
+#include "../common/VertexTypes.h"
+#include "../descriptors/LayoutCache.h"
+#include "PipelineState.h"
+
+// Everything a graphics pipeline is built from
+struct PipelineKey {
+    std::string vertexShader;    // SPIR-V paths
+    // Empty for depth-only pipelines, which have no fragment stage and no color attachments
+    std::string fragmentShader;
+    VertexFormat vertexFormat = VertexFormat::Standard;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    // Attachment formats for dynamic rendering, used when renderPass is VK_NULL_HANDLE
+    VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    // Used instead of the reflected layout when set, so a pipeline whose shaders use a subset of
+    // another's resources can share its descriptor sets and push constants
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    PipelineState state;
+
+    bool operator==(const PipelineKey& other) const;
+};
+
+struct PipelineKeyHash {
+    size_t operator()(const PipelineKey& key) const;
+};
+
+// Builds graphics pipelines from PipelineKeys and keeps one pipeline per unique key, so materials
+// that only differ in state share variants instead of each creating their own. Missing variants can
+// be compiled on worker threads; all builds go through one VkPipelineCache.
+class PipelineManager {
+    public:
+        PipelineManager();
+        ~PipelineManager();
+
+        void initialize(const VulkanDevice& device, LayoutCache& layoutCache, uint32_t workerCount = 2);
+        // Stops the workers and destroys every cached pipeline. The device must be idle.
+        void cleanup();
+
+        // Returns the pipeline for `key`, building it on the calling thread if needed
+        VkPipeline getPipeline(const PipelineKey& key);
+        // Returns the pipeline for `key` if it is ready, otherwise queues it for a worker and
+        // returns VK_NULL_HANDLE so the caller can fall back for this frame. A variant that failed to
+        // build is not retried until invalidateShader() drops it.
+        VkPipeline requestPipeline(const PipelineKey& key);
+        size_t getPipelineCount() const;
+        // Drops queued builds for renderPass, waits for the ones in flight and destroys its cached
+        // pipelines, so the render pass can be destroyed and its handle reused. The device must be idle.
+        void releaseRenderPass(VkRenderPass renderPass);
+        // Drops every variant built from the SPIR-V at path, e.g. after a hot reload replaced it, so
+        // the next request rebuilds it. Builds in flight are discarded when they finish. Returns the
+        // removed pipelines for the caller to destroy once no frame in flight uses them.
+        std::vector<VkPipeline> invalidateShader(const std::string& path);
+
+        // Reflects both stages (fragShaderCode may be empty), checks them against the CPU side vertex
+        // and uniform structs and returns the cached layouts of the merged interface
+        LayoutCache::PipelineLayoutInfo reflectLayouts(VertexFormat vertexFormat, const std::vector<char>& vertShaderCode,
+                                                       const std::vector<char>& fragShaderCode) const;
+        // Creates an uncached pipeline, without a fragment stage if fragShaderCode is empty. Thread safe.
+        VkResult createPipeline(const PipelineKey& key, const std::vector<char>& vertShaderCode,
+                                const std::vector<char>& fragShaderCode, VkPipelineLayout pipelineLayout,
+                                VkPipeline& pipeline) const;
+
+    private:
+        struct Entry {
+            // VK_NULL_HANDLE once built if the build failed; the entry stays so the variant is not
+            // rebuilt every frame while its inputs are unchanged
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            bool pending = false;
+            // Invalidated while building, the result is thrown away
+            bool stale = false;
+        };
+
+        const VulkanDevice* vulkanDevice = nullptr;
+        LayoutCache* layoutCache = nullptr;
+        VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+
+        mutable std::mutex mutex;
+        std::condition_variable queueCondition;
+        std::condition_variable builtCondition;
+        std::unordered_map<PipelineKey, Entry, PipelineKeyHash> pipelines;
+        std::deque<PipelineKey> buildQueue;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+
+        void workerLoop();
+        // Builds the variant and publishes it in `pipelines`, marking the entry failed on error
+        void buildVariant(const PipelineKey& key);
+};
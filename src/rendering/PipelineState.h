@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include "../common/Hash.h"
+
+// Fixed-function state of a graphics pipeline. Viewport and scissor are always dynamic, so a
+// state (and the pipelines built from it) does not depend on the swapchain extent.
+struct PipelineState {
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    VkBool32 depthTestEnable = VK_TRUE;
+    VkBool32 depthWriteEnable = VK_TRUE;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkBool32 blendEnable = VK_FALSE;
+    VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+    VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkSampleCountFlagBits rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Straight alpha blending; blended surfaces test against depth but do not write it
+    void setAlphaBlend() {
+        blendEnable = VK_TRUE;
+        srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendOp = VK_BLEND_OP_ADD;
+        srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        alphaBlendOp = VK_BLEND_OP_ADD;
+        depthWriteEnable = VK_FALSE;
+    }
+
+    bool operator==(const PipelineState& other) const {
+        return topology == other.topology && polygonMode == other.polygonMode &&
+               cullMode == other.cullMode && frontFace == other.frontFace &&
+               depthTestEnable == other.depthTestEnable && depthWriteEnable == other.depthWriteEnable &&
+               depthCompareOp == other.depthCompareOp && blendEnable == other.blendEnable &&
+               srcColorBlendFactor == other.srcColorBlendFactor && dstColorBlendFactor == other.dstColorBlendFactor &&
+               colorBlendOp == other.colorBlendOp && srcAlphaBlendFactor == other.srcAlphaBlendFactor &&
+               dstAlphaBlendFactor == other.dstAlphaBlendFactor && alphaBlendOp == other.alphaBlendOp &&
+               rasterizationSamples == other.rasterizationSamples;
+    }
+    bool operator!=(const PipelineState& other) const {
+        return !(*this == other);
+    }
+
+    size_t hash() const {
+        size_t seed = 0;
+        hashCombine(seed, topology);
+        hashCombine(seed, polygonMode);
+        hashCombine(seed, cullMode);
+        hashCombine(seed, frontFace);
+        hashCombine(seed, depthTestEnable);
+        hashCombine(seed, depthWriteEnable);
+        hashCombine(seed, depthCompareOp);
+        hashCombine(seed, blendEnable);
+        hashCombine(seed, srcColorBlendFactor);
+        hashCombine(seed, dstColorBlendFactor);
+        hashCombine(seed, colorBlendOp);
+        hashCombine(seed, srcAlphaBlendFactor);
+        hashCombine(seed, dstAlphaBlendFactor);
+        hashCombine(seed, alphaBlendOp);
+        hashCombine(seed, rasterizationSamples);
+        return seed;
+    }
+};
@@ -0,0 +1,972 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+void RenderGraph::PassBuilder::writeColor(ResourceHandle resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearValue) {
+    Access access{resource, ResourceUsage::ColorAttachment, true, loadOp, {}};
+    access.clearValue.color = clearValue;
+    accesses.push_back(access);
+}
+
+void RenderGraph::PassBuilder::writeDepth(ResourceHandle resource, VkAttachmentLoadOp loadOp, float clearDepth) {
+    Access access{resource, ResourceUsage::DepthAttachment, true, loadOp, {}};
+    access.clearValue.depthStencil = {clearDepth, 0};
+    accesses.push_back(access);
+}
+
+void RenderGraph::PassBuilder::resolveColor(ResourceHandle source, ResourceHandle destination) {
+    Access access{destination, ResourceUsage::ColorAttachment, true, VK_ATTACHMENT_LOAD_OP_DONT_CARE, {}};
+    access.resolveSource = source;
+    accesses.push_back(access);
+}
+
+void RenderGraph::PassBuilder::readDepth(ResourceHandle resource) {
+    accesses.push_back({resource, ResourceUsage::DepthAttachmentRead, false, VK_ATTACHMENT_LOAD_OP_LOAD, {}});
+}
+
+void RenderGraph::PassBuilder::read(ResourceHandle resource, ResourceUsage usage) {
+    accesses.push_back({resource, usage, false, VK_ATTACHMENT_LOAD_OP_LOAD, {}});
+}
+
+void RenderGraph::PassBuilder::write(ResourceHandle resource, ResourceUsage usage) {
+    // Shader and transfer writes may be partial, so they keep earlier contents alive
+    accesses.push_back({resource, usage, true, VK_ATTACHMENT_LOAD_OP_LOAD, {}});
+}
+
+RenderGraph::RenderGraph() {}
+
+RenderGraph::~RenderGraph() {
+    cleanup();
+}
+
+void RenderGraph::initialize(const VulkanDevice& device) {
+    vulkanDevice = &device;
+    dynamicRendering = device.isDynamicRenderingEnabled();
+}
+
+void RenderGraph::cleanup() {
+    if (vulkanDevice) {
+        destroyCompiledObjects();
+    }
+    resources.clear();
+    passes.clear();
+    passTimer.reset();
+    vulkanDevice = nullptr;
+}
+
+void RenderGraph::reset() {
+    if (vulkanDevice) {
+        destroyCompiledObjects();
+    }
+    resources.clear();
+    passes.clear();
+    passTimer.reset();
+}
+
+void RenderGraph::setPassTimingEnabled(bool enable, uint32_t maxFramesInFlight) {
+    passTiming = enable;
+    if (passTimingFrames != maxFramesInFlight) {
+        // Only reached with a different frame count, i.e. while nothing is in flight
+        passTimingFrames = maxFramesInFlight;
+        passTimer.reset();
+    }
+}
+
+bool RenderGraph::getPassTime(uint32_t passIndex, uint32_t frameIndex, double& milliseconds) const {
+    if (!passTiming || !passTimer || passIndex >= passTimer->getScopeCount() || passes[passIndex].culled) {
+        return false;
+    }
+    return passTimer->getFrameTime(frameIndex, milliseconds, passIndex);
+}
+
+void RenderGraph::destroyCompiledObjects() {
+    VkDevice device = vulkanDevice->getLogicalDevice();
+    for (Pass& pass : passes) {
+        for (VkFramebuffer framebuffer : pass.framebuffers) {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+        pass.framebuffers.clear();
+        vkDestroyRenderPass(device, pass.renderPass, nullptr);
+        pass.renderPass = VK_NULL_HANDLE;
+        pass.attachments.clear();
+    }
+    for (Resource& resource : resources) {
+        if (resource.type == ResourceType::TransientImage) {
+            vkDestroyImageView(device, resource.view, nullptr);
+            vkDestroyImage(device, resource.image, nullptr);
+            resource.view = VK_NULL_HANDLE;
+            resource.image = VK_NULL_HANDLE;
+        }
+    }
+    for (MemoryBlock& block : memoryBlocks) {
+        vkFreeMemory(device, block.memory, nullptr);
+    }
+    memoryBlocks.clear();
+    transientBytesRequested = 0;
+    transientBytesAllocated = 0;
+    lazilyAllocatedBytes = 0;
+    compiled = false;
+}
+
+RenderGraph::ResourceHandle RenderGraph::createImage(const std::string& name, const ImageDesc& desc) {
+    Resource resource;
+    resource.name = name;
+    resource.type = ResourceType::TransientImage;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importImage(const std::string& name, const ImportedImage& image) {
+    if (image.images.empty() || image.images.size() != image.views.size()) {
+        throw std::invalid_argument("imported image " + name + " needs one view per image");
+    }
+    Resource resource;
+    resource.name = name;
+    resource.type = ResourceType::ImportedImage;
+    resource.imported = image;
+    resource.desc.format = image.format;
+    resource.desc.extent = image.extent;
+    resources.push_back(resource);
+    return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importBuffers(const std::string& name, const std::vector<VkBuffer>& buffers) {
+    if (buffers.empty()) {
+        throw std::invalid_argument("imported buffer " + name + " is empty");
+    }
+    Resource resource;
+    resource.name = name;
+    resource.type = ResourceType::ImportedBuffer;
+    resource.buffers = buffers;
+    resources.push_back(resource);
+    return static_cast<ResourceHandle>(resources.size() - 1);
+}
+
+void RenderGraph::addPass(const std::string& name, const SetupCallback& setup, const ExecuteCallback& execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    setup(pass.builder);
+    for (const PassBuilder::Access& access : pass.builder.accesses) {
+        if (access.resource >= resources.size()) {
+            throw std::invalid_argument("pass " + name + " uses an unknown resource");
+        }
+    }
+    passes.push_back(std::move(pass));
+}
+
+void RenderGraph::compile() {
+    destroyCompiledObjects();
+
+    cullPasses();
+    computeLifetimes();
+    createTransientImages();
+    createRenderPasses();
+    compiled = true;
+
+    std::cout << "Successfully compiled render graph - " << passes.size() - getCulledPassCount() << "/" << passes.size()
+              << " passes, transient memory " << transientBytesAllocated / 1024 << " KiB (" << transientBytesRequested / 1024
+              << " KiB unaliased, " << lazilyAllocatedBytes / 1024 << " KiB lazily allocated)" << std::endl;
+}
+
+void RenderGraph::cullPasses() {
+    // Walk backwards from the externally visible results: a pass survives if it writes something
+    // a surviving later pass reads, or an imported resource nobody overwrites afterwards
+    std::vector<bool> needed(resources.size(), false);
+    for (const Pass& pass : passes) {
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            if (access.write && resources[access.resource].type != ResourceType::TransientImage) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+
+    for (size_t i = passes.size(); i-- > 0;) {
+        Pass& pass = passes[i];
+        bool live = pass.builder.sideEffect;
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            live = live || (access.write && needed[access.resource]);
+        }
+        pass.culled = !live;
+        if (!live) {
+            continue;
+        }
+
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            bool overwrites = access.write && isAttachment(access.usage) && access.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD;
+            if (overwrites) {
+                needed[access.resource] = false;
+            }
+        }
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            bool overwrites = access.write && isAttachment(access.usage) && access.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD;
+            if (!overwrites) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes() {
+    for (Resource& resource : resources) {
+        resource.usage = resource.desc.extraUsage;
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.state = ResourceState{};
+        if (resource.type != ResourceType::ImportedBuffer) {
+            resource.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            if (isDepthFormat(resource.desc.format)) {
+                resource.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+                if (resource.desc.format == VK_FORMAT_D32_SFLOAT_S8_UINT || resource.desc.format == VK_FORMAT_D24_UNORM_S8_UINT) {
+                    resource.aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+                }
+            }
+        }
+    }
+
+    std::vector<bool> attachmentOnly(resources.size(), true);
+    for (uint32_t i = 0; i < passes.size(); i++) {
+        if (passes[i].culled) {
+            continue;
+        }
+        for (const PassBuilder::Access& access : passes[i].builder.accesses) {
+            Resource& resource = resources[access.resource];
+            resource.usage |= getImageUsage(access.usage);
+            resource.firstPass = std::min(resource.firstPass, i);
+            resource.lastPass = std::max(resource.lastPass, i);
+            if (!isAttachment(access.usage) || access.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD) {
+                attachmentOnly[access.resource] = false;
+            }
+        }
+    }
+
+    // Written and consumed inside one pass: load is CLEAR/DONT_CARE and the store is DONT_CARE
+    const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+                                              VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    for (ResourceHandle handle = 0; handle < resources.size(); handle++) {
+        Resource& resource = resources[handle];
+        resource.transientAttachment = resource.type == ResourceType::TransientImage && resource.firstPass != UINT32_MAX &&
+                                       resource.firstPass == resource.lastPass && attachmentOnly[handle] &&
+                                       (resource.usage & ~attachmentUsage) == 0;
+        if (resource.transientAttachment) {
+            resource.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+    }
+}
+
+void RenderGraph::createTransientImages() {
+    VkDevice device = vulkanDevice->getLogicalDevice();
+
+    std::vector<ResourceHandle> transients;
+    std::vector<VkMemoryRequirements> requirements(resources.size());
+    for (ResourceHandle handle = 0; handle < resources.size(); handle++) {
+        Resource& resource = resources[handle];
+        if (resource.type != ResourceType::TransientImage || resource.firstPass == UINT32_MAX) {
+            continue;
+        }
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {resource.desc.extent.width, resource.desc.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = resource.desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = resource.usage;
+        imageInfo.samples = resource.desc.samples;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VkResult result = vkCreateImage(device, &imageInfo, nullptr, &resource.image);
+        if (result != VK_SUCCESS) {
+            std::cout << "Failed to create render graph image " << resource.name << " - " << result << std::endl;
+            throw std::runtime_error("failed to create render graph image!");
+        }
+        vkGetImageMemoryRequirements(device, resource.image, &requirements[handle]);
+        transientBytesRequested += requirements[handle].size;
+        transients.push_back(handle);
+    }
+
+    // Largest first, each image goes into the first block whose images are all dead before it
+    // starts or born after it ends. Images in a block share its memory at offset 0.
+    std::sort(transients.begin(), transients.end(), [&](ResourceHandle a, ResourceHandle b) {
+        return requirements[a].size > requirements[b].size;
+    });
+    for (ResourceHandle handle : transients) {
+        Resource& resource = resources[handle];
+        uint32_t blockIndex = UINT32_MAX;
+        for (uint32_t b = 0; b < memoryBlocks.size() && blockIndex == UINT32_MAX; b++) {
+            MemoryBlock& block = memoryBlocks[b];
+            if ((block.memoryTypeBits & requirements[handle].memoryTypeBits) == 0 ||
+                block.transientAttachment != resource.transientAttachment) {
+                continue;
+            }
+            bool overlaps = false;
+            for (ResourceHandle other : block.resources) {
+                overlaps = overlaps || !(resources[other].lastPass < resource.firstPass || resource.lastPass < resources[other].firstPass);
+            }
+            if (!overlaps) {
+                blockIndex = b;
+            }
+        }
+        if (blockIndex == UINT32_MAX) {
+            memoryBlocks.emplace_back();
+            memoryBlocks.back().transientAttachment = resource.transientAttachment;
+            blockIndex = static_cast<uint32_t>(memoryBlocks.size() - 1);
+        }
+
+        MemoryBlock& block = memoryBlocks[blockIndex];
+        block.resources.push_back(handle);
+        block.size = std::max(block.size, requirements[handle].size);
+        block.memoryTypeBits &= requirements[handle].memoryTypeBits;
+        resource.memoryBlock = blockIndex;
+    }
+
+    for (MemoryBlock& block : memoryBlocks) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = block.size;
+        uint32_t lazyType = block.transientAttachment ? findLazyMemoryType(block.memoryTypeBits) : UINT32_MAX;
+        block.lazilyAllocated = lazyType != UINT32_MAX;
+        allocInfo.memoryTypeIndex = block.lazilyAllocated
+                                        ? lazyType
+                                        : vulkanDevice->findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &block.memory);
+        if (result != VK_SUCCESS) {
+            std::cout << "Failed to allocate render graph memory - " << result << std::endl;
+            throw std::runtime_error("failed to allocate render graph memory!");
+        }
+        transientBytesAllocated += block.size;
+        if (block.lazilyAllocated) {
+            lazilyAllocatedBytes += block.size;
+        }
+
+        for (ResourceHandle handle : block.resources) {
+            Resource& resource = resources[handle];
+            vkBindImageMemory(device, resource.image, block.memory, 0);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = resource.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = resource.desc.format;
+            viewInfo.subresourceRange.aspectMask = resource.aspect;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            result = vkCreateImageView(device, &viewInfo, nullptr, &resource.view);
+            if (result != VK_SUCCESS) {
+                std::cout << "Failed to create render graph image view " << resource.name << " - " << result << std::endl;
+                throw std::runtime_error("failed to create render graph image view!");
+            }
+        }
+    }
+}
+
+void RenderGraph::createRenderPasses() {
+    VkDevice device = vulkanDevice->getLogicalDevice();
+
+    for (uint32_t passIndex = 0; passIndex < passes.size(); passIndex++) {
+        Pass& pass = passes[passIndex];
+        if (pass.culled) {
+            continue;
+        }
+
+        // Color attachments in declaration order, then depth, so the render pass stays compatible
+        // with ones written by hand in the same order. Resolve destinations hang off their source.
+        std::vector<const PassBuilder::Access*> attachmentAccesses;
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            if (access.usage == ResourceUsage::ColorAttachment && access.resolveSource == INVALID_RESOURCE) {
+                attachmentAccesses.push_back(&access);
+            }
+        }
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            if (access.usage == ResourceUsage::DepthAttachment || access.usage == ResourceUsage::DepthAttachmentRead) {
+                attachmentAccesses.push_back(&access);
+            }
+        }
+        if (attachmentAccesses.empty()) {
+            continue;
+        }
+
+        uint32_t framebufferCount = 1;
+        pass.extent = resources[attachmentAccesses[0]->resource].desc.extent;
+        pass.clearValues.clear();
+        for (const PassBuilder::Access* access : attachmentAccesses) {
+            const Resource& resource = resources[access->resource];
+            bool imported = resource.type == ResourceType::ImportedImage;
+            // Nothing after this pass reads a transient that ends here, so its contents can be dropped
+            bool keep = imported || resource.lastPass > passIndex;
+
+            Attachment attachment{};
+            attachment.resource = access->resource;
+            attachment.loadOp = access->loadOp;
+            attachment.storeOp = keep ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            attachment.layout = getUsageState(access->usage).layout;
+            attachment.depth = access->usage != ResourceUsage::ColorAttachment;
+            attachment.resolveTarget = INVALID_RESOURCE;
+            for (const PassBuilder::Access& resolve : pass.builder.accesses) {
+                if (resolve.resolveSource == access->resource) {
+                    attachment.resolveTarget = resolve.resource;
+                }
+            }
+            pass.attachments.push_back(attachment);
+            pass.clearValues.push_back(access->clearValue);
+
+            for (ResourceHandle handle : {attachment.resource, attachment.resolveTarget}) {
+                if (handle != INVALID_RESOURCE && resources[handle].type == ResourceType::ImportedImage) {
+                    framebufferCount = std::max(framebufferCount, static_cast<uint32_t>(resources[handle].imported.views.size()));
+                }
+            }
+        }
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            if (access.resolveSource != INVALID_RESOURCE &&
+                std::none_of(pass.attachments.begin(), pass.attachments.end(),
+                             [&](const Attachment& attachment) { return attachment.resolveTarget == access.resource; })) {
+                throw std::invalid_argument("pass " + pass.name + " resolves an image it does not render to");
+            }
+        }
+
+        // Dynamic rendering takes the views at record time
+        if (dynamicRendering) {
+            continue;
+        }
+
+        std::vector<VkAttachmentDescription> descriptions;
+        std::vector<VkAttachmentReference> colorReferences;
+        VkAttachmentReference depthReference{};
+        bool hasDepth = false;
+        for (uint32_t a = 0; a < pass.attachments.size(); a++) {
+            const Attachment& attachment = pass.attachments[a];
+            const Resource& resource = resources[attachment.resource];
+
+            VkAttachmentDescription description{};
+            description.format = resource.desc.format;
+            description.samples = resource.desc.samples;
+            description.loadOp = attachment.loadOp;
+            description.storeOp = attachment.storeOp;
+            description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            // Transitions happen in the barriers before the pass
+            description.initialLayout = attachment.layout;
+            description.finalLayout = attachment.layout;
+            descriptions.push_back(description);
+
+            if (attachment.depth) {
+                depthReference = {a, attachment.layout};
+                hasDepth = true;
+            } else {
+                colorReferences.push_back({a, attachment.layout});
+            }
+        }
+
+        // Resolve attachments go after all others, one reference per color attachment
+        std::vector<VkAttachmentReference> resolveReferences;
+        for (const Attachment& attachment : pass.attachments) {
+            if (attachment.depth) {
+                continue;
+            }
+            if (attachment.resolveTarget == INVALID_RESOURCE) {
+                resolveReferences.push_back({VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED});
+                continue;
+            }
+
+            VkAttachmentDescription description{};
+            description.format = resources[attachment.resolveTarget].desc.format;
+            description.samples = VK_SAMPLE_COUNT_1_BIT;
+            description.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            description.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            description.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            description.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            resolveReferences.push_back({static_cast<uint32_t>(descriptions.size()), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+            descriptions.push_back(description);
+        }
+        bool hasResolve = descriptions.size() > pass.attachments.size();
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+        subpass.pColorAttachments = colorReferences.data();
+        subpass.pResolveAttachments = hasResolve ? resolveReferences.data() : nullptr;
+        subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+        renderPassInfo.pAttachments = descriptions.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        VkResult result = vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass);
+        if (result != VK_SUCCESS) {
+            std::cout << "Failed to create render pass for " << pass.name << " - " << result << std::endl;
+            throw std::runtime_error("failed to create render graph render pass!");
+        }
+
+        pass.framebuffers.resize(framebufferCount);
+        for (uint32_t f = 0; f < framebufferCount; f++) {
+            std::vector<VkImageView> views;
+            for (const Attachment& attachment : pass.attachments) {
+                views.push_back(getView(resources[attachment.resource], f));
+            }
+            for (const Attachment& attachment : pass.attachments) {
+                if (attachment.resolveTarget != INVALID_RESOURCE) {
+                    views.push_back(getView(resources[attachment.resolveTarget], f));
+                }
+            }
+
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = pass.renderPass;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+            framebufferInfo.pAttachments = views.data();
+            framebufferInfo.width = pass.extent.width;
+            framebufferInfo.height = pass.extent.height;
+            framebufferInfo.layers = 1;
+
+            result = vkCreateFramebuffer(device, &framebufferInfo, nullptr, &pass.framebuffers[f]);
+            if (result != VK_SUCCESS) {
+                std::cout << "Failed to create framebuffer for " << pass.name << " - " << result << std::endl;
+                throw std::runtime_error("failed to create render graph framebuffer!");
+            }
+        }
+    }
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex) {
+    if (!compiled) {
+        throw std::runtime_error("render graph executed before compile()");
+    }
+
+    // Imports start every frame in their declared state. Transients keep the state of the previous
+    // frame, so their first use also waits for the last frame that touched the same memory.
+    for (Resource& resource : resources) {
+        if (resource.type == ResourceType::ImportedImage) {
+            resource.state = ResourceState{};
+            resource.state.layout = resource.imported.initialLayout;
+            resource.state.writeStages = resource.imported.waitStage;
+        } else if (resource.type == ResourceType::ImportedBuffer) {
+            resource.state = ResourceState{};
+        }
+    }
+
+    if (passTiming && !passTimer) {
+        passTimer = std::make_unique<GpuTimer>();
+        passTimer->initialize(*vulkanDevice, passTimingFrames, static_cast<uint32_t>(passes.size()));
+    }
+    GpuTimer* timer = passTiming ? passTimer.get() : nullptr;
+
+    std::vector<VkImageMemoryBarrier2> imageBarriers;
+    std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    for (uint32_t passIndex = 0; passIndex < passes.size(); passIndex++) {
+        Pass& pass = passes[passIndex];
+        if (pass.culled) {
+            continue;
+        }
+
+        imageBarriers.clear();
+        bufferBarriers.clear();
+        for (const PassBuilder::Access& access : pass.builder.accesses) {
+            Resource& resource = resources[access.resource];
+            UsageState next = getUsageState(access.usage);
+            ResourceState previous = resource.state;
+
+            bool firstUse = resource.type == ResourceType::TransientImage && passIndex == resource.firstPass;
+            if (firstUse) {
+                previous = memoryBlocks[resource.memoryBlock].state;
+                previous.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+            bool discard = firstUse || (access.write && isAttachment(access.usage) && access.loadOp != VK_ATTACHMENT_LOAD_OP_LOAD);
+
+            // A write or layout transition waits for every access since the last write. A read only
+            // waits for the last write, once for each stage and access it was not yet made visible to.
+            bool layoutChange = resource.type != ResourceType::ImportedBuffer && previous.layout != next.layout;
+            bool written = previous.writeStages != VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT || previous.writeAccess != 0;
+            bool uncovered = (next.stages & ~previous.readStages) != 0 || (next.access & ~previous.readAccess) != 0;
+            bool hazard = access.write ? written || previous.readStages != 0 : written && uncovered;
+            if (layoutChange || hazard || firstUse) {
+                VkPipelineStageFlags2 srcStages = previous.writeStages;
+                if (access.write || layoutChange || firstUse) {
+                    // Write after read only needs the readers to finish, not their memory
+                    srcStages |= previous.readStages;
+                }
+                if (resource.type == ResourceType::ImportedBuffer) {
+                    VkBufferMemoryBarrier2 barrier{};
+                    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+                    barrier.srcStageMask = srcStages;
+                    barrier.srcAccessMask = previous.writeAccess;
+                    barrier.dstStageMask = next.stages;
+                    barrier.dstAccessMask = next.access;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.buffer = resource.buffers[frameIndex % resource.buffers.size()];
+                    barrier.offset = 0;
+                    barrier.size = VK_WHOLE_SIZE;
+                    bufferBarriers.push_back(barrier);
+                } else {
+                    VkImageMemoryBarrier2 barrier{};
+                    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                    barrier.srcStageMask = srcStages;
+                    barrier.srcAccessMask = previous.writeAccess;
+                    barrier.dstStageMask = next.stages;
+                    barrier.dstAccessMask = next.access;
+                    barrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : previous.layout;
+                    barrier.newLayout = next.layout;
+                    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                    barrier.image = getImage(resource, imageIndex);
+                    barrier.subresourceRange = {resource.aspect, 0, 1, 0, 1};
+                    imageBarriers.push_back(barrier);
+                }
+                if (access.write) {
+                    resource.state = {next.layout, next.stages, next.access, 0, 0};
+                } else if (layoutChange || firstUse) {
+                    // Later readers chain onto the transition through the stages that waited for it
+                    resource.state = {next.layout, next.stages, 0, next.stages, next.access};
+                } else {
+                    resource.state.readStages |= next.stages;
+                    resource.state.readAccess |= next.access;
+                }
+            } else {
+                resource.state.readStages |= next.stages;
+                resource.state.readAccess |= next.access;
+            }
+
+            if (resource.type == ResourceType::TransientImage) {
+                memoryBlocks[resource.memoryBlock].state = resource.state;
+            }
+        }
+        recordBarriers(commandBuffer, imageBarriers, bufferBarriers);
+
+        // Timestamps stay outside the render pass, so the time includes load and store ops
+        if (timer) {
+            timer->begin(commandBuffer, frameIndex, passIndex);
+        }
+        if (!pass.attachments.empty()) {
+            beginPass(commandBuffer, pass, imageIndex);
+            pass.execute(commandBuffer);
+            endPass(commandBuffer);
+        } else {
+            pass.execute(commandBuffer);
+        }
+        if (timer) {
+            timer->end(commandBuffer, frameIndex, passIndex);
+        }
+    }
+
+    // Hand imported images back in the layout the outside expects, e.g. for presentation
+    imageBarriers.clear();
+    bufferBarriers.clear();
+    for (Resource& resource : resources) {
+        if (resource.type != ResourceType::ImportedImage || resource.imported.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            resource.state.layout == resource.imported.finalLayout) {
+            continue;
+        }
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = resource.state.writeStages | resource.state.readStages;
+        barrier.srcAccessMask = resource.state.writeAccess;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout = resource.state.layout;
+        barrier.newLayout = resource.imported.finalLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = getImage(resource, imageIndex);
+        barrier.subresourceRange = {resource.aspect, 0, 1, 0, 1};
+        imageBarriers.push_back(barrier);
+    }
+    recordBarriers(commandBuffer, imageBarriers, bufferBarriers);
+}
+
+void RenderGraph::setRenderArea(const std::string& passName, VkExtent2D extent) {
+    for (Pass& pass : passes) {
+        if (pass.name == passName) {
+            pass.renderArea = extent;
+        }
+    }
+}
+
+void RenderGraph::beginPass(VkCommandBuffer commandBuffer, const Pass& pass, uint32_t imageIndex) const {
+    VkExtent2D renderArea = pass.extent;
+    if (pass.renderArea.width > 0 && pass.renderArea.height > 0) {
+        renderArea.width = std::min(pass.renderArea.width, pass.extent.width);
+        renderArea.height = std::min(pass.renderArea.height, pass.extent.height);
+    }
+
+    if (!dynamicRendering) {
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = pass.renderPass;
+        renderPassInfo.framebuffer = pass.framebuffers[imageIndex % pass.framebuffers.size()];
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = renderArea;
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(pass.clearValues.size());
+        renderPassInfo.pClearValues = pass.clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    std::vector<VkRenderingAttachmentInfo> colorAttachments;
+    VkRenderingAttachmentInfo depthAttachment{};
+    bool hasDepth = false;
+    for (size_t a = 0; a < pass.attachments.size(); a++) {
+        const Attachment& attachment = pass.attachments[a];
+
+        VkRenderingAttachmentInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        info.imageView = getView(resources[attachment.resource], imageIndex);
+        info.imageLayout = attachment.layout;
+        info.loadOp = attachment.loadOp;
+        info.storeOp = attachment.storeOp;
+        info.clearValue = pass.clearValues[a];
+        if (attachment.resolveTarget != INVALID_RESOURCE) {
+            info.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+            info.resolveImageView = getView(resources[attachment.resolveTarget], imageIndex);
+            info.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
+        if (attachment.depth) {
+            depthAttachment = info;
+            hasDepth = true;
+        } else {
+            colorAttachments.push_back(info);
+        }
+    }
+
+    VkRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = renderArea;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+    renderingInfo.pColorAttachments = colorAttachments.data();
+    renderingInfo.pDepthAttachment = hasDepth ? &depthAttachment : nullptr;
+
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void RenderGraph::endPass(VkCommandBuffer commandBuffer) const {
+    if (dynamicRendering) {
+        vkCmdEndRendering(commandBuffer);
+    } else {
+        vkCmdEndRenderPass(commandBuffer);
+    }
+}
+
+void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2>& imageBarriers,
+                                 const std::vector<VkBufferMemoryBarrier2>& bufferBarriers) const {
+    if (imageBarriers.empty() && bufferBarriers.empty()) {
+        return;
+    }
+
+    if (dynamicRendering) {
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+        dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+        return;
+    }
+
+    // Without synchronization2 all barriers share one stage pair
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    std::vector<VkImageMemoryBarrier> legacyImageBarriers;
+    std::vector<VkBufferMemoryBarrier> legacyBufferBarriers;
+    for (const VkImageMemoryBarrier2& barrier : imageBarriers) {
+        srcStages |= toLegacyStages(barrier.srcStageMask);
+        dstStages |= toLegacyStages(barrier.dstStageMask);
+
+        VkImageMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        legacy.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+        legacy.oldLayout = barrier.oldLayout;
+        legacy.newLayout = barrier.newLayout;
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.image = barrier.image;
+        legacy.subresourceRange = barrier.subresourceRange;
+        legacyImageBarriers.push_back(legacy);
+    }
+    for (const VkBufferMemoryBarrier2& barrier : bufferBarriers) {
+        srcStages |= toLegacyStages(barrier.srcStageMask);
+        dstStages |= toLegacyStages(barrier.dstStageMask);
+
+        VkBufferMemoryBarrier legacy{};
+        legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        legacy.srcAccessMask = toLegacyAccess(barrier.srcAccessMask);
+        legacy.dstAccessMask = toLegacyAccess(barrier.dstAccessMask);
+        legacy.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex;
+        legacy.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex;
+        legacy.buffer = barrier.buffer;
+        legacy.offset = barrier.offset;
+        legacy.size = barrier.size;
+        legacyBufferBarriers.push_back(legacy);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 0, nullptr,
+                         static_cast<uint32_t>(legacyBufferBarriers.size()), legacyBufferBarriers.data(),
+                         static_cast<uint32_t>(legacyImageBarriers.size()), legacyImageBarriers.data());
+}
+
+VkImage RenderGraph::getImage(const Resource& resource, uint32_t imageIndex) const {
+    if (resource.type == ResourceType::ImportedImage) {
+        return resource.imported.images[imageIndex % resource.imported.images.size()];
+    }
+    return resource.image;
+}
+
+VkImageView RenderGraph::getView(const Resource& resource, uint32_t imageIndex) const {
+    if (resource.type == ResourceType::ImportedImage) {
+        return resource.imported.views[imageIndex % resource.imported.views.size()];
+    }
+    return resource.view;
+}
+
+uint32_t RenderGraph::findLazyMemoryType(uint32_t typeBits) const {
+    VkPhysicalDeviceMemoryProperties memProperties;
+    vkGetPhysicalDeviceMemoryProperties(vulkanDevice->getPhysicalDevice(), &memProperties);
+
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+        if ((typeBits & (1u << i)) && (memProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+VkRenderPass RenderGraph::getRenderPass(const std::string& passName) const {
+    for (const Pass& pass : passes) {
+        if (pass.name == passName) {
+            return pass.renderPass;
+        }
+    }
+    return VK_NULL_HANDLE;
+}
+
+VkImage RenderGraph::getImage(ResourceHandle resource, uint32_t imageIndex) const {
+    return getImage(resources.at(resource), imageIndex);
+}
+
+VkImageView RenderGraph::getImageView(ResourceHandle resource, uint32_t imageIndex) const {
+    return getView(resources.at(resource), imageIndex);
+}
+
+bool RenderGraph::isPassCulled(const std::string& passName) const {
+    for (const Pass& pass : passes) {
+        if (pass.name == passName) {
+            return pass.culled;
+        }
+    }
+    return true;
+}
+
+uint32_t RenderGraph::getCulledPassCount() const {
+    uint32_t count = 0;
+    for (const Pass& pass : passes) {
+        count += pass.culled ? 1 : 0;
+    }
+    return count;
+}
+
+RenderGraph::UsageState RenderGraph::getUsageState(ResourceUsage usage) {
+    switch (usage) {
+        case ResourceUsage::ColorAttachment:
+            return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT};
+        case ResourceUsage::DepthAttachment:
+            return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                    VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT};
+        case ResourceUsage::DepthAttachmentRead:
+            return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                    VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT};
+        case ResourceUsage::SampledFragment:
+            return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT};
+        case ResourceUsage::SampledCompute:
+            return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT};
+        case ResourceUsage::StorageReadCompute:
+            return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT};
+        case ResourceUsage::StorageWriteCompute:
+            return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT};
+        case ResourceUsage::IndirectRead:
+            return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT};
+        case ResourceUsage::VertexRead:
+            return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT,
+                    VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT};
+        case ResourceUsage::TransferSrc:
+            return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT};
+        case ResourceUsage::TransferDst:
+            return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT};
+    }
+    return {};
+}
+
+VkImageUsageFlags RenderGraph::getImageUsage(ResourceUsage usage) {
+    switch (usage) {
+        case ResourceUsage::ColorAttachment:
+            return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        case ResourceUsage::DepthAttachment:
+        case ResourceUsage::DepthAttachmentRead:
+            return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        case ResourceUsage::SampledFragment:
+        case ResourceUsage::SampledCompute:
+            return VK_IMAGE_USAGE_SAMPLED_BIT;
+        case ResourceUsage::StorageReadCompute:
+        case ResourceUsage::StorageWriteCompute:
+            return VK_IMAGE_USAGE_STORAGE_BIT;
+        case ResourceUsage::TransferSrc:
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        case ResourceUsage::TransferDst:
+            return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        default:
+            return 0;
+    }
+}
+
+bool RenderGraph::isAttachment(ResourceUsage usage) {
+    return usage == ResourceUsage::ColorAttachment || usage == ResourceUsage::DepthAttachment ||
+           usage == ResourceUsage::DepthAttachmentRead;
+}
+
+bool RenderGraph::isDepthFormat(VkFormat format) {
+    return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D16_UNORM_S8_UINT ||
+           format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+VkPipelineStageFlags RenderGraph::toLegacyStages(VkPipelineStageFlags2 stages) {
+    if (stages & (VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT)) {
+        stages = (stages & ~(VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT | VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT)) |
+                 VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+    }
+    const VkPipelineStageFlags2 transferStages = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT |
+                                                 VK_PIPELINE_STAGE_2_RESOLVE_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT;
+    if (stages & transferStages) {
+        stages = (stages & ~transferStages) | VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    }
+    return static_cast<VkPipelineStageFlags>(stages);
+}
+
+VkAccessFlags RenderGraph::toLegacyAccess(VkAccessFlags2 access) {
+    if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT)) {
+        access = (access & ~(VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT)) | VK_ACCESS_2_SHADER_READ_BIT;
+    }
+    if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT) {
+        access = (access & ~VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT) | VK_ACCESS_2_SHADER_WRITE_BIT;
+    }
+    return static_cast<VkAccessFlags>(access);
+}
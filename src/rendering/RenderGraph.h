@@ -0,0 +1,268 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../core/VulkanDevice.h"
+#include "GpuTimer.h"
+
+// Frame graph of render, compute and transfer passes. Passes declare the resources they read and
+// write; compile() culls passes whose results are never used and places transient images with
+// disjoint lifetimes in the same memory. Transient images that live inside a single pass and are
+// only used as attachments get VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT and lazily allocated memory
+// where the device has it, so e.g. multisampled color and depth never need backing on tilers.
+// execute() records the passes with the pipeline barriers derived from the declared usages, so no
+// pass has to know what ran before it.
+//
+// When the device has dynamic rendering enabled, raster passes are recorded with
+// vkCmdBeginRendering and barriers with vkCmdPipelineBarrier2, so there are no render pass or
+// framebuffer objects to rebuild on resize. Otherwise compile() creates a VkRenderPass and
+// framebuffers for every raster pass and the barriers are narrowed to the original stage and
+// access flags.
+//
+// The graph is built once and executed every frame. Rebuild it (reset, declare, compile) when an
+// input changes, e.g. after the swapchain is recreated.
+class RenderGraph {
+    public:
+        using ResourceHandle = uint32_t;
+        static constexpr ResourceHandle INVALID_RESOURCE = UINT32_MAX;
+
+        enum class ResourceUsage {
+            ColorAttachment,
+            DepthAttachment,        // depth test and write
+            DepthAttachmentRead,    // depth test only, e.g. an EQUAL pass after a prepass
+            SampledFragment,
+            SampledCompute,
+            StorageReadCompute,
+            StorageWriteCompute,
+            IndirectRead,
+            VertexRead,
+            TransferSrc,
+            TransferDst
+        };
+
+        struct ImageDesc {
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent{};
+            VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+            // Added to the usage flags derived from the passes
+            VkImageUsageFlags extraUsage = 0;
+        };
+
+        // External image, one per swapchain image (selected by the image index passed to execute)
+        struct ImportedImage {
+            std::vector<VkImage> images;
+            std::vector<VkImageView> views;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent{};
+            // Layout the image is in when the frame starts; UNDEFINED discards its contents
+            VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // Layout the image is left in, e.g. PRESENT_SRC_KHR. UNDEFINED keeps the last used layout.
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // Stage that waits on the semaphore guarding the image, for swapchain images
+            VkPipelineStageFlags2 waitStage = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+        };
+
+        class PassBuilder {
+            public:
+                void writeColor(ResourceHandle resource, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                VkClearColorValue clearValue = {});
+                void writeDepth(ResourceHandle resource, VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                float clearDepth = 1.0f);
+                // Resolves the multisampled color attachment `source` (written by this pass) into
+                // `destination` at the end of the pass
+                void resolveColor(ResourceHandle source, ResourceHandle destination);
+                // Depth attachment that is tested against but not written
+                void readDepth(ResourceHandle resource);
+                void read(ResourceHandle resource, ResourceUsage usage);
+                void write(ResourceHandle resource, ResourceUsage usage);
+                // Keeps the pass even if nothing reads its results, e.g. for readbacks
+                void setSideEffect() { sideEffect = true; }
+
+            private:
+                friend class RenderGraph;
+                struct Access {
+                    ResourceHandle resource;
+                    ResourceUsage usage;
+                    bool write;
+                    VkAttachmentLoadOp loadOp;
+                    VkClearValue clearValue;
+                    // For resolve destinations, the color attachment resolved into this one
+                    ResourceHandle resolveSource = INVALID_RESOURCE;
+                };
+                std::vector<Access> accesses;
+                bool sideEffect = false;
+        };
+
+        using SetupCallback = std::function<void(PassBuilder&)>;
+        using ExecuteCallback = std::function<void(VkCommandBuffer)>;
+
+        RenderGraph();
+        ~RenderGraph();
+
+        void initialize(const VulkanDevice& device);
+        // Destroys all compiled objects and transient images. The device must be idle.
+        void cleanup();
+        // Clears the declared passes and resources so the graph can be declared again. The device must be idle.
+        void reset();
+
+        ResourceHandle createImage(const std::string& name, const ImageDesc& desc);
+        ResourceHandle importImage(const std::string& name, const ImportedImage& image);
+        // External buffers, one per frame in flight (selected by the frame index passed to execute)
+        ResourceHandle importBuffers(const std::string& name, const std::vector<VkBuffer>& buffers);
+
+        // Passes run in declaration order. A pass with attachments is a raster pass and its
+        // callback is recorded inside its render pass.
+        void addPass(const std::string& name, const SetupCallback& setup, const ExecuteCallback& execute);
+
+        void compile();
+        // Restricts a raster pass to [0, extent) of its attachments, e.g. for dynamic resolution.
+        // May change every frame without recompiling; a zero extent renders the full attachments.
+        void setRenderArea(const std::string& passName, VkExtent2D extent);
+        void execute(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t imageIndex);
+
+        // Writes GPU timestamps around every executed pass. The queries are created on the first
+        // execute() after enabling, for the passes declared at that point.
+        void setPassTimingEnabled(bool enable, uint32_t maxFramesInFlight);
+        // GPU time of a pass in the frame last executed with frameIndex. Call once that frame's
+        // fence has signaled and before execute() reuses the index; false if there is no result.
+        bool getPassTime(uint32_t passIndex, uint32_t frameIndex, double& milliseconds) const;
+        const std::string& getPassName(uint32_t passIndex) const { return passes[passIndex].name; }
+
+        // Render pass of a compiled raster pass, for creating compatible pipelines. VK_NULL_HANDLE
+        // with dynamic rendering, where pipelines only need the attachment formats.
+        VkRenderPass getRenderPass(const std::string& passName) const;
+        bool usesDynamicRendering() const { return dynamicRendering; }
+        VkImage getImage(ResourceHandle resource, uint32_t imageIndex = 0) const;
+        VkImageView getImageView(ResourceHandle resource, uint32_t imageIndex = 0) const;
+        bool isPassCulled(const std::string& passName) const;
+
+        uint32_t getPassCount() const { return static_cast<uint32_t>(passes.size()); }
+        uint32_t getCulledPassCount() const;
+        // Memory the transient images would need without aliasing, and what was allocated
+        VkDeviceSize getTransientBytesRequested() const { return transientBytesRequested; }
+        VkDeviceSize getTransientBytesAllocated() const { return transientBytesAllocated; }
+        // Part of the allocated bytes in lazily allocated memory, only committed if the GPU spills
+        VkDeviceSize getLazilyAllocatedBytes() const { return lazilyAllocatedBytes; }
+
+    private:
+        enum class ResourceType {
+            TransientImage,
+            ImportedImage,
+            ImportedBuffer
+        };
+
+        // Layout, stages and access of one usage
+        struct UsageState {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+            VkAccessFlags2 access = 0;
+        };
+
+        // Synchronization state of a resource: its last write, and the reads that already wait for it
+        struct ResourceState {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            // Last write or layout transition, TOP_OF_PIPE without access when there is none
+            VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+            VkAccessFlags2 writeAccess = 0;
+            // Stages and accesses that read since, with the write made visible to them
+            VkPipelineStageFlags2 readStages = 0;
+            VkAccessFlags2 readAccess = 0;
+        };
+
+        struct Resource {
+            std::string name;
+            ResourceType type = ResourceType::TransientImage;
+            ImageDesc desc;
+            ImportedImage imported;
+            std::vector<VkBuffer> buffers;
+
+            // Compiled
+            VkImageUsageFlags usage = 0;
+            VkImageAspectFlags aspect = 0;
+            uint32_t firstPass = UINT32_MAX;
+            uint32_t lastPass = 0;
+            uint32_t memoryBlock = UINT32_MAX;
+            // Only used as an attachment within one pass, its contents never leave tile memory
+            bool transientAttachment = false;
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+            ResourceState state;
+        };
+
+        struct Attachment {
+            ResourceHandle resource;
+            VkAttachmentLoadOp loadOp;
+            VkAttachmentStoreOp storeOp;
+            VkImageLayout layout;
+            bool depth;
+            // Single sample image the color attachment is resolved into
+            ResourceHandle resolveTarget;
+        };
+
+        struct Pass {
+            std::string name;
+            PassBuilder builder;
+            ExecuteCallback execute;
+
+            // Compiled. Color attachments come before depth.
+            bool culled = false;
+            std::vector<Attachment> attachments;
+            VkRenderPass renderPass = VK_NULL_HANDLE;
+            std::vector<VkFramebuffer> framebuffers;
+            std::vector<VkClearValue> clearValues;
+            VkExtent2D extent{};
+            VkExtent2D renderArea{};
+        };
+
+        // Memory shared by transient images whose pass ranges do not overlap
+        struct MemoryBlock {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+            uint32_t memoryTypeBits = ~0u;
+            bool transientAttachment = false;
+            bool lazilyAllocated = false;
+            std::vector<ResourceHandle> resources;
+            // Last access of any image in the block, the first user of an alias waits on it
+            ResourceState state;
+        };
+
+        const VulkanDevice* vulkanDevice = nullptr;
+        bool dynamicRendering = false;
+        std::vector<Resource> resources;
+        std::vector<Pass> passes;
+        std::vector<MemoryBlock> memoryBlocks;
+        bool compiled = false;
+        VkDeviceSize transientBytesRequested = 0;
+        VkDeviceSize transientBytesAllocated = 0;
+        VkDeviceSize lazilyAllocatedBytes = 0;
+        bool passTiming = false;
+        uint32_t passTimingFrames = 0;
+        // One scope per pass, recreated when the passes are declared again
+        std::unique_ptr<GpuTimer> passTimer;
+
+        void destroyCompiledObjects();
+        void cullPasses();
+        void computeLifetimes();
+        void createTransientImages();
+        void createRenderPasses();
+        void beginPass(VkCommandBuffer commandBuffer, const Pass& pass, uint32_t imageIndex) const;
+        void endPass(VkCommandBuffer commandBuffer) const;
+        void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2>& imageBarriers,
+                            const std::vector<VkBufferMemoryBarrier2>& bufferBarriers) const;
+        VkImage getImage(const Resource& resource, uint32_t imageIndex) const;
+        VkImageView getView(const Resource& resource, uint32_t imageIndex) const;
+        // UINT32_MAX if the device has no lazily allocated memory type in typeBits
+        uint32_t findLazyMemoryType(uint32_t typeBits) const;
+
+        static UsageState getUsageState(ResourceUsage usage);
+        static VkImageUsageFlags getImageUsage(ResourceUsage usage);
+        static bool isAttachment(ResourceUsage usage);
+        static bool isDepthFormat(VkFormat format);
+        // Maps synchronization2-only flags onto the closest vkCmdPipelineBarrier ones
+        static VkPipelineStageFlags toLegacyStages(VkPipelineStageFlags2 stages);
+        static VkAccessFlags toLegacyAccess(VkAccessFlags2 access);
+};
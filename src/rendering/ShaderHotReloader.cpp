@@ -0,0 +1,206 @@
+#include "ShaderHotReloader.h"
+#include "../common/FileUtils.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+
+ShaderHotReloader::ShaderHotReloader() {}
+
+ShaderHotReloader::~ShaderHotReloader() {
+    cleanup();
+}
+
+void ShaderHotReloader::initialize(const VulkanDevice& device, VulkanGraphicsPipeline& pipeline, PipelineManager& pipelineManager,
+                                   uint32_t pollIntervalMs) {
+    this->vulkanDevice = &device;
+    this->graphicsPipeline = &pipeline;
+    this->pipelineManager = &pipelineManager;
+    this->pollIntervalMs = pollIntervalMs;
+
+    if (std::system("glslc --version > /dev/null 2>&1") != 0) {
+        std::cout << "Shader hot reload disabled - glslc not found in PATH" << std::endl;
+        return;
+    }
+
+    // Record the current timestamps so only edits made from now on trigger a reload
+    sourcesChanged(graphicsPipeline->getBuildKey().sources);
+
+    running = true;
+    watcherThread = std::thread(&ShaderHotReloader::watchLoop, this);
+    std::cout << "Shader hot reload enabled" << std::endl;
+}
+
+void ShaderHotReloader::cleanup() {
+    if (running) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wakeCondition.notify_all();
+    }
+    if (watcherThread.joinable()) {
+        watcherThread.join();
+    }
+
+    if (vulkanDevice) {
+        if (pendingPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(vulkanDevice->getLogicalDevice(), pendingPipeline, nullptr);
+            pendingPipeline = VK_NULL_HANDLE;
+        }
+        for (const RetiredPipeline& retired : retiredPipelines) {
+            vkDestroyPipeline(vulkanDevice->getLogicalDevice(), retired.pipeline, nullptr);
+        }
+        retiredPipelines.clear();
+        vulkanDevice = nullptr;
+    }
+}
+
+bool ShaderHotReloader::update(uint32_t maxFramesInFlight) {
+    // Pipelines replaced earlier may still be referenced by frames in flight
+    for (size_t i = 0; i < retiredPipelines.size();) {
+        if (retiredPipelines[i].framesLeft == 0) {
+            vkDestroyPipeline(vulkanDevice->getLogicalDevice(), retiredPipelines[i].pipeline, nullptr);
+            retiredPipelines.erase(retiredPipelines.begin() + i);
+        } else {
+            retiredPipelines[i].framesLeft--;
+            i++;
+        }
+    }
+
+    VkPipeline newPipeline = VK_NULL_HANDLE;
+    uint64_t generation = 0;
+    VulkanGraphicsPipeline::ShaderSources sources;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(newPipeline, pendingPipeline);
+        generation = pendingGeneration;
+        sources = pendingSources;
+    }
+    if (newPipeline == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    // The binaries were replaced either way, so variants built from the old ones are retired with
+    // the pipeline below
+    for (const std::string& binary : {sources.vertexBinary, sources.fragmentBinary}) {
+        for (VkPipeline variant : pipelineManager->invalidateShader(binary)) {
+            retiredPipelines.push_back({variant, maxFramesInFlight});
+        }
+    }
+    // Built for a render pass, layout or state the render thread has replaced since; the pipeline
+    // it rebuilt then already reads the recompiled binaries
+    if (generation != graphicsPipeline->getBuildKey().generation) {
+        vkDestroyPipeline(vulkanDevice->getLogicalDevice(), newPipeline, nullptr);
+        std::cout << "Discarded reloaded graphics pipeline - pipeline changed while it was built" << std::endl;
+        return false;
+    }
+
+    VkPipeline previous = graphicsPipeline->swapPipeline(newPipeline);
+    retiredPipelines.push_back({previous, maxFramesInFlight});
+    std::cout << "Swapped in reloaded graphics pipeline" << std::endl;
+    return true;
+}
+
+std::string ShaderHotReloader::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastError;
+}
+
+void ShaderHotReloader::watchLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        wakeCondition.wait_for(lock, std::chrono::milliseconds(pollIntervalMs), [this]() { return !running; });
+        if (!running) {
+            break;
+        }
+
+        lock.unlock();
+        VulkanGraphicsPipeline::BuildKey key = graphicsPipeline->getBuildKey();
+        if (sourcesChanged(key.sources)) {
+            reload(key);
+        }
+        lock.lock();
+    }
+}
+
+bool ShaderHotReloader::sourcesChanged(const VulkanGraphicsPipeline::ShaderSources& sources) {
+    bool changed = false;
+    for (const std::string& source : {sources.vertexSource, sources.fragmentSource}) {
+        std::error_code error;
+        auto writeTime = std::filesystem::last_write_time(source, error);
+        if (error) {
+            continue;
+        }
+        auto it = timestamps.find(source);
+        if (it == timestamps.end() || it->second != writeTime) {
+            changed = true;
+            timestamps[source] = writeTime;
+        }
+    }
+    return changed;
+}
+
+void ShaderHotReloader::reload(const VulkanGraphicsPipeline::BuildKey& key) {
+    const VulkanGraphicsPipeline::ShaderSources& sources = key.sources;
+    // Compile next to the real binaries and only replace them once the pipeline is known to be good
+    const std::string vertexOutput = sources.vertexBinary + ".reload";
+    const std::string fragmentOutput = sources.fragmentBinary + ".reload";
+
+    std::string log;
+    std::vector<char> vertShaderCode;
+    std::vector<char> fragShaderCode;
+    bool compiled = compileShader(sources.vertexSource, vertexOutput, log) &&
+                    compileShader(sources.fragmentSource, fragmentOutput, log) &&
+                    readFile(vertexOutput, vertShaderCode) &&
+                    readFile(fragmentOutput, fragShaderCode);
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (compiled) {
+        VkResult result = graphicsPipeline->buildPipeline(key, vertShaderCode, fragShaderCode, pipeline);
+        if (result != VK_SUCCESS) {
+            log = "pipeline creation failed - " + std::to_string(result);
+            compiled = false;
+        }
+    }
+
+    if (!compiled) {
+        std::remove(vertexOutput.c_str());
+        std::remove(fragmentOutput.c_str());
+        std::cout << "Shader reload failed, keeping the current pipeline:\n" << log << std::endl;
+        std::lock_guard<std::mutex> lock(mutex);
+        lastError = log;
+        return;
+    }
+
+    std::rename(vertexOutput.c_str(), sources.vertexBinary.c_str());
+    std::rename(fragmentOutput.c_str(), sources.fragmentBinary.c_str());
+    std::cout << "Shaders recompiled - " << sources.vertexSource << ", " << sources.fragmentSource << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    lastError.clear();
+    // A newer build supersedes one the render thread has not picked up yet
+    if (pendingPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(vulkanDevice->getLogicalDevice(), pendingPipeline, nullptr);
+    }
+    pendingPipeline = pipeline;
+    pendingGeneration = key.generation;
+    pendingSources = sources;
+}
+
+bool ShaderHotReloader::compileShader(const std::string& source, const std::string& output, std::string& log) {
+    std::string command = "glslc \"" + source + "\" -o \"" + output + "\" 2>&1";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        log += "failed to run glslc\n";
+        return false;
+    }
+
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        log += buffer;
+    }
+    return pclose(pipe) == 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/VulkanDevice.h"
+#include "PipelineManager.h"
+#include "VulkanGraphicsPipeline.h"
+
+// Watches the GLSL sources of the graphics pipeline, recompiles them with glslc and builds the new
+// pipeline on a background thread. The watcher only sees snapshots of the pipeline's build key, and
+// the render thread swaps the result in from update() at a frame boundary, unless the pipeline
+// changed in the meantime. A failed compile or pipeline build leaves the current pipeline untouched.
+// Once new binaries are in place, the PipelineManager variants built from the old ones are dropped
+// so materials and depth passes rebuild with the same shaders as the main pipeline.
+class ShaderHotReloader {
+    public:
+        ShaderHotReloader();
+        ~ShaderHotReloader();
+
+        void initialize(const VulkanDevice& device, VulkanGraphicsPipeline& pipeline, PipelineManager& pipelineManager,
+                        uint32_t pollIntervalMs = 250);
+        // Stops the watcher and destroys pending and retired pipelines. The device must be idle.
+        void cleanup();
+
+        // Called once per frame after the frame's fence wait. Returns true when a new pipeline was swapped in.
+        bool update(uint32_t maxFramesInFlight);
+
+        std::string getLastError() const;
+
+    private:
+        struct RetiredPipeline {
+            VkPipeline pipeline;
+            uint32_t framesLeft;
+        };
+
+        const VulkanDevice* vulkanDevice = nullptr;
+        VulkanGraphicsPipeline* graphicsPipeline = nullptr;
+        PipelineManager* pipelineManager = nullptr;
+        uint32_t pollIntervalMs = 250;
+
+        std::thread watcherThread;
+        std::atomic<bool> running{false};
+        std::condition_variable wakeCondition;
+
+        mutable std::mutex mutex;
+        VkPipeline pendingPipeline = VK_NULL_HANDLE;
+        // Build key generation pendingPipeline was built from
+        uint64_t pendingGeneration = 0;
+        // SPIR-V files the last reload replaced
+        VulkanGraphicsPipeline::ShaderSources pendingSources;
+        std::string lastError;
+
+        // Owned by the watcher thread
+        std::map<std::string, std::filesystem::file_time_type> timestamps;
+        // Owned by the render thread
+        std::vector<RetiredPipeline> retiredPipelines;
+
+        void watchLoop();
+        bool sourcesChanged(const VulkanGraphicsPipeline::ShaderSources& sources);
+        void reload(const VulkanGraphicsPipeline::BuildKey& key);
+        static bool compileShader(const std::string& source, const std::string& output, std::string& log);
+};
@@ -1,10 +1,12 @@
 #include "VulkanGraphicsPipeline.h"
+#include "../common/FileUtils.h"
 #include <iostream>
 #include <stdexcept>
 #include <fstream>
 #include <array>
 #include <glm/glm.hpp>
-#include "../common/Vertex.h"
+
+static const std::string SHADER_DIRECTORY = "../shaders/";
 
 VulkanGraphicsPipeline::VulkanGraphicsPipeline() {}
 
@@ -12,50 +14,123 @@ VulkanGraphicsPipeline::~VulkanGraphicsPipeline() {
     cleanup();
 }
 
-void VulkanGraphicsPipeline::initialize(const VulkanDevice& device, const VulkanSwapchain& swapchain) {
+void VulkanGraphicsPipeline::initialize(const VulkanDevice& device, const VulkanSwapchain& swapchain, PipelineManager& pipelineManager,
+                                        VkSampleCountFlagBits samples) {
     this->vulkanDevice = &device;
     this->vulkanSwapchain = &swapchain;
+    this->pipelineManager = &pipelineManager;
+    pipelineState.rasterizationSamples = samples;
+    colorFormat = swapchain.getImageFormat();
+    depthFormat = findDepthFormat();
     
-    createRenderPass(swapchain.getImageFormat());
-    createDescriptorSetLayout();
+    if (!device.isDynamicRenderingEnabled()) {
+        createRenderPass(colorFormat);
+        createDepthOnlyRenderPass();
+        createOverlayRenderPass(colorFormat);
+    }
     createGraphicsPipeline(swapchain.getExtent());
 }
 
 void VulkanGraphicsPipeline::cleanup() {
     if (vulkanDevice) {
+        // Layouts belong to the LayoutCache
         vkDestroyPipeline(vulkanDevice->getLogicalDevice(), graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(vulkanDevice->getLogicalDevice(), pipelineLayout, nullptr);
+        // Variants may still be compiling against the render passes
+        if (pipelineManager) {
+            pipelineManager->releaseRenderPass(renderPass);
+            pipelineManager->releaseRenderPass(depthOnlyRenderPass);
+        }
         vkDestroyRenderPass(vulkanDevice->getLogicalDevice(), renderPass, nullptr);
-        vkDestroyDescriptorSetLayout(vulkanDevice->getLogicalDevice(), descriptorSetLayout, nullptr);
+        vkDestroyRenderPass(vulkanDevice->getLogicalDevice(), depthOnlyRenderPass, nullptr);
+        vkDestroyRenderPass(vulkanDevice->getLogicalDevice(), overlayRenderPass, nullptr);
     }
 }
 
 void VulkanGraphicsPipeline::recreate(const VulkanSwapchain& swapchain) {
     // Only recreate pipeline if extent changed
     vkDestroyPipeline(vulkanDevice->getLogicalDevice(), graphicsPipeline, nullptr);
-    vkDestroyPipelineLayout(vulkanDevice->getLogicalDevice(), pipelineLayout, nullptr);
     
     createGraphicsPipeline(swapchain.getExtent());
 }
 
+void VulkanGraphicsPipeline::setVertexFormat(VertexFormat format) {
+    if (format == vertexFormat) {
+        return;
+    }
+    vertexFormat = format;
+
+    vkDestroyPipeline(vulkanDevice->getLogicalDevice(), graphicsPipeline, nullptr);
+
+    createGraphicsPipeline(vulkanSwapchain->getExtent());
+}
+
+void VulkanGraphicsPipeline::setPipelineState(const PipelineState& state) {
+    if (state == pipelineState) {
+        return;
+    }
+    pipelineState = state;
+
+    vkDestroyPipeline(vulkanDevice->getLogicalDevice(), graphicsPipeline, nullptr);
+
+    createGraphicsPipeline(vulkanSwapchain->getExtent());
+}
+
+PipelineKey VulkanGraphicsPipeline::getPipelineKey(const PipelineState& state) const {
+    ShaderSources sources = getShaderSources();
+    PipelineKey key;
+    key.vertexShader = sources.vertexBinary;
+    key.fragmentShader = sources.fragmentBinary;
+    key.vertexFormat = vertexFormat;
+    key.renderPass = renderPass;
+    key.colorFormat = colorFormat;
+    key.depthFormat = depthFormat;
+    key.state = state;
+    return key;
+}
+
+PipelineKey VulkanGraphicsPipeline::getDepthOnlyPipelineKey(const PipelineState& state) const {
+    PipelineKey key;
+    if (vertexFormat == VertexFormat::Compact) {
+        // Compact vertices are already small; fetching only their position attribute is enough
+        key.vertexShader = SHADER_DIRECTORY + "depth_compact_vert.spv";
+        key.vertexFormat = VertexFormat::Compact;
+    } else {
+        key.vertexShader = SHADER_DIRECTORY + "depth_vert.spv";
+        key.vertexFormat = VertexFormat::Position;
+    }
+    key.renderPass = depthOnlyRenderPass;
+    key.depthFormat = depthFormat;
+    key.layout = pipelineLayout;
+    key.state = state;
+    key.state.blendEnable = VK_FALSE;
+    key.state.depthTestEnable = VK_TRUE;
+    key.state.depthWriteEnable = VK_TRUE;
+    key.state.depthCompareOp = VK_COMPARE_OP_LESS;
+    return key;
+}
+
 void VulkanGraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat){
+    VkSampleCountFlagBits samples = pipelineState.rasterizationSamples;
+    bool multisampled = samples != VK_SAMPLE_COUNT_1_BIT;
+
+    // Multisampled color is resolved into the swapchain image and never stored itself
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = swapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.samples = samples;
     colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = findDepthFormat();
-    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.format = depthFormat;
+    depthAttachment.samples = samples;
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
@@ -67,10 +142,25 @@ void VulkanGraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat){
     depthAttachmentRef.attachment = 1;
     depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentDescription resolveAttachment{};
+    resolveAttachment.format = swapChainImageFormat;
+    resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resolveAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference resolveAttachmentRef{};
+    resolveAttachmentRef.attachment = 2;
+    resolveAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.pResolveAttachments = multisampled ? &resolveAttachmentRef : nullptr;
     subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
     VkSubpassDependency dependency{};
@@ -81,7 +171,10 @@ void VulkanGraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat){
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;  
 
-    std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
+    std::vector<VkAttachmentDescription> attachments = {colorAttachment, depthAttachment};
+    if (multisampled) {
+        attachments.push_back(resolveAttachment);
+    }
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
@@ -100,212 +193,156 @@ void VulkanGraphicsPipeline::createRenderPass(VkFormat swapChainImageFormat){
     }
 }
 
-void VulkanGraphicsPipeline::createDescriptorSetLayout(){
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    uboLayoutBinding.pImmutableSamplers = nullptr;
-
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
-
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    VkResult descriptorSetLayoutResult = vkCreateDescriptorSetLayout(vulkanDevice->getLogicalDevice(), &layoutInfo, nullptr, &descriptorSetLayout);
-    if(descriptorSetLayoutResult != VK_SUCCESS){
-        std::cout << "Failed to create descriptor layout - " << descriptorSetLayoutResult << std::endl;
-        throw std::runtime_error("Failed to create descriptor layout");
+void VulkanGraphicsPipeline::createDepthOnlyRenderPass() {
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = depthFormat;
+    depthAttachment.samples = pipelineState.rasterizationSamples;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference depthAttachmentRef{};
+    depthAttachmentRef.attachment = 0;
+    depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 0;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &depthAttachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    VkResult result = vkCreateRenderPass(vulkanDevice->getLogicalDevice(), &renderPassInfo, nullptr, &depthOnlyRenderPass);
+    if (result != VK_SUCCESS) {
+        std::cout<< "failed to create depth-only render pass - " << result <<std::endl;
+        throw std::runtime_error("failed to create depth-only render pass!");
     }else{
-        std::cout << "Successfully created descriptor layout - " << descriptorSetLayoutResult << std::endl;
+        std::cout<< "successfully created depth-only render pass - " << result <<std::endl;
     }
 }
 
-void VulkanGraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent){
-    auto vertShaderCode = readFile("../shaders/vert.spv");
-    auto fragShaderCode = readFile("../shaders/frag.spv");
-
-    VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
-
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float) swapChainExtent.width;
-    viewport.height = (float) swapChainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapChainExtent;
-
-    std::vector<VkDynamicState> dynamicStates = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
-    };
-
-    VkPipelineDynamicStateCreateInfo dynamicState{};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
-
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
-    viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-    rasterizer.depthBiasConstantFactor = 0.0f; // Optional
-    rasterizer.depthBiasClamp = 0.0f; // Optional
-    rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
-
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-    multisampling.minSampleShading = 1.0f; // Optional
-    multisampling.pSampleMask = nullptr; // Optional
-    multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-    multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optional
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f; // Optional
-    colorBlending.blendConstants[1] = 0.0f; // Optional
-    colorBlending.blendConstants[2] = 0.0f; // Optional
-    colorBlending.blendConstants[3] = 0.0f; // Optional
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-    pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
-
-    VkResult layoutResult = vkCreatePipelineLayout(vulkanDevice->getLogicalDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
-    if ( layoutResult != VK_SUCCESS) {
-        std::cout<< "Failed to create pipeline layout - " << layoutResult << std::endl;
-        throw std::runtime_error("failed to create pipeline layout!");
+void VulkanGraphicsPipeline::createOverlayRenderPass(VkFormat swapChainImageFormat) {
+    VkAttachmentDescription colorAttachment{};
+    colorAttachment.format = swapChainImageFormat;
+    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference colorAttachmentRef{};
+    colorAttachmentRef.attachment = 0;
+    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorAttachmentRef;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    VkResult result = vkCreateRenderPass(vulkanDevice->getLogicalDevice(), &renderPassInfo, nullptr, &overlayRenderPass);
+    if (result != VK_SUCCESS) {
+        std::cout<< "failed to create overlay render pass - " << result <<std::endl;
+        throw std::runtime_error("failed to create overlay render pass!");
     }else{
-        std::cout<< "Successfully created pipeline layout - " << layoutResult << std::endl;
+        std::cout<< "successfully created overlay render pass - " << result <<std::endl;
+    }
+}
+
+VulkanGraphicsPipeline::ShaderSources VulkanGraphicsPipeline::getShaderSources() const {
+    ShaderSources sources;
+    if (vertexFormat == VertexFormat::Compact) {
+        sources.vertexSource = SHADER_DIRECTORY + "shader_compact.vert";
+        sources.vertexBinary = SHADER_DIRECTORY + "compact_vert.spv";
+    } else {
+        sources.vertexSource = SHADER_DIRECTORY + "shader.vert";
+        sources.vertexBinary = SHADER_DIRECTORY + "vert.spv";
+    }
+    sources.fragmentSource = SHADER_DIRECTORY + "shader.frag";
+    sources.fragmentBinary = SHADER_DIRECTORY + "frag.spv";
+    return sources;
+}
+
+VkPipeline VulkanGraphicsPipeline::swapPipeline(VkPipeline pipeline) {
+    VkPipeline previous = graphicsPipeline;
+    graphicsPipeline = pipeline;
+    return previous;
+}
+
+void VulkanGraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent){
+    ShaderSources sources = getShaderSources();
+    std::vector<char> vertShaderCode;
+    std::vector<char> fragShaderCode;
+    if (fileReader) {
+        // Both stages in one batch
+        std::vector<std::vector<uint8_t>> files = fileReader->readFiles({sources.vertexBinary, sources.fragmentBinary});
+        vertShaderCode.assign(files[0].begin(), files[0].end());
+        fragShaderCode.assign(files[1].begin(), files[1].end());
+    } else {
+        vertShaderCode = readFile(sources.vertexBinary);
+        fragShaderCode = readFile(sources.fragmentBinary);
     }
 
-    VkPipelineDepthStencilStateCreateInfo depthStencil{};
-    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-    depthStencil.depthTestEnable = VK_TRUE;
-    depthStencil.depthWriteEnable = VK_TRUE;
-    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-    depthStencil.depthBoundsTestEnable = VK_FALSE;
-    depthStencil.minDepthBounds = 0.0f; // Optional
-    depthStencil.maxDepthBounds = 1.0f; // Optional
-    depthStencil.stencilTestEnable = VK_FALSE;
-    depthStencil.front = {}; // Optional
-    depthStencil.back = {}; // Optional
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = &depthStencil;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = -1;
-
-    VkResult result = vkCreateGraphicsPipelines(vulkanDevice->getLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline);
+    LayoutCache::PipelineLayoutInfo layouts = pipelineManager->reflectLayouts(vertexFormat, vertShaderCode, fragShaderCode);
+    descriptorSetLayout = layouts.setLayouts.empty() ? VK_NULL_HANDLE : layouts.setLayouts[0];
+    pipelineLayout = layouts.pipelineLayout;
+    updateBuildKey();
+
+    VkResult result = buildPipeline(getBuildKey(), vertShaderCode, fragShaderCode, graphicsPipeline);
     if (result != VK_SUCCESS) {
         std::cout<< "Failed to create graphics pipeline - " << result << std::endl;
         throw std::runtime_error("failed to create graphics pipeline!");
     }else{
         std::cout<< "Successfully created graphics pipeline - " << result << std::endl;
     }
+}
+
+VulkanGraphicsPipeline::BuildKey VulkanGraphicsPipeline::getBuildKey() const {
+    std::lock_guard<std::mutex> lock(buildKeyMutex);
+    return buildKey;
+}
 
-    vkDestroyShaderModule(vulkanDevice->getLogicalDevice(), fragShaderModule, nullptr);
-    vkDestroyShaderModule(vulkanDevice->getLogicalDevice(), vertShaderModule, nullptr);
+void VulkanGraphicsPipeline::updateBuildKey() {
+    std::lock_guard<std::mutex> lock(buildKeyMutex);
+    buildKey.sources = getShaderSources();
+    buildKey.pipelineKey = getPipelineKey(pipelineState);
+    buildKey.pipelineLayout = pipelineLayout;
+    buildKey.generation++;
 }
 
-VkShaderModule VulkanGraphicsPipeline::createShaderModule(const std::vector<char>& code) {
-    VkShaderModuleCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-    VkShaderModule shaderModule;
-    if (vkCreateShaderModule(vulkanDevice->getLogicalDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create shader module!");
+VkResult VulkanGraphicsPipeline::buildPipeline(const BuildKey& key, const std::vector<char>& vertShaderCode,
+                                               const std::vector<char>& fragShaderCode, VkPipeline& pipeline) const {
+    // Descriptor sets and push constants are recorded against the current layout, so a rebuilt
+    // shader has to keep the same interface
+    LayoutCache::PipelineLayoutInfo layouts;
+    try {
+        layouts = pipelineManager->reflectLayouts(key.pipelineKey.vertexFormat, vertShaderCode, fragShaderCode);
+    } catch (const std::exception& e) {
+        std::cout << "Failed to reflect shaders - " << e.what() << std::endl;
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    if (layouts.pipelineLayout != key.pipelineLayout) {
+        std::cout << "Shader interface changed, the pipeline layout no longer matches" << std::endl;
+        return VK_ERROR_INITIALIZATION_FAILED;
     }
-    return shaderModule;
+
+    return pipelineManager->createPipeline(key.pipelineKey, vertShaderCode, fragShaderCode, key.pipelineLayout, pipeline);
 }
 
 VkFormat VulkanGraphicsPipeline::findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) {
@@ -334,19 +371,3 @@ VkFormat VulkanGraphicsPipeline::findDepthFormat() {
 bool VulkanGraphicsPipeline::hasStencilComponent(VkFormat format) {
     return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 }
-
-std::vector<char> VulkanGraphicsPipeline::readFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file!");
-    }
-
-    size_t fileSize = (size_t) file.tellg();
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-
-    return buffer;
-}
\ No newline at end of file
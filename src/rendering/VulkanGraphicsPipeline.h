@@ -1,24 +1,88 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 #include <string>
 #include "VulkanSwapchain.h"
 #include "../core/VulkanDevice.h"
+#include "../common/VertexTypes.h"
+#include "PipelineManager.h"
+#include "../resources/AsyncFileReader.h"
 
 class VulkanGraphicsPipeline{
     public:
         VulkanGraphicsPipeline();
         ~VulkanGraphicsPipeline();
 
-        void initialize(const VulkanDevice& device, const VulkanSwapchain& swapchain);
+        // With samples above 1 the color and depth attachments are multisampled and the color is
+        // resolved into the swapchain image at the end of the pass
+        void initialize(const VulkanDevice& device, const VulkanSwapchain& swapchain, PipelineManager& pipelineManager,
+                        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
         void cleanup();
+        // Shader binaries are read through it when set; call before initialize()
+        void setFileReader(AsyncFileReader* fileReader) { this->fileReader = fileReader; }
         void recreate(const VulkanSwapchain& swapchain);
+        // Rebuilds the pipeline with the vertex layout and shaders of the given format
+        void setVertexFormat(VertexFormat format);
+        // Rebuilds the pipeline with different fixed-function state
+        void setPipelineState(const PipelineState& state);
+        // Key of a variant that shares this pipeline's shaders, vertex format and render pass, for
+        // use with PipelineManager. Variants are compatible with this pipeline's layout.
+        PipelineKey getPipelineKey(const PipelineState& state) const;
+        // Key of a depth-only variant for a depth prepass: position-only vertex shader, no fragment
+        // stage and no color attachment. Raster state comes from `state`; it always tests LESS and
+        // writes depth. It shares this pipeline's layout, so the same descriptor sets and push
+        // constants apply. Standard meshes are read from the position stream (VertexFormat::Position).
+        PipelineKey getDepthOnlyPipelineKey(const PipelineState& state) const;
 
+        struct ShaderSources {
+            std::string vertexSource;
+            std::string vertexBinary;
+            std::string fragmentSource;
+            std::string fragmentBinary;
+        };
+        // GLSL sources and SPIR-V paths used by the current vertex format
+        ShaderSources getShaderSources() const;
+
+        // Everything the active pipeline was built from, copied whenever the render thread changes it
+        // (recreate, setVertexFormat, setPipelineState)
+        struct BuildKey {
+            ShaderSources sources;
+            PipelineKey pipelineKey;
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+            // Incremented with every change
+            uint64_t generation = 0;
+        };
+        // Snapshot of the current build key, safe to take from any thread
+        BuildKey getBuildKey() const;
+
+        // Creates a pipeline for `key` from SPIR-V. Only reads the key, so it is safe to call from a
+        // worker thread while the render thread changes this object. Fails if the reflected shader
+        // interface needs a different pipeline layout.
+        VkResult buildPipeline(const BuildKey& key, const std::vector<char>& vertShaderCode,
+                               const std::vector<char>& fragShaderCode, VkPipeline& pipeline) const;
+        // Makes `pipeline` the active one and returns the previous pipeline, which the caller
+        // must keep alive until no frame in flight uses it. Render thread only; `pipeline` must
+        // have been built from the current build key (see BuildKey::generation).
+        VkPipeline swapPipeline(VkPipeline pipeline);
+
+        // VK_NULL_HANDLE when the device renders with dynamic rendering; pipelines are then built
+        // against the attachment formats instead
         VkRenderPass getRenderPass() const { return renderPass; }
+        // Depth attachment only, compatible with a depth prepass
+        VkRenderPass getDepthOnlyRenderPass() const { return depthOnlyRenderPass; }
+        // Single sampled swapchain color, loaded: for overlays drawn on the final image (the GUI)
+        VkRenderPass getOverlayRenderPass() const { return overlayRenderPass; }
+        VkFormat getColorFormat() const { return colorFormat; }
+        VkFormat getDepthFormat() const { return depthFormat; }
+        VkSampleCountFlagBits getSampleCount() const { return pipelineState.rasterizationSamples; }
         VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
         VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
         VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
+        VertexFormat getVertexFormat() const { return vertexFormat; }
+        const PipelineState& getPipelineState() const { return pipelineState; }
 
         bool hasStencilComponent(VkFormat format);
         VkFormat findDepthFormat();
@@ -26,20 +90,32 @@ class VulkanGraphicsPipeline{
     private:
         const VulkanDevice* vulkanDevice = nullptr;
         const VulkanSwapchain* vulkanSwapchain = nullptr;
+        PipelineManager* pipelineManager = nullptr;
+        AsyncFileReader* fileReader = nullptr;
 
         VkRenderPass renderPass = VK_NULL_HANDLE;
+        VkRenderPass depthOnlyRenderPass = VK_NULL_HANDLE;
+        VkRenderPass overlayRenderPass = VK_NULL_HANDLE;
+        VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+        VkFormat depthFormat = VK_FORMAT_UNDEFINED;
         VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
         VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
         VkPipeline graphicsPipeline = VK_NULL_HANDLE;
+        VertexFormat vertexFormat = VertexFormat::Standard;
+        PipelineState pipelineState;
+
+        mutable std::mutex buildKeyMutex;
+        BuildKey buildKey;
 
+        // Publishes the current shaders, layout and state as the build key
+        void updateBuildKey();
         void createRenderPass(VkFormat swapChainImageFormat);
-        void createDescriptorSetLayout();
+        void createDepthOnlyRenderPass();
+        void createOverlayRenderPass(VkFormat swapChainImageFormat);
         void createGraphicsPipeline(VkExtent2D swapChainExtent);
 
-        VkShaderModule createShaderModule(const std::vector<char>& code);
         VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
         
 
-        std::vector<char> readFile(const std::string& filename);
 
 };
\ No newline at end of file
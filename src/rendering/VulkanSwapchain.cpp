@@ -33,10 +33,13 @@ void VulkanSwapchain::createSwapChain(GLFWwindow* window){
     SwapChainSupportDetails swapChainSupport = vulkanDevice->querySwapChainSupport(vulkanDevice->getPhysicalDevice());
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-    VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    supportedPresentModes = swapChainSupport.presentModes;
+    surfaceCapabilities = swapChainSupport.capabilities;
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities, window);
 
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+    uint32_t imageCount = requestedImageCount > 0 ? requestedImageCount : swapChainSupport.capabilities.minImageCount + 1;
+    imageCount = std::max(imageCount, swapChainSupport.capabilities.minImageCount);
     if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
         imageCount = swapChainSupport.capabilities.maxImageCount;
     }
@@ -49,7 +52,11 @@ void VulkanSwapchain::createSwapChain(GLFWwindow* window){
     createInfo.imageColorSpace = surfaceFormat.colorSpace;
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Transfer destination for upscaling blits and source for readbacks, where the surface supports it
+    swapChainImageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    swapChainImageUsage |= swapChainSupport.capabilities.supportedUsageFlags &
+                           (VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    createInfo.imageUsage = swapChainImageUsage;
 
     QueueFamilyIndices indices = vulkanDevice->findQueueFamilies(vulkanDevice->getPhysicalDevice());
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -74,7 +81,7 @@ void VulkanSwapchain::createSwapChain(GLFWwindow* window){
         std::cout<< "Failed to create swapchain - " << result << std::endl;
         throw std::runtime_error("failed to create swap chain!");
     }else{
-        std::cout<< "Swapchain created successfully" << std::endl;
+        std::cout<< "Swapchain created successfully - present mode " << presentMode << ", min " << imageCount << " images" << std::endl;
     }
 
     vkGetSwapchainImagesKHR(vulkanDevice->getLogicalDevice(), swapChain, &imageCount, nullptr);
@@ -128,11 +135,12 @@ VkSurfaceFormatKHR VulkanSwapchain::chooseSwapSurfaceFormat(const std::vector<Vk
 
 VkPresentModeKHR VulkanSwapchain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
     for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (availablePresentMode == requestedPresentMode) {
             return availablePresentMode;
         }
     }
 
+    // The only mode every surface supports
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -140,13 +148,15 @@ VkExtent2D VulkanSwapchain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& cap
     if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
         return capabilities.currentExtent;
     } else {
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
-
-        VkExtent2D actualExtent = {
-            static_cast<uint32_t>(width),
-            static_cast<uint32_t>(height)
-        };
+        VkExtent2D actualExtent = fallbackExtent;
+        if (window) {
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            actualExtent = {
+                static_cast<uint32_t>(width),
+                static_cast<uint32_t>(height)
+            };
+        }
 
         actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
         actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
@@ -10,15 +10,32 @@ class VulkanSwapchain{
         VulkanSwapchain();
         ~VulkanSwapchain();
 
+        // window may be null for surfaces without one, see setFallbackExtent
         void initialize(const VulkanDevice& device, VkSurfaceKHR surface, GLFWwindow* window);
         void cleanup();
         void recreate(GLFWwindow* window);
 
+        // Applied by the next initialize() or recreate(). FIFO is used when the surface does not
+        // support the requested mode; an image count of 0 means the surface minimum plus one.
+        void setPresentMode(VkPresentModeKHR mode) { requestedPresentMode = mode; }
+        void setImageCount(uint32_t count) { requestedImageCount = count; }
+        // Size used when the surface leaves it to the application and there is no window to ask,
+        // i.e. for headless surfaces
+        void setFallbackExtent(VkExtent2D extent) { fallbackExtent = extent; }
+
         VkSwapchainKHR getSwapChain() const { return swapChain; }
         const std::vector<VkImage>& getImages() const { return swapChainImages; }
         VkFormat getImageFormat() const { return swapChainImageFormat; }
         VkExtent2D getExtent() const { return swapChainExtent; }
         const std::vector<VkImageView>& getImageViews() const { return swapChainImageViews; }
+        // Always includes COLOR_ATTACHMENT; TRANSFER_DST and TRANSFER_SRC when the surface allows
+        // blitting into and copying out of the images
+        VkImageUsageFlags getImageUsage() const { return swapChainImageUsage; }
+        VkPresentModeKHR getPresentMode() const { return presentMode; }
+        const std::vector<VkPresentModeKHR>& getSupportedPresentModes() const { return supportedPresentModes; }
+        // Image count range the surface allows; a maximum of 0 means no limit
+        uint32_t getMinImageCount() const { return surfaceCapabilities.minImageCount; }
+        uint32_t getMaxImageCount() const { return surfaceCapabilities.maxImageCount; }
 
     private:
         const VulkanDevice* vulkanDevice = nullptr;
@@ -28,6 +45,13 @@ class VulkanSwapchain{
         std::vector<VkImage> swapChainImages;
         VkFormat swapChainImageFormat;
         VkExtent2D swapChainExtent;
+        VkImageUsageFlags swapChainImageUsage = 0;
+        VkPresentModeKHR requestedPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        uint32_t requestedImageCount = 0;
+        VkExtent2D fallbackExtent{800, 600};
+        VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+        std::vector<VkPresentModeKHR> supportedPresentModes;
+        VkSurfaceCapabilitiesKHR surfaceCapabilities{};
         std::vector<VkImageView> swapChainImageViews;
 
         void createSwapChain(GLFWwindow* window);
@@ -0,0 +1,155 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(AssetPack::Header) == 16, "pack header layout changed");
+static_assert(sizeof(AssetPack::Entry) == 48, "pack entry layout changed");
+
+AssetPack::AssetPack() {}
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+void AssetPack::open(const std::string& path, const std::string& mountPoint) {
+    close();
+    this->mountPoint = mountPoint;
+
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("failed to open asset pack: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    mappingSize = static_cast<size_t>(fileSize.QuadPart);
+    mappingHandle = mappingSize > 0 ? CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mappingHandle) {
+        mapping = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("failed to open asset pack: " + path);
+    }
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0) {
+        mappingSize = static_cast<size_t>(fileStat.st_size);
+        void* address = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (address != MAP_FAILED) {
+            mapping = static_cast<const uint8_t*>(address);
+            // Assets are read whole, in no particular order
+            madvise(address, mappingSize, MADV_RANDOM);
+        }
+    }
+#endif
+    if (!mapping) {
+        close();
+        throw std::runtime_error("failed to map asset pack: " + path);
+    }
+
+    const Header* header = reinterpret_cast<const Header*>(mapping);
+    bool valid = mappingSize >= sizeof(Header) && header->magic == MAGIC && header->version == VERSION &&
+                 (mappingSize - sizeof(Header)) / sizeof(Entry) >= header->entryCount;
+    if (valid) {
+        entries = reinterpret_cast<const Entry*>(mapping + sizeof(Header));
+        entryCount = header->entryCount;
+        for (uint32_t i = 0; i < entryCount && valid; i++) {
+            valid = entries[i].offset <= mappingSize && entries[i].size <= mappingSize - entries[i].offset &&
+                    entries[i].pathOffset <= mappingSize && entries[i].pathLength <= mappingSize - entries[i].pathOffset &&
+                    (i == 0 || entries[i - 1].pathHash <= entries[i].pathHash);
+        }
+    }
+    if (!valid) {
+        close();
+        throw std::runtime_error("invalid asset pack: " + path);
+    }
+
+    std::cout << "Successfully mapped asset pack - " << path << ", " << entryCount << " assets, "
+              << mappingSize / (1024 * 1024) << " MiB" << std::endl;
+}
+
+void AssetPack::close() {
+#ifdef _WIN32
+    if (mapping) {
+        UnmapViewOfFile(mapping);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+#else
+    if (mapping) {
+        munmap(const_cast<uint8_t*>(mapping), mappingSize);
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    entries = nullptr;
+    entryCount = 0;
+}
+
+bool AssetPack::find(const std::string& path, Asset& asset) const {
+    if (!mapping) {
+        return false;
+    }
+
+    std::string relativePath = path;
+    std::replace(relativePath.begin(), relativePath.end(), '\\', '/');
+    if (relativePath.compare(0, mountPoint.size(), mountPoint) != 0) {
+        return false;
+    }
+    relativePath.erase(0, mountPoint.size());
+    uint64_t hash = hashPath(relativePath);
+
+    const Entry* end = entries + entryCount;
+    const Entry* entry = std::lower_bound(entries, end, hash,
+                                          [](const Entry& entry, uint64_t hash) { return entry.pathHash < hash; });
+    // Paths that share a hash are next to each other
+    while (entry != end && entry->pathHash == hash &&
+           relativePath.compare(0, std::string::npos, reinterpret_cast<const char*>(mapping + entry->pathOffset),
+                                entry->pathLength) != 0) {
+        entry++;
+    }
+    if (entry == end || entry->pathHash != hash) {
+        return false;
+    }
+
+    asset.data = mapping + entry->offset;
+    asset.size = static_cast<size_t>(entry->size);
+    asset.format = entry->format;
+    asset.width = entry->width;
+    asset.height = entry->height;
+    return true;
+}
+
+uint64_t AssetPack::hashPath(const std::string& relativePath) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : relativePath) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only archive of the assets tree, memory mapped as a whole so loading an asset is a lookup
+// instead of a file open, and loaders read straight from the mapping (e.g. into staging buffers).
+// Built by vulkan_packer.
+//
+// Layout: Header, then Header::entryCount Entries sorted by path hash, then the paths they were
+// packed from, then the blobs, each starting on a BLOB_ALIGNMENT boundary so they are page aligned
+// in the mapping. Lookups go by hash and compare the path, so a collision is never a wrong asset.
+class AssetPack {
+    public:
+        static constexpr uint32_t MAGIC = 0x4b504b56;   // "VKPK"
+        static constexpr uint32_t VERSION = 2;
+        static constexpr uint64_t BLOB_ALIGNMENT = 4096;
+
+        enum class Format : uint32_t {
+            Raw = 0,    // the file as it was
+            Rgba8 = 1   // decoded image, width * height * 4 bytes
+        };
+
+        struct Header {
+            uint32_t magic = MAGIC;
+            uint32_t version = VERSION;
+            uint32_t entryCount = 0;
+            uint32_t reserved = 0;
+        };
+
+        struct Entry {
+            uint64_t pathHash = 0;
+            // From the start of the file
+            uint64_t offset = 0;
+            uint64_t size = 0;
+            // Path relative to the assets root, not null terminated, from the start of the file
+            uint64_t pathOffset = 0;
+            Format format = Format::Raw;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t pathLength = 0;
+        };
+
+        struct Asset {
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+            Format format = Format::Raw;
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        AssetPack();
+        ~AssetPack();
+
+        // Maps the pack. Paths starting with mountPoint (e.g. "../assets/") are looked up relative
+        // to it, so loaders can keep using the paths of the loose files.
+        void open(const std::string& path, const std::string& mountPoint);
+        void close();
+        bool isOpen() const { return mapping != nullptr; }
+        uint32_t getAssetCount() const { return entryCount; }
+
+        // The data stays valid until close()
+        bool find(const std::string& path, Asset& asset) const;
+
+        // FNV-1a of the path relative to the assets root, with '/' separators
+        static uint64_t hashPath(const std::string& relativePath);
+
+    private:
+        const uint8_t* mapping = nullptr;
+        size_t mappingSize = 0;
+        const Entry* entries = nullptr;
+        uint32_t entryCount = 0;
+        std::string mountPoint;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#else
+        int fileDescriptor = -1;
+#endif
+};
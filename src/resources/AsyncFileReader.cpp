@@ -0,0 +1,447 @@
+#include "AsyncFileReader.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_FILE_READER_IO_URING 1
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef ASYNC_FILE_READER_IO_URING
+// The rings shared with the kernel, used through the raw system calls (no liburing dependency)
+struct AsyncFileReader::Ring {
+    int fd = -1;
+    void* sqMapping = MAP_FAILED;
+    size_t sqMappingSize = 0;
+    void* cqMapping = MAP_FAILED;
+    size_t cqMappingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    // One per slot, READV needs the vector to live until the read completes
+    std::vector<iovec> iovecs;
+    unsigned toSubmit = 0;
+
+    int enter(unsigned submit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, minComplete, flags, nullptr, 0));
+    }
+};
+#else
+struct AsyncFileReader::Ring {};
+#endif
+
+AsyncFileReader::AsyncFileReader() {}
+
+AsyncFileReader::~AsyncFileReader() {
+    cleanup();
+}
+
+void AsyncFileReader::initialize(uint32_t queueDepth, uint32_t workerCount, bool preferIoUring) {
+    this->queueDepth = std::max(queueDepth, 1u);
+    stopping = false;
+
+    if (preferIoUring && createRing()) {
+        backend = Backend::IoUring;
+        std::cout << "Successfully created file reader - io_uring, " << freeSlots.size() << " reads in flight" << std::endl;
+        return;
+    }
+
+    backend = Backend::ThreadPool;
+    workerCount = std::max(workerCount, 1u);
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&AsyncFileReader::workerLoop, this);
+    }
+    std::cout << "Successfully created file reader - thread pool, " << workerCount << " workers" << std::endl;
+}
+
+void AsyncFileReader::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queued.clear();
+    }
+    queueCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // The kernel may still write into the destinations, so the reads in flight are waited for
+    while (ring && freeSlots.size() < inFlight.size()) {
+        reapRing(true);
+    }
+    destroyRing();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    completed.clear();
+    pending = 0;
+}
+
+const char* AsyncFileReader::getBackendName(Backend backend) {
+    return backend == Backend::IoUring ? "io_uring" : "thread pool";
+}
+
+void AsyncFileReader::submit(const std::vector<Request>& requests) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Request& request : requests) {
+            auto read = std::make_unique<Read>();
+            read->request = request;
+            queued.push_back(std::move(read));
+        }
+        pending += requests.size();
+    }
+
+    if (backend == Backend::IoUring) {
+        submitToRing();
+    } else {
+        queueCondition.notify_all();
+    }
+}
+
+size_t AsyncFileReader::poll(std::vector<Completion>& completions, bool wait) {
+    if (backend == Backend::IoUring) {
+        reapRing(false);
+        submitToRing();
+        // A completion may only resubmit the rest of a short read, so wait until one is delivered
+        while (wait && getPendingCount() > 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!completed.empty()) {
+                    break;
+                }
+            }
+            reapRing(true);
+            submitToRing();
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait) {
+        completedCondition.wait(lock, [this] { return !completed.empty() || pending == completed.size(); });
+    }
+    size_t count = completed.size();
+    for (Completion& completion : completed) {
+        completions.push_back(std::move(completion));
+    }
+    completed.clear();
+    pending -= count;
+    return count;
+}
+
+void AsyncFileReader::waitAll(std::vector<Completion>& completions) {
+    while (getPendingCount() > 0) {
+        poll(completions, true);
+    }
+}
+
+std::vector<std::vector<uint8_t>> AsyncFileReader::readFiles(const std::vector<std::string>& paths) {
+    std::vector<Request> requests(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        requests[i].path = paths[i];
+        requests[i].userData = i;
+    }
+    submit(requests);
+
+    std::vector<Completion> completions;
+    waitAll(completions);
+    std::vector<std::vector<uint8_t>> files(paths.size());
+    for (Completion& completion : completions) {
+        if (completion.error != 0) {
+            throw std::runtime_error("failed to read file " + paths[completion.userData] + ": " + std::strerror(completion.error));
+        }
+        files[completion.userData] = std::move(completion.data);
+    }
+    return files;
+}
+
+size_t AsyncFileReader::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+void AsyncFileReader::workerLoop() {
+    while (true) {
+        std::unique_ptr<Read> read;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueCondition.wait(lock, [this] { return stopping || !queued.empty(); });
+            if (stopping) {
+                return;
+            }
+            read = std::move(queued.front());
+            queued.pop_front();
+        }
+        readBlocking(*read);
+        complete(std::move(read));
+    }
+}
+
+void AsyncFileReader::readBlocking(Read& read) {
+    std::ifstream file(read.request.path, std::ios::binary);
+    if (!file.is_open()) {
+        read.error = ENOENT;
+        return;
+    }
+
+    uint64_t size = read.request.size;
+    if (size == 0) {
+        file.seekg(0, std::ios::end);
+        uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        size = fileSize > read.request.offset ? fileSize - read.request.offset : 0;
+    }
+    read.destination = static_cast<uint8_t*>(read.request.destination);
+    if (!read.destination) {
+        read.data.resize(static_cast<size_t>(size));
+        read.destination = read.data.data();
+    }
+
+    file.seekg(static_cast<std::streamoff>(read.request.offset));
+    file.read(reinterpret_cast<char*>(read.destination), static_cast<std::streamsize>(size));
+    read.bytesRead = static_cast<uint64_t>(file.gcount());
+    if (read.bytesRead != size) {
+        read.error = EIO;
+    }
+}
+
+void AsyncFileReader::complete(std::unique_ptr<Read> read) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Completion completion;
+        completion.userData = read->request.userData;
+        completion.data = std::move(read->data);
+        completion.bytesRead = read->bytesRead;
+        completion.error = read->error;
+        completed.push_back(std::move(completion));
+    }
+    completedCondition.notify_all();
+}
+
+#ifdef ASYNC_FILE_READER_IO_URING
+
+bool AsyncFileReader::createRing() {
+    io_uring_params params{};
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+    if (fd < 0) {
+        std::cout << "io_uring unavailable, using the thread pool - " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    ring = std::make_unique<Ring>();
+    ring->fd = fd;
+    ring->sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    // Newer kernels map both rings with one call
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->sqMappingSize = std::max(ring->sqMappingSize, ring->cqMappingSize);
+    }
+    ring->sqMapping = mmap(nullptr, ring->sqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cqMapping = ring->sqMapping;
+    } else if (ring->sqMapping != MAP_FAILED) {
+        ring->cqMapping = mmap(nullptr, ring->cqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqMapping == MAP_FAILED || ring->cqMapping == MAP_FAILED || sqes == MAP_FAILED) {
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, ring->sqesSize);
+        }
+        destroyRing();
+        std::cout << "io_uring unavailable, using the thread pool - failed to map the rings" << std::endl;
+        return false;
+    }
+    ring->sqes = static_cast<io_uring_sqe*>(sqes);
+
+    uint8_t* sq = static_cast<uint8_t*>(ring->sqMapping);
+    ring->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    uint8_t* cq = static_cast<uint8_t*>(ring->cqMapping);
+    ring->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Each read has at most one entry queued, so the submission queue can never overflow
+    ring->iovecs.resize(params.sq_entries);
+    inFlight.resize(params.sq_entries);
+    for (uint32_t slot = params.sq_entries; slot-- > 0;) {
+        freeSlots.push_back(slot);
+    }
+    return true;
+}
+
+void AsyncFileReader::destroyRing() {
+    if (!ring) {
+        return;
+    }
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+    if (ring->cqMapping != MAP_FAILED && ring->cqMapping != ring->sqMapping) {
+        munmap(ring->cqMapping, ring->cqMappingSize);
+    }
+    if (ring->sqMapping != MAP_FAILED) {
+        munmap(ring->sqMapping, ring->sqMappingSize);
+    }
+    close(ring->fd);
+    ring.reset();
+    inFlight.clear();
+    freeSlots.clear();
+}
+
+void AsyncFileReader::submitToRing() {
+    while (!freeSlots.empty()) {
+        std::unique_ptr<Read> read;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queued.empty()) {
+                break;
+            }
+            read = std::move(queued.front());
+            queued.pop_front();
+        }
+
+        // Opened here, on the submitting thread; only the reads are asynchronous
+        read->file = open(read->request.path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat fileStat;
+        if (read->file < 0 || (read->request.size == 0 && fstat(read->file, &fileStat) != 0)) {
+            read->error = errno;
+        } else if (read->request.size == 0) {
+            uint64_t fileSize = static_cast<uint64_t>(fileStat.st_size);
+            read->request.size = fileSize > read->request.offset ? fileSize - read->request.offset : 0;
+        }
+        if (read->error == 0) {
+            read->destination = static_cast<uint8_t*>(read->request.destination);
+            if (!read->destination) {
+                read->data.resize(static_cast<size_t>(read->request.size));
+                read->destination = read->data.data();
+            }
+        }
+        if (read->error != 0 || read->request.size == 0) {
+            if (read->file >= 0) {
+                close(read->file);
+            }
+            complete(std::move(read));
+            continue;
+        }
+
+        uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        inFlight[slot] = std::move(read);
+        queueRingRead(slot);
+    }
+
+    while (ring && ring->toSubmit > 0) {
+        int submitted = ring->enter(ring->toSubmit, 0, 0);
+        if (submitted < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Out of kernel resources for now: reaping completions frees them
+            if (errno == EAGAIN || errno == EBUSY) {
+                break;
+            }
+            throw std::runtime_error(std::string("failed to submit file reads: ") + std::strerror(errno));
+        }
+        ring->toSubmit -= static_cast<unsigned>(submitted);
+    }
+}
+
+void AsyncFileReader::reapRing(bool wait) {
+    if (!ring || freeSlots.size() == inFlight.size()) {
+        return;
+    }
+
+    unsigned head = *ring->cqHead;
+    if (wait && head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+        int submitted = ring->enter(ring->toSubmit, 1, IORING_ENTER_GETEVENTS);
+        if (submitted >= 0) {
+            ring->toSubmit -= static_cast<unsigned>(submitted);
+        } else if (errno != EINTR) {
+            throw std::runtime_error(std::string("failed to wait for file reads: ") + std::strerror(errno));
+        }
+    }
+
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        const io_uring_cqe& cqe = ring->cqes[head & ring->cqMask];
+        uint32_t slot = static_cast<uint32_t>(cqe.user_data);
+        Read& read = *inFlight[slot];
+        if (cqe.res > 0) {
+            read.bytesRead += static_cast<uint64_t>(cqe.res);
+            if (read.bytesRead < read.request.size) {
+                queueRingRead(slot);
+                continue;
+            }
+        } else if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            queueRingRead(slot);
+            continue;
+        } else {
+            // The file shrank since it was opened, or the read failed
+            read.error = cqe.res < 0 ? -cqe.res : EIO;
+        }
+
+        close(read.file);
+        complete(std::move(inFlight[slot]));
+        freeSlots.push_back(slot);
+    }
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+}
+
+void AsyncFileReader::queueRingRead(uint32_t slot) {
+    Read& read = *inFlight[slot];
+    iovec& vector = ring->iovecs[slot];
+    vector.iov_base = read.destination + read.bytesRead;
+    vector.iov_len = static_cast<size_t>(read.request.size - read.bytesRead);
+
+    // Only this thread produces entries, so the tail can be read without synchronization
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail & ring->sqMask;
+    io_uring_sqe& sqe = ring->sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = read.file;
+    sqe.addr = reinterpret_cast<uint64_t>(&vector);
+    sqe.len = 1;
+    sqe.off = read.request.offset + read.bytesRead;
+    sqe.user_data = slot;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->toSubmit++;
+}
+
+#else
+
+bool AsyncFileReader::createRing() {
+    return false;
+}
+
+void AsyncFileReader::destroyRing() {}
+
+void AsyncFileReader::submitToRing() {}
+
+void AsyncFileReader::reapRing(bool wait) {}
+
+void AsyncFileReader::queueRingRead(uint32_t slot) {}
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads files in the background so loaders can overlap I/O with decoding and uploads. A batch of
+// reads is queued with submit(); completions are collected with poll() on the loader's thread.
+//
+// On Linux the reads go through io_uring, keeping up to queueDepth reads in flight from one
+// thread, which is what it takes to keep an NVMe drive busy. Elsewhere, or where io_uring is
+// unavailable (old kernels, seccomp filtered containers), a pool of threads issues blocking reads.
+class AsyncFileReader {
+    public:
+        enum class Backend {
+            IoUring,
+            ThreadPool
+        };
+
+        struct Request {
+            std::string path;
+            uint64_t offset = 0;
+            // 0 reads from offset to the end of the file
+            uint64_t size = 0;
+            // Where the data goes, e.g. a mapped staging buffer; must hold `size` bytes and stay
+            // valid until the read completes. When null the reader allocates Completion::data.
+            void* destination = nullptr;
+            uint64_t userData = 0;
+        };
+
+        struct Completion {
+            uint64_t userData = 0;
+            // Filled when the request had no destination
+            std::vector<uint8_t> data;
+            uint64_t bytesRead = 0;
+            // errno value, 0 on success
+            int error = 0;
+        };
+
+        AsyncFileReader();
+        ~AsyncFileReader();
+
+        // preferIoUring false forces the thread pool
+        void initialize(uint32_t queueDepth = 64, uint32_t workerCount = 4, bool preferIoUring = true);
+        // Waits for the reads in flight; their completions are dropped
+        void cleanup();
+
+        Backend getBackend() const { return backend; }
+        static const char* getBackendName(Backend backend);
+
+        // Queues the reads. With io_uring, as many as fit are submitted in one system call.
+        void submit(const std::vector<Request>& requests);
+        // Appends the reads completed so far. With wait, blocks until at least one is available
+        // unless nothing is pending. Returns the number appended.
+        size_t poll(std::vector<Completion>& completions, bool wait);
+        // Blocks until every submitted read completed
+        void waitAll(std::vector<Completion>& completions);
+        // Reads whole files in one batch and waits for them, in the order of paths. For loaders that
+        // need the data right away; nothing else may be pending. Throws if any read failed.
+        std::vector<std::vector<uint8_t>> readFiles(const std::vector<std::string>& paths);
+        size_t getPendingCount() const;
+
+    private:
+        struct Read {
+            Request request;
+            std::vector<uint8_t> data;
+            uint8_t* destination = nullptr;
+            uint64_t bytesRead = 0;
+            int file = -1;
+            int error = 0;
+        };
+        struct Ring;
+
+        Backend backend = Backend::ThreadPool;
+        uint32_t queueDepth = 0;
+
+        mutable std::mutex mutex;
+        std::condition_variable queueCondition;
+        std::condition_variable completedCondition;
+        std::deque<std::unique_ptr<Read>> queued;
+        std::deque<Completion> completed;
+        // Submitted and not yet polled
+        size_t pending = 0;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+
+        // io_uring backend, only touched by the thread calling submit/poll
+        std::unique_ptr<Ring> ring;
+        std::vector<std::unique_ptr<Read>> inFlight;
+        std::vector<uint32_t> freeSlots;
+
+        void workerLoop();
+        void readBlocking(Read& read);
+        void complete(std::unique_ptr<Read> read);
+
+        bool createRing();
+        void destroyRing();
+        // Moves queued reads into free ring slots and submits them
+        void submitToRing();
+        // Handles finished ring reads; with wait, blocks for at least one when any are in flight
+        void reapRing(bool wait);
+        void queueRingRead(uint32_t slot);
+};
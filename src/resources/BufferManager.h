@@ -7,8 +7,6 @@
 #include "../common/Vertex.h"
 #include "../common/VertexTypes.h"
 
-struct UniformBufferObject;
-
 class BufferManager {
     public:
         BufferManager();
@@ -19,9 +17,15 @@ class BufferManager {
 
         void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
                      VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+        // Uploads data through a staging buffer into a new device local buffer with the given usage
+        void createDeviceLocalBuffer(const void* data, VkDeviceSize bufferSize, VkBufferUsageFlags usage,
+                                     VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+        // Writes data into an existing device local buffer through a staging buffer
+        void uploadToBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset);
 
         void createVertexBuffer(const std::vector<StandardVertex>& vertices, VkBuffer& vertexBuffer, VkDeviceMemory& vertexBufferMemory);
+        void createVertexBuffer(const void* vertexData, VkDeviceSize bufferSize, VkBuffer& vertexBuffer, VkDeviceMemory& vertexBufferMemory);
         void createIndexBuffer(const std::vector<uint32_t>& indices, VkBuffer& indexBuffer, VkDeviceMemory& indexBufferMemory);
         void createUniformBuffer(uint32_t maxFramesInFlight, std::vector<VkBuffer>& uniformBuffers, 
                              std::vector<VkDeviceMemory>& uniformBuffersMemory, 
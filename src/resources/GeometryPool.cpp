@@ -0,0 +1,139 @@
+#include "GeometryPool.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <iterator>
+
+void RangeAllocator::reset(uint32_t capacity) {
+    this->capacity = capacity;
+    freeSize = capacity;
+    freeRanges.clear();
+    if (capacity > 0) {
+        freeRanges[0] = capacity;
+    }
+}
+
+bool RangeAllocator::allocate(uint32_t size, uint32_t& offset) {
+    if (size == 0) {
+        offset = 0;
+        return true;
+    }
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < size) {
+            continue;
+        }
+        offset = it->first;
+        uint32_t remaining = it->second - size;
+        freeRanges.erase(it);
+        if (remaining > 0) {
+            freeRanges[offset + size] = remaining;
+        }
+        freeSize -= size;
+        return true;
+    }
+    return false;
+}
+
+void RangeAllocator::free(uint32_t offset, uint32_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    auto inserted = freeRanges.emplace(offset, size).first;
+    freeSize += size;
+
+    auto next = std::next(inserted);
+    if (next != freeRanges.end() && inserted->first + inserted->second == next->first) {
+        inserted->second += next->second;
+        freeRanges.erase(next);
+    }
+    if (inserted != freeRanges.begin()) {
+        auto previous = std::prev(inserted);
+        if (previous->first + previous->second == inserted->first) {
+            previous->second += inserted->second;
+            freeRanges.erase(inserted);
+        }
+    }
+}
+
+GeometryPool::GeometryPool() {}
+
+GeometryPool::~GeometryPool() {
+    cleanup();
+}
+
+void GeometryPool::initialize(const VulkanDevice& device, BufferManager& bufMgr,
+                              VkDeviceSize vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity,
+                              bool positionStream) {
+    this->vulkanDevice = &device;
+    this->bufferManager = &bufMgr;
+    this->vertexStride = vertexStride;
+
+    bufferManager->createBuffer(vertexStride * vertexCapacity,
+                                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
+    bufferManager->createBuffer(sizeof(uint32_t) * static_cast<VkDeviceSize>(indexCapacity),
+                                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
+    if (positionStream) {
+        bufferManager->createBuffer(sizeof(BasicVertex) * static_cast<VkDeviceSize>(vertexCapacity),
+                                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, positionBuffer, positionBufferMemory);
+    }
+
+    vertexAllocator.reset(vertexCapacity);
+    indexAllocator.reset(indexCapacity);
+
+    std::cout << "Created geometry pool - " << vertexCapacity << " vertices (" << vertexStride << " bytes each), "
+              << indexCapacity << " indices" << (positionStream ? ", position stream" : "") << std::endl;
+}
+
+void GeometryPool::cleanup() {
+    if (bufferManager) {
+        bufferManager->destroyBuffer(vertexBuffer, vertexBufferMemory);
+        bufferManager->destroyBuffer(indexBuffer, indexBufferMemory);
+        bufferManager->destroyBuffer(positionBuffer, positionBufferMemory);
+        bufferManager = nullptr;
+    }
+}
+
+MeshAllocation GeometryPool::allocate(const void* vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices,
+                                      const BasicVertex* positions) {
+    if (positionBuffer != VK_NULL_HANDLE && vertexCount > 0 && !positions) {
+        throw std::runtime_error("geometry pool has a position stream but no positions were given!");
+    }
+
+    MeshAllocation allocation;
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = static_cast<uint32_t>(indices.size());
+
+    uint32_t vertexOffset = 0;
+    if (!vertexAllocator.allocate(vertexCount, vertexOffset)) {
+        throw std::runtime_error("geometry pool is out of vertex space!");
+    }
+    if (!indexAllocator.allocate(allocation.indexCount, allocation.firstIndex)) {
+        vertexAllocator.free(vertexOffset, vertexCount);
+        throw std::runtime_error("geometry pool is out of index space!");
+    }
+    allocation.vertexOffset = static_cast<int32_t>(vertexOffset);
+
+    if (vertexCount > 0) {
+        bufferManager->uploadToBuffer(vertexData, vertexStride * vertexCount, vertexBuffer, vertexStride * vertexOffset);
+        if (positionBuffer != VK_NULL_HANDLE) {
+            bufferManager->uploadToBuffer(positions, sizeof(BasicVertex) * static_cast<VkDeviceSize>(vertexCount),
+                                          positionBuffer, sizeof(BasicVertex) * static_cast<VkDeviceSize>(vertexOffset));
+        }
+    }
+    if (!indices.empty()) {
+        bufferManager->uploadToBuffer(indices.data(), sizeof(uint32_t) * indices.size(), indexBuffer,
+                                      sizeof(uint32_t) * static_cast<VkDeviceSize>(allocation.firstIndex));
+    }
+
+    return allocation;
+}
+
+void GeometryPool::free(const MeshAllocation& allocation) {
+    vertexAllocator.free(static_cast<uint32_t>(allocation.vertexOffset), allocation.vertexCount);
+    indexAllocator.free(allocation.firstIndex, allocation.indexCount);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include "../core/VulkanDevice.h"
+#include "../common/VertexTypes.h"
+#include "BufferManager.h"
+
+// Location of a mesh inside the pool, enough to draw it without binding anything else
+struct MeshAllocation {
+    int32_t vertexOffset = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t vertexCount = 0;
+
+    VkDrawIndexedIndirectCommand drawCommand(uint32_t instanceCount = 1, uint32_t firstInstance = 0) const {
+        return {indexCount, instanceCount, firstIndex, vertexOffset, firstInstance};
+    }
+};
+
+// First fit free list over [0, capacity) with coalescing of neighbouring free ranges
+class RangeAllocator {
+    public:
+        void reset(uint32_t capacity);
+        bool allocate(uint32_t size, uint32_t& offset);
+        void free(uint32_t offset, uint32_t size);
+
+        uint32_t getCapacity() const { return capacity; }
+        uint32_t getFreeSize() const { return freeSize; }
+
+    private:
+        std::map<uint32_t, uint32_t> freeRanges; // offset -> size
+        uint32_t capacity = 0;
+        uint32_t freeSize = 0;
+};
+
+// One device local vertex buffer and one index buffer shared by every mesh of a vertex format.
+// Meshes are sub-allocated, so a whole scene draws after a single bind and can be merged
+// into multi-draw indirect calls.
+//
+// The pool can also keep a position-only stream (BasicVertex) parallel to the vertex buffer, for
+// depth-only passes that would otherwise fetch full vertices. Both streams share vertex offsets,
+// so the same indices and indirect draws work with either.
+class GeometryPool {
+    public:
+        GeometryPool();
+        ~GeometryPool();
+
+        void initialize(const VulkanDevice& device, BufferManager& bufferManager,
+                        VkDeviceSize vertexStride, uint32_t vertexCapacity, uint32_t indexCapacity,
+                        bool positionStream = false);
+        void cleanup();
+
+        // Indices stay relative to the mesh, the returned vertexOffset is applied at draw time.
+        // `positions` fills the position stream and is required when the pool has one.
+        MeshAllocation allocate(const void* vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices,
+                                const BasicVertex* positions = nullptr);
+        void free(const MeshAllocation& allocation);
+
+        VkBuffer getVertexBuffer() const { return vertexBuffer; }
+        VkBuffer getIndexBuffer() const { return indexBuffer; }
+        // VK_NULL_HANDLE unless the pool was created with a position stream
+        VkBuffer getPositionBuffer() const { return positionBuffer; }
+        VkDeviceSize getVertexStride() const { return vertexStride; }
+
+    private:
+        const VulkanDevice* vulkanDevice = nullptr;
+        BufferManager* bufferManager = nullptr;
+        VkDeviceSize vertexStride = 0;
+
+        VkBuffer vertexBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+        VkBuffer positionBuffer = VK_NULL_HANDLE;
+        VkDeviceMemory positionBufferMemory = VK_NULL_HANDLE;
+
+        RangeAllocator vertexAllocator;
+        RangeAllocator indexAllocator;
+};
@@ -0,0 +1,161 @@
+#include "ImageWriter.h"
+#include "../common/PixelConvert.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    std::array<uint32_t, 256> makeCrcTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }
+}
+
+void ImageWriter::writePng(const std::string& path, const ImageRgba8& image) {
+    std::vector<uint8_t> png;
+    encodePng(image, png);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open image file for writing: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    if (!file.good()) {
+        throw std::runtime_error("failed to write image file: " + path);
+    }
+}
+
+void ImageWriter::encodePng(const ImageRgba8& image, std::vector<uint8_t>& png) {
+    encodePng(image.pixels.data(), image.width, image.height, false, png);
+}
+
+void ImageWriter::encodePng(const uint8_t* pixels, uint32_t width, uint32_t height, bool bgra, std::vector<uint8_t>& png) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    png.assign(signature, signature + 8);
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, width);
+    appendBigEndian(header, height);
+    header.push_back(8);    // bit depth
+    header.push_back(2);    // truecolor RGB
+    header.push_back(0);    // deflate
+    header.push_back(0);    // adaptive filtering
+    header.push_back(0);    // no interlace
+    appendChunk(png, "IHDR", header);
+
+    // Scanlines with filter type 0, each RGB
+    size_t rowSize = static_cast<size_t>(width) * 3 + 1;
+    std::vector<uint8_t> raw(rowSize * height);
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* row = &raw[y * rowSize];
+        row[0] = 0;
+        PixelConvert::rgbaToRgb(pixels + static_cast<size_t>(y) * width * 4, row + 1, width, bgra);
+    }
+
+    // zlib stream of stored deflate blocks, at most 65535 bytes each
+    std::vector<uint8_t> data;
+    data.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    data.push_back(0x78);
+    data.push_back(0x01);
+    size_t offset = 0;
+    do {
+        size_t blockSize = std::min<size_t>(raw.size() - offset, 65535);
+        bool last = offset + blockSize == raw.size();
+        data.push_back(last ? 1 : 0);
+        data.push_back(static_cast<uint8_t>(blockSize));
+        data.push_back(static_cast<uint8_t>(blockSize >> 8));
+        data.push_back(static_cast<uint8_t>(~blockSize));
+        data.push_back(static_cast<uint8_t>(~blockSize >> 8));
+        data.insert(data.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t value : raw) {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(data, (b << 16) | a);
+    appendChunk(png, "IDAT", data);
+
+    appendChunk(png, "IEND", {});
+}
+
+std::string ImageWriter::getY4mHeader(uint32_t width, uint32_t height, double frameRate) {
+    char rate[16];
+    double millihertz = std::clamp(std::round(frameRate * 1000.0), 1.0, 999999999.0);
+    std::snprintf(rate, sizeof(rate), "%09u", static_cast<uint32_t>(millihertz));
+    return "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" + rate +
+           ":1000 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+}
+
+void ImageWriter::encodeI420(const uint8_t* pixels, uint32_t width, uint32_t height, bool bgra, std::vector<uint8_t>& yuv) {
+    size_t red = bgra ? 2 : 0;
+    size_t blue = bgra ? 0 : 2;
+    uint32_t chromaWidth = (width + 1) / 2;
+    uint32_t chromaHeight = (height + 1) / 2;
+    size_t lumaSize = static_cast<size_t>(width) * height;
+    size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    yuv.resize(lumaSize + 2 * chromaSize);
+    uint8_t* lumaPlane = yuv.data();
+    uint8_t* uPlane = lumaPlane + lumaSize;
+    uint8_t* vPlane = uPlane + chromaSize;
+
+    // Full range BT.601 in 16.16 fixed point; chroma from the average of each 2x2 block
+    for (uint32_t cy = 0; cy < chromaHeight; cy++) {
+        for (uint32_t cx = 0; cx < chromaWidth; cx++) {
+            int32_t sumR = 0, sumG = 0, sumB = 0, count = 0;
+            for (uint32_t y = cy * 2; y < std::min(cy * 2 + 2, height); y++) {
+                for (uint32_t x = cx * 2; x < std::min(cx * 2 + 2, width); x++) {
+                    const uint8_t* pixel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+                    int32_t r = pixel[red], g = pixel[1], b = pixel[blue];
+                    lumaPlane[static_cast<size_t>(y) * width + x] =
+                        static_cast<uint8_t>((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+                    sumR += r;
+                    sumG += g;
+                    sumB += b;
+                    count++;
+                }
+            }
+            int32_t r = sumR / count, g = sumG / count, b = sumB / count;
+            int32_t u = ((-11059 * r - 21709 * g + 32768 * b + 32768) >> 16) + 128;
+            int32_t v = ((32768 * r - 27439 * g - 5329 * b + 32768) >> 16) + 128;
+            uPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::clamp(u, 0, 255));
+            vPlane[static_cast<size_t>(cy) * chromaWidth + cx] = static_cast<uint8_t>(std::clamp(v, 0, 255));
+        }
+    }
+}
+
+uint32_t ImageWriter::crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void ImageWriter::appendChunk(std::vector<uint8_t>& png, const char type[4], const std::vector<uint8_t>& data) {
+    appendBigEndian(png, static_cast<uint32_t>(data.size()));
+    size_t typeOffset = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    appendBigEndian(png, crc32(&png[typeOffset], png.size() - typeOffset));
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../common/ImageTypes.h"
+
+// Minimal image file encoders without external dependencies, for golden images and captures.
+// PNGs are written as 8-bit RGB with uncompressed deflate blocks: large, but lossless, quick to
+// encode and readable by every tool (and by stb_image, see TextureManager::loadPixels).
+//
+// The pointer variants take tightly packed 8-bit pixels in RGBA or, with bgra, BGRA order, so
+// mapped readback buffers can be encoded without converting them first.
+class ImageWriter {
+    public:
+        // Alpha is dropped
+        static void writePng(const std::string& path, const ImageRgba8& image);
+        static void encodePng(const ImageRgba8& image, std::vector<uint8_t>& png);
+        static void encodePng(const uint8_t* pixels, uint32_t width, uint32_t height, bool bgra, std::vector<uint8_t>& png);
+
+        // YUV4MPEG2 stream header for 4:2:0 frames (C420jpeg siting) with full range BT.601 colors
+        // (XCOLORRANGE=FULL), which ffmpeg reads directly. Each frame is "FRAME\n" followed by encodeI420.
+        // The frame rate is written in millihertz at a fixed width, so a header can be overwritten in
+        // place once the rate of a stream is known.
+        static std::string getY4mHeader(uint32_t width, uint32_t height, double frameRate);
+        static const char* getY4mFrameHeader() { return "FRAME\n"; }
+        // Planar Y, U, V with chroma subsampled 2x2, (width + 1) / 2 by (height + 1) / 2
+        static void encodeI420(const uint8_t* pixels, uint32_t width, uint32_t height, bool bgra, std::vector<uint8_t>& yuv);
+
+    private:
+        static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+        static void appendChunk(std::vector<uint8_t>& png, const char type[4], const std::vector<uint8_t>& data);
+};
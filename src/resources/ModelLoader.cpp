@@ -0,0 +1,309 @@
+#include "ModelLoader.h"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <streambuf>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Read-only view of memory as a stream, so packed models are parsed in place
+    class MemoryStreamBuffer : public std::streambuf {
+        public:
+            MemoryStreamBuffer(const uint8_t* data, size_t size) {
+                char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+                setg(begin, begin, begin + size);
+            }
+    };
+
+    // Reads the .mtl files a model names from the pack when it has them, else from disk, relative
+    // to the model's directory
+    class PackMaterialReader : public tinyobj::MaterialReader {
+        public:
+            PackMaterialReader(const AssetPack* assetPack, const std::string& directory)
+                : assetPack(assetPack), directory(directory), fileReader(directory) {}
+
+            bool operator()(const std::string& materialId, std::vector<tinyobj::material_t>* materials,
+                            std::map<std::string, int>* materialMap, std::string* warn, std::string* err) override {
+                AssetPack::Asset asset;
+                if (!assetPack || !assetPack->find(directory + materialId, asset)) {
+                    return fileReader(materialId, materials, materialMap, warn, err);
+                }
+                MemoryStreamBuffer buffer(asset.data, asset.size);
+                std::istream stream(&buffer);
+                tinyobj::LoadMtl(materialMap, materials, &stream, warn, err);
+                return true;
+            }
+
+        private:
+            const AssetPack* assetPack;
+            std::string directory;
+            tinyobj::MaterialFileReader fileReader;
+    };
+
+    uint16_t quantizeUnorm16(float value, float offset, float scale) {
+        if (scale <= 0.0f) {
+            return 0;
+        }
+        float normalized = std::clamp((value - offset) / scale, 0.0f, 1.0f);
+        return static_cast<uint16_t>(std::lround(normalized * 65535.0f));
+    }
+
+    int8_t quantizeSnorm8(float value) {
+        return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+    }
+
+    // Octahedral mapping of a unit vector onto the [-1, 1] square
+    glm::vec2 encodeOctahedral(glm::vec3 n) {
+        n /= (std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+        glm::vec2 result(n.x, n.y);
+        if (n.z < 0.0f) {
+            result.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            result.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return result;
+    }
+}
+
+const void* MeshData::vertexData() const {
+    if (format == VertexFormat::Compact) {
+        return compactVertices.data();
+    }
+    return vertices.data();
+}
+
+size_t MeshData::vertexCount() const {
+    if (format == VertexFormat::Compact) {
+        return compactVertices.size();
+    }
+    return vertices.size();
+}
+
+VkDeviceSize MeshData::vertexStride() const {
+    if (format == VertexFormat::Compact) {
+        return sizeof(CompactVertex);
+    }
+    return sizeof(StandardVertex);
+}
+
+MeshData ModelLoader::loadObj(const std::string& modelPath) {
+    return loadObj(modelPath, Options{});
+}
+
+MeshData ModelLoader::loadObj(const std::string& modelPath, const Options& options) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    // Materials are looked up next to the model however the model itself is read
+    size_t separator = modelPath.find_last_of("/\\");
+    std::string modelDirectory = separator == std::string::npos ? "" : modelPath.substr(0, separator + 1);
+    PackMaterialReader materialReader(options.assetPack, modelDirectory);
+
+    AssetPack::Asset asset;
+    if (options.assetPack && options.assetPack->find(modelPath, asset)) {
+        MemoryStreamBuffer buffer(asset.data, asset.size);
+        std::istream stream(&buffer);
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, &materialReader)) {
+            throw std::runtime_error(err);
+        }
+    } else if (options.fileReader) {
+        std::vector<uint8_t> data = std::move(options.fileReader->readFiles({modelPath})[0]);
+        MemoryStreamBuffer buffer(data.data(), data.size());
+        std::istream stream(&buffer);
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, &materialReader)) {
+            throw std::runtime_error(err);
+        }
+    } else if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath.c_str(), modelDirectory.c_str())) {
+        throw std::runtime_error(err);
+    }
+
+    MeshData mesh;
+    // Smooth normals accumulated per unique vertex, only used by the compact format
+    std::vector<glm::vec3> normals;
+    std::unordered_map<StandardVertex, uint32_t> uniqueVertices{};
+
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            StandardVertex vertex{};
+
+            vertex.pos = {
+                attrib.vertices[3 * index.vertex_index + 0],
+                attrib.vertices[3 * index.vertex_index + 1],
+                attrib.vertices[3 * index.vertex_index + 2]
+            };
+
+            vertex.texCoord = {
+                attrib.texcoords[2 * index.texcoord_index + 0],
+                1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+            };
+
+            vertex.color = {1.0f, 1.0f, 1.0f};
+
+            if (uniqueVertices.count(vertex) == 0) {
+                uniqueVertices[vertex] = static_cast<uint32_t>(mesh.vertices.size());
+                mesh.vertices.push_back(vertex);
+                normals.push_back(glm::vec3(0.0f));
+            }
+
+            uint32_t vertexIndex = uniqueVertices[vertex];
+            if (index.normal_index >= 0) {
+                normals[vertexIndex] += glm::vec3(
+                    attrib.normals[3 * index.normal_index + 0],
+                    attrib.normals[3 * index.normal_index + 1],
+                    attrib.normals[3 * index.normal_index + 2]
+                );
+            }
+
+            mesh.indices.push_back(vertexIndex);
+        }
+    }
+
+    if (!mesh.vertices.empty()) {
+        mesh.boundsMin = mesh.boundsMax = mesh.vertices[0].pos;
+        for (const auto& vertex : mesh.vertices) {
+            mesh.boundsMin = glm::min(mesh.boundsMin, vertex.pos);
+            mesh.boundsMax = glm::max(mesh.boundsMax, vertex.pos);
+        }
+    }
+
+    if (options.allowCompactVertices && canUseCompactVertices(mesh, options)) {
+        quantize(mesh, normals);
+    }
+
+    buildLods(mesh, options);
+
+    std::cout << "Loaded model " << modelPath << " - " << mesh.vertexCount() << " vertices, "
+              << mesh.lods[0].indexCount / 3 << " triangles, " << mesh.lods.size() << " LODs, "
+              << mesh.meshlets.size() << " meshlets, "
+              << (mesh.format == VertexFormat::Compact ? "compact" : "standard") << " vertex format ("
+              << mesh.vertexStride() << " bytes)" << std::endl;
+
+    return mesh;
+}
+
+void ModelLoader::buildLods(MeshData& mesh, const Options& options) {
+    std::vector<std::vector<uint32_t>> lodIndices;
+    std::vector<float> lodErrors;
+    lodIndices.push_back(std::move(mesh.indices));
+    lodErrors.push_back(0.0f);
+
+    // Each level halves the triangle count of the previous one until the error budget is spent
+    const float maxError = options.maxLodError * glm::length(mesh.boundsMax - mesh.boundsMin);
+    while (options.buildLods && lodIndices.size() < options.maxLodCount) {
+        const std::vector<uint32_t>& previous = lodIndices.back();
+        size_t targetIndexCount = previous.size() / 6 * 3;
+        if (targetIndexCount < options.minLodTriangles * 3) {
+            break;
+        }
+
+        // Errors add up across levels, so each one only gets what the previous levels left over
+        float remainingError = maxError - lodErrors.back();
+        if (remainingError <= 0.0f) {
+            break;
+        }
+        float error = 0.0f;
+        std::vector<uint32_t> simplified = MeshSimplifier::simplify(previous, mesh.vertices, targetIndexCount, remainingError, error);
+        if (simplified.empty() || simplified.size() * 10 > previous.size() * 9) {
+            break;
+        }
+
+        lodErrors.push_back(lodErrors.back() + error);
+        lodIndices.push_back(std::move(simplified));
+    }
+
+    // All levels share one index buffer, each one optionally reordered into meshlets
+    mesh.indices.clear();
+    mesh.meshlets.clear();
+    mesh.lods.clear();
+    for (size_t i = 0; i < lodIndices.size(); i++) {
+        MeshLod lod;
+        lod.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+        lod.indexCount = static_cast<uint32_t>(lodIndices[i].size());
+        lod.firstMeshlet = static_cast<uint32_t>(mesh.meshlets.size());
+        lod.error = lodErrors[i];
+
+        if (options.buildMeshlets) {
+            MeshletData meshletData = MeshletBuilder::build(lodIndices[i], mesh.vertices);
+            for (Meshlet& meshlet : meshletData.meshlets) {
+                meshlet.firstIndex += lod.firstIndex;
+                mesh.meshlets.push_back(meshlet);
+            }
+            mesh.indices.insert(mesh.indices.end(), meshletData.indices.begin(), meshletData.indices.end());
+        } else {
+            mesh.indices.insert(mesh.indices.end(), lodIndices[i].begin(), lodIndices[i].end());
+        }
+
+        lod.meshletCount = static_cast<uint32_t>(mesh.meshlets.size()) - lod.firstMeshlet;
+        mesh.lods.push_back(lod);
+    }
+}
+
+bool ModelLoader::canUseCompactVertices(const MeshData& mesh, const Options& options) {
+    if (mesh.vertices.empty()) {
+        return false;
+    }
+
+    // The compact format has no color stream, the shader substitutes white
+    glm::vec2 texMin = mesh.vertices[0].texCoord;
+    glm::vec2 texMax = texMin;
+    for (const auto& vertex : mesh.vertices) {
+        if (vertex.color != glm::vec3(1.0f)) {
+            return false;
+        }
+        texMin = glm::min(texMin, vertex.texCoord);
+        texMax = glm::max(texMax, vertex.texCoord);
+    }
+
+    // Worst case rounding error is half a quantization step
+    glm::vec3 extent = mesh.boundsMax - mesh.boundsMin;
+    float positionError = std::max({extent.x, extent.y, extent.z}) / 65535.0f * 0.5f;
+    glm::vec2 texExtent = texMax - texMin;
+    float texCoordError = std::max(texExtent.x, texExtent.y) / 65535.0f * 0.5f;
+
+    return positionError <= options.maxPositionError && texCoordError <= options.maxTexCoordError;
+}
+
+void ModelLoader::quantize(MeshData& mesh, const std::vector<glm::vec3>& normals) {
+    glm::vec2 texMin = mesh.vertices.empty() ? glm::vec2(0.0f) : mesh.vertices[0].texCoord;
+    glm::vec2 texMax = texMin;
+    for (const auto& vertex : mesh.vertices) {
+        texMin = glm::min(texMin, vertex.texCoord);
+        texMax = glm::max(texMax, vertex.texCoord);
+    }
+
+    glm::vec3 extent = mesh.boundsMax - mesh.boundsMin;
+    glm::vec2 texExtent = texMax - texMin;
+    mesh.quantization.positionOffset = glm::vec4(mesh.boundsMin, 0.0f);
+    mesh.quantization.positionScale = glm::vec4(extent, 0.0f);
+    mesh.quantization.texCoordOffsetScale = glm::vec4(texMin, texExtent);
+
+    mesh.compactVertices.resize(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const StandardVertex& source = mesh.vertices[i];
+        CompactVertex& vertex = mesh.compactVertices[i];
+
+        for (int axis = 0; axis < 3; axis++) {
+            vertex.pos[axis] = quantizeUnorm16(source.pos[axis], mesh.boundsMin[axis], extent[axis]);
+        }
+        for (int axis = 0; axis < 2; axis++) {
+            vertex.texCoord[axis] = quantizeUnorm16(source.texCoord[axis], texMin[axis], texExtent[axis]);
+        }
+
+        vertex.normal[0] = 0;
+        vertex.normal[1] = 0;
+        if (i < normals.size() && glm::dot(normals[i], normals[i]) > 0.0f) {
+            glm::vec2 octahedral = encodeOctahedral(glm::normalize(normals[i]));
+            vertex.normal[0] = quantizeSnorm8(octahedral.x);
+            vertex.normal[1] = quantizeSnorm8(octahedral.y);
+        }
+    }
+
+    mesh.format = VertexFormat::Compact;
+}
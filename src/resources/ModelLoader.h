@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include "../common/VertexTypes.h"
+#include "../geometry/MeshletBuilder.h"
+#include "../geometry/MeshSimplifier.h"
+#include "AssetPack.h"
+#include "AsyncFileReader.h"
+
+// CPU side mesh produced by the importer. `vertices` always holds the full precision data,
+// `compactVertices` is only filled when the importer picked VertexFormat::Compact.
+struct MeshData {
+    VertexFormat format = VertexFormat::Standard;
+    std::vector<StandardVertex> vertices;
+    std::vector<CompactVertex> compactVertices;
+    // Index ranges of every LOD back to back, LOD 0 first
+    std::vector<uint32_t> indices;
+    // Clusters over `indices`; when present each LOD range is ordered meshlet by meshlet
+    std::vector<Meshlet> meshlets;
+    // Always holds at least LOD 0
+    std::vector<MeshLod> lods;
+
+    QuantizationParams quantization{};
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+
+    const void* vertexData() const;
+    size_t vertexCount() const;
+    VkDeviceSize vertexStride() const;
+    VkDeviceSize vertexDataSize() const { return vertexStride() * vertexCount(); }
+};
+
+class ModelLoader {
+    public:
+        struct Options {
+            bool allowCompactVertices = true;
+            // Largest acceptable object space position error introduced by 16-bit quantization
+            float maxPositionError = 0.001f;
+            // Largest acceptable texture coordinate error (1/8 texel on a 1024 texture)
+            float maxTexCoordError = 1.0f / 8192.0f;
+            // Reorders the triangles into meshlets for GPU cluster culling
+            bool buildMeshlets = true;
+            // Simplified LODs sharing the vertex buffer, each with about half the triangles of the previous
+            bool buildLods = true;
+            size_t maxLodCount = 5;
+            size_t minLodTriangles = 64;
+            // Largest accumulated simplification error, as a fraction of the bounding box diagonal
+            float maxLodError = 0.05f;
+            // Models found in the pack are parsed from the mapping instead of read from disk
+            const AssetPack* assetPack = nullptr;
+            // Other models are read through it when set, instead of by the parser
+            AsyncFileReader* fileReader = nullptr;
+        };
+
+        static MeshData loadObj(const std::string& modelPath);
+        static MeshData loadObj(const std::string& modelPath, const Options& options);
+
+        // Fills compactVertices/quantization from vertices and switches the mesh to VertexFormat::Compact
+        static void quantize(MeshData& mesh, const std::vector<glm::vec3>& normals);
+
+    private:
+        static void buildLods(MeshData& mesh, const Options& options);
+        static bool canUseCompactVertices(const MeshData& mesh, const Options& options);
+};
@@ -0,0 +1,167 @@
+#include "TextureDecoder.h"
+#include "../common/PixelConvert.h"
+#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+TextureDecoder::TextureDecoder() {}
+
+TextureDecoder::~TextureDecoder() {
+    cleanup();
+}
+
+void TextureDecoder::initialize(uint32_t workerCount) {
+    if (workerCount == 0) {
+        // Leaves a hardware thread to the loader, which reads files and records the uploads
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = std::clamp(hardwareThreads > 1 ? hardwareThreads - 1 : 1u, 1u, MAX_DEFAULT_WORKERS);
+    }
+
+    stopping = false;
+    for (uint32_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&TextureDecoder::workerLoop, this);
+    }
+    std::cout << "Successfully started texture decoder - " << workerCount << " workers, "
+              << PixelConvert::getInstructionSet() << " pixel conversions" << std::endl;
+}
+
+void TextureDecoder::cleanup() {
+    if (workers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+bool TextureDecoder::getImageInfo(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height, bool& hdr) {
+    int imageWidth, imageHeight, channels;
+    if (!stbi_info_from_memory(data, static_cast<int>(size), &imageWidth, &imageHeight, &channels) ||
+        imageWidth <= 0 || imageHeight <= 0) {
+        return false;
+    }
+    width = static_cast<uint32_t>(imageWidth);
+    height = static_cast<uint32_t>(imageHeight);
+    hdr = stbi_is_hdr_from_memory(data, static_cast<int>(size)) != 0;
+    return true;
+}
+
+void TextureDecoder::decode(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+        unfinished++;
+    }
+    queueCondition.notify_one();
+}
+
+bool TextureDecoder::wait(std::string& error) {
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return unfinished == 0; });
+    error = std::move(firstError);
+    firstError.clear();
+    return error.empty();
+}
+
+void TextureDecoder::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueCondition.wait(lock, [this] { return stopping || !jobs.empty(); });
+            // Drains the queue before stopping so wait() never hangs
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        std::string error;
+        run(job, error);
+        // Frees the encoded file now rather than when the batch is done
+        job = Job{};
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error.empty() && firstError.empty()) {
+                firstError = std::move(error);
+            }
+            unfinished--;
+            if (unfinished == 0) {
+                doneCondition.notify_all();
+            }
+        }
+    }
+}
+
+bool TextureDecoder::run(const Job& job, std::string& error) {
+    size_t pixelCount = static_cast<size_t>(job.width) * job.height;
+    if (!job.encoded) {
+        if (job.size != pixelCount * 4) {
+            error = "invalid texture size: " + job.name;
+            return false;
+        }
+        memcpy(job.destination, job.data, job.size);
+        if (job.premultiplyAlpha) {
+            PixelConvert::premultiplyAlpha(job.destination, pixelCount, true);
+        }
+        return true;
+    }
+
+    int width, height, channels;
+    int size = static_cast<int>(job.size);
+    if (job.hdr) {
+        float* pixels = stbi_loadf_from_memory(job.data, size, &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            const char* reason = stbi_failure_reason();
+            error = "failed to decode texture: " + job.name + ", " + (reason ? reason : "unknown error");
+            return false;
+        }
+        bool sized = static_cast<uint32_t>(width) == job.width && static_cast<uint32_t>(height) == job.height;
+        if (sized) {
+            PixelConvert::floatToHalf(pixels, reinterpret_cast<uint16_t*>(job.destination), pixelCount * 4);
+        } else {
+            error = "texture size changed while decoding: " + job.name;
+        }
+        stbi_image_free(pixels);
+        return sized;
+    }
+
+    // Decoded with its own channel count: RGB images, the common case, are expanded straight into
+    // the destination instead of by stb_image into another buffer
+    stbi_uc* pixels = stbi_load_from_memory(job.data, size, &width, &height, &channels, 0);
+    if (pixels && channels != 3 && channels != 4) {
+        // Gray and gray alpha are rare enough to be expanded by stb_image
+        stbi_image_free(pixels);
+        pixels = stbi_load_from_memory(job.data, size, &width, &height, &channels, STBI_rgb_alpha);
+        channels = 4;
+    }
+    if (!pixels) {
+        const char* reason = stbi_failure_reason();
+        error = "failed to decode texture: " + job.name + ", " + (reason ? reason : "unknown error");
+        return false;
+    }
+    bool sized = static_cast<uint32_t>(width) == job.width && static_cast<uint32_t>(height) == job.height;
+    if (!sized) {
+        error = "texture size changed while decoding: " + job.name;
+    } else if (channels == 3) {
+        PixelConvert::rgbToRgba(pixels, job.destination, pixelCount);
+    } else {
+        memcpy(job.destination, pixels, pixelCount * 4);
+        if (job.premultiplyAlpha) {
+            PixelConvert::premultiplyAlpha(job.destination, pixelCount, true);
+        }
+    }
+    stbi_image_free(pixels);
+    return sized;
+}
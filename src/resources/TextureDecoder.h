@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decodes images to RGBA8 (RGBA16F for HDR) on a pool of threads, each one straight into its
+// destination, typically a slice of a mapped staging buffer. The loader thread only sizes the images
+// (see getImageInfo), hands out destinations and records the uploads while the workers decode.
+// Channel expansion, premultiplication and half conversion use the SIMD kernels of PixelConvert.
+class TextureDecoder {
+    public:
+        struct Job {
+            // Encoded image (PNG, JPEG, HDR, ...), or with encoded false RGBA8 pixels copied as they are
+            const uint8_t* data = nullptr;
+            size_t size = 0;
+            bool encoded = true;
+            // Radiance HDR image, decoded to RGBA16F instead of RGBA8 (see getImageInfo)
+            bool hdr = false;
+            // Multiplies color by alpha, treating RGBA8 colors as sRGB; HDR images are left as they are
+            bool premultiplyAlpha = false;
+            // Owns the data when nothing else does, e.g. a file just read; released once decoded
+            std::vector<uint8_t> storage;
+            // width * height * 4 bytes (8 for HDR), must stay valid until wait() returns
+            uint8_t* destination = nullptr;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            // Shown in errors
+            std::string name;
+        };
+
+        TextureDecoder();
+        ~TextureDecoder();
+
+        // 0 workers uses one per hardware thread but one, at most MAX_DEFAULT_WORKERS
+        static constexpr uint32_t MAX_DEFAULT_WORKERS = 8;
+        void initialize(uint32_t workerCount = 0);
+        void cleanup();
+
+        uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+        // Reads the size and kind of an encoded image from its header without decoding it
+        static bool getImageInfo(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height, bool& hdr);
+
+        void decode(Job job);
+        // Blocks until every queued job is done. Returns false with the first error when any failed.
+        bool wait(std::string& error);
+
+    private:
+        std::mutex mutex;
+        std::condition_variable queueCondition;
+        std::condition_variable doneCondition;
+        std::deque<Job> jobs;
+        // Queued or being decoded
+        size_t unfinished = 0;
+        std::string firstError;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+
+        void workerLoop();
+        static bool run(const Job& job, std::string& error);
+};
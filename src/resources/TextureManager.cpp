@@ -1,9 +1,12 @@
 #include "TextureManager.h"
+#include "../common/FileUtils.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 
 TextureManager::TextureManager(){}
 
@@ -15,10 +18,16 @@ void TextureManager::initialize(const VulkanDevice& device, CommandManager& cmdM
     vulkanDevice = &device;
     commandManager = &cmdManager;
     bufferManager = &bufMgr;
+    decoder.initialize();
 }
 
 void TextureManager::cleanup() {
-    // Cleanup is handled by individual resource destruction
+    // Textures are destroyed by their owners
+    decoder.cleanup();
+    if (vulkanDevice) {
+        destroyStagingBuffer(uploadBatch);
+        vulkanDevice = nullptr;
+    }
 }
 
 void TextureManager::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, 
@@ -171,29 +180,254 @@ void TextureManager::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t
     commandManager->endSingleTimeCommands(commandBuffer);
 }
 
-void TextureManager::createTextureFromFile(const std::string& texturePath, VkImage& textureImage, 
+void TextureManager::createTextureFromFile(const std::string& texturePath, VkImage& textureImage,
                               VkDeviceMemory& textureImageMemory, VkImageView& textureImageView){
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    std::vector<Texture> textures;
+    createTexturesFromFiles({texturePath}, textures);
+    textureImage = textures[0].image;
+    textureImageMemory = textures[0].memory;
+    textureImageView = textures[0].view;
+}
 
-    if (!pixels) {
+void TextureManager::createTexturesFromFiles(const std::vector<std::string>& texturePaths, std::vector<Texture>& textures,
+                                             bool premultiplyAlpha) {
+    textures.assign(texturePaths.size(), Texture{});
+
+    // Packed textures need no reads; the rest are queued before anything else is done
+    std::vector<AsyncFileReader::Request> requests;
+    std::vector<std::pair<size_t, AssetPack::Asset>> packed;
+    std::vector<size_t> unread;
+    for (size_t i = 0; i < texturePaths.size(); i++) {
+        AssetPack::Asset asset;
+        if (assetPack && assetPack->find(texturePaths[i], asset)) {
+            packed.emplace_back(i, asset);
+        } else if (!fileReader) {
+            unread.push_back(i);
+        } else {
+            AsyncFileReader::Request request;
+            request.path = texturePaths[i];
+            request.userData = i;
+            requests.push_back(request);
+        }
+    }
+    if (!requests.empty()) {
+        fileReader->submit(requests);
+    }
+
+    UploadBatch& batch = uploadBatch;
+    batch.premultiplyAlpha = premultiplyAlpha;
+    try {
+        for (const auto& [index, asset] : packed) {
+            TextureDecoder::Job job;
+            job.data = asset.data;
+            job.size = asset.size;
+            // Decoded by the packer: copied from the mapping straight into the staging buffer
+            job.encoded = asset.format != AssetPack::Format::Rgba8;
+            job.width = asset.width;
+            job.height = asset.height;
+            job.name = texturePaths[index];
+            queueTexture(batch, textures, index, std::move(job));
+        }
+
+        for (size_t index : unread) {
+            TextureDecoder::Job job;
+            if (!readFile(texturePaths[index], job.storage)) {
+                std::cout << "Failed to read texture - " << texturePaths[index] << std::endl;
+                throw std::runtime_error("failed to load texture image!");
+            }
+            job.name = texturePaths[index];
+            queueTexture(batch, textures, index, std::move(job));
+        }
+
+        // Each file is handed to the decoder as soon as it has been read
+        std::vector<AsyncFileReader::Completion> completions;
+        size_t remaining = requests.size();
+        while (remaining > 0) {
+            completions.clear();
+            fileReader->poll(completions, true);
+            for (AsyncFileReader::Completion& completion : completions) {
+                remaining--;
+                const std::string& texturePath = texturePaths[completion.userData];
+                if (completion.error != 0) {
+                    std::cout << "Failed to read texture - " << texturePath << ", " << std::strerror(completion.error) << std::endl;
+                    throw std::runtime_error("failed to load texture image!");
+                }
+                TextureDecoder::Job job;
+                job.storage = std::move(completion.data);
+                job.name = texturePath;
+                queueTexture(batch, textures, completion.userData, std::move(job));
+            }
+        }
+
+        flushUploads(batch, textures);
+    } catch (...) {
+        // Workers may still be writing into the staging buffer
+        std::string ignored;
+        decoder.wait(ignored);
+        // The reader is shared, so the rest of the batch must not show up in someone else's poll
+        if (fileReader && fileReader->getPendingCount() > 0) {
+            std::vector<AsyncFileReader::Completion> discarded;
+            fileReader->waitAll(discarded);
+        }
+        batch.uploads.clear();
+        batch.used = 0;
+        for (Texture& texture : textures) {
+            destroyImageView(texture.view);
+            destroyImage(texture.image, texture.memory);
+        }
+        throw;
+    }
+}
+
+void TextureManager::queueTexture(UploadBatch& batch, std::vector<Texture>& textures, size_t index, TextureDecoder::Job job) {
+    if (!job.storage.empty()) {
+        job.data = job.storage.data();
+        job.size = job.storage.size();
+    }
+    if (job.encoded && !TextureDecoder::getImageInfo(job.data, job.size, job.width, job.height, job.hdr)) {
+        std::cout << "Failed to decode texture - " << job.name << std::endl;
         throw std::runtime_error("failed to load texture image!");
     }
 
+    job.premultiplyAlpha = batch.premultiplyAlpha;
+    // HDR images stay linear and unclamped as half floats
+    VkFormat format = job.hdr ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R8G8B8A8_SRGB;
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(job.width) * job.height * (job.hdr ? 8 : 4);
+    if (batch.used + imageSize > batch.capacity) {
+        flushUploads(batch, textures);
+    }
+    if (imageSize > batch.capacity) {
+        // Empty after the flush above; grown to fit and kept for later batches
+        destroyStagingBuffer(batch);
+        createStagingBuffer(batch, std::max(imageSize, UPLOAD_BATCH_SIZE));
+    }
+
+    Texture& texture = textures[index];
+    createImage(job.width, job.height, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory);
+    texture.view = createImageView(texture.image, format, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    batch.uploads.push_back({index, batch.used, job.width, job.height});
+    job.destination = batch.mapped + batch.used;
+    // Copy offsets must be a multiple of the texel size; 16 covers both formats and keeps the
+    // decoder's writes aligned
+    batch.used += (imageSize + 15) & ~VkDeviceSize(15);
+    decoder.decode(std::move(job));
+}
+
+void TextureManager::flushUploads(UploadBatch& batch, std::vector<Texture>& textures) {
+    if (batch.uploads.empty()) {
+        return;
+    }
+
+    std::string error;
+    if (!decoder.wait(error)) {
+        std::cout << "Failed to decode texture - " << error << std::endl;
+        throw std::runtime_error("failed to load texture image!");
+    }
+
+    // One submission for the whole batch, with one barrier call on each side of the copies
+    std::vector<VkImageMemoryBarrier> barriers(batch.uploads.size());
+    for (size_t i = 0; i < barriers.size(); i++) {
+        VkImageMemoryBarrier& barrier = barriers[i];
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = textures[batch.uploads[i].texture].image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+
+    VkCommandBuffer commandBuffer = commandManager->beginSingleTimeCommands();
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    for (const UploadBatch::Upload& upload : batch.uploads) {
+        VkBufferImageCopy region{};
+        region.bufferOffset = upload.offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {upload.width, upload.height, 1};
+        vkCmdCopyBufferToImage(commandBuffer, batch.buffer, textures[upload.texture].image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    for (VkImageMemoryBarrier& barrier : barriers) {
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+    commandManager->endSingleTimeCommands(commandBuffer);
+
+    batch.uploads.clear();
+    batch.used = 0;
+}
+
+void TextureManager::createStagingBuffer(UploadBatch& batch, VkDeviceSize size) {
+    bufferManager->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, batch.buffer, batch.memory);
+    void* data;
+    VkResult result = vkMapMemory(vulkanDevice->getLogicalDevice(), batch.memory, 0, size, 0, &data);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to map texture staging buffer - " << result << std::endl;
+        bufferManager->destroyBuffer(batch.buffer, batch.memory);
+        throw std::runtime_error("failed to map texture staging buffer!");
+    }
+    batch.mapped = static_cast<uint8_t*>(data);
+    batch.capacity = size;
+    batch.used = 0;
+}
+
+void TextureManager::destroyStagingBuffer(UploadBatch& batch) {
+    if (batch.mapped) {
+        vkUnmapMemory(vulkanDevice->getLogicalDevice(), batch.memory);
+        batch.mapped = nullptr;
+    }
+    bufferManager->destroyBuffer(batch.buffer, batch.memory);
+    batch.capacity = 0;
+    batch.used = 0;
+}
+
+bool TextureManager::loadPixels(const std::string& path, ImageRgba8& image) {
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        return false;
+    }
+
+    image.width = static_cast<uint32_t>(width);
+    image.height = static_cast<uint32_t>(height);
+    image.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+void TextureManager::createTextureFromPixels(const uint8_t* pixels, uint32_t width, uint32_t height, VkImage& textureImage,
+                                             VkDeviceMemory& textureImageMemory, VkImageView& textureImageView){
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(width) * height * 4;
+
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
     bufferManager->createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
     void* data;
-    vkMapMemory(vulkanDevice->getLogicalDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
+    VkResult result = vkMapMemory(vulkanDevice->getLogicalDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
+    if (result != VK_SUCCESS) {
+        std::cout << "Failed to map texture staging buffer - " << result << std::endl;
+        bufferManager->destroyBuffer(stagingBuffer, stagingBufferMemory);
+        throw std::runtime_error("failed to map texture staging buffer!");
+    }
     memcpy(data, pixels, static_cast<size_t>(imageSize));
     vkUnmapMemory(vulkanDevice->getLogicalDevice(), stagingBufferMemory);
 
-    stbi_image_free(pixels);
-
-    createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+    createImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
     transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+    copyBufferToImage(stagingBuffer, textureImage, width, height);
     transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
     vkDestroyBuffer(vulkanDevice->getLogicalDevice(), stagingBuffer, nullptr);
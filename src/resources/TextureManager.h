@@ -2,12 +2,23 @@
 
 #include <vulkan/vulkan.h>
 #include <string>
+#include <vector>
 #include "../core/VulkanDevice.h"
 #include "../rendering/CommandManager.h"
 #include "../resources/BufferManager.h"
+#include "../common/ImageTypes.h"
+#include "AssetPack.h"
+#include "AsyncFileReader.h"
+#include "TextureDecoder.h"
 
 class TextureManager{
     public:
+        struct Texture {
+            VkImage image = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+        };
+
         TextureManager();
         ~TextureManager();
 
@@ -23,9 +34,25 @@ class TextureManager{
         void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
         void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 
+        // Textures found in the asset pack are read from it instead of the file system
+        void setAssetPack(const AssetPack* assetPack) { this->assetPack = assetPack; }
+        // Batches read their files through it; without one they load file by file
+        void setFileReader(AsyncFileReader* fileReader) { this->fileReader = fileReader; }
+
         void createTextureFromFile(const std::string& texturePath, VkImage& textureImage, 
                               VkDeviceMemory& textureImageMemory, VkImageView& textureImageView);
+        // Loads textures[i] from paths[i]. Every file is read at once in the background and each one
+        // is handed to the decoder's threads as soon as its read completes. They decode straight into
+        // a shared staging buffer, which is uploaded in one submission whenever it fills up.
+        // Radiance HDR files become RGBA16F textures, everything else RGBA8 sRGB.
+        void createTexturesFromFiles(const std::vector<std::string>& texturePaths, std::vector<Texture>& textures,
+                                     bool premultiplyAlpha = false);
+        // RGBA8 pixels, width * height * 4 bytes
+        void createTextureFromPixels(const uint8_t* pixels, uint32_t width, uint32_t height, VkImage& textureImage,
+                                     VkDeviceMemory& textureImageMemory, VkImageView& textureImageView);
         VkSampler createTextureSampler();
+        // Decodes an image file (PNG, JPEG, ...) to RGBA8 without creating anything on the device
+        static bool loadPixels(const std::string& path, ImageRgba8& image);
 
         void createDepthResources(VkExtent2D extent, VkImage& depthImage, 
                              VkDeviceMemory& depthImageMemory, VkImageView& depthImageView);
@@ -38,6 +65,37 @@ class TextureManager{
         const VulkanDevice* vulkanDevice = nullptr;
         CommandManager* commandManager = nullptr;
         BufferManager* bufferManager = nullptr;
+        const AssetPack* assetPack = nullptr;
+        AsyncFileReader* fileReader = nullptr;
+        TextureDecoder decoder;
+
+        // Staging memory for batches of textures, created by the first batch and kept mapped until
+        // cleanup(); the decoder writes into the mapping
+        static constexpr VkDeviceSize UPLOAD_BATCH_SIZE = 64ull * 1024 * 1024;
+        struct UploadBatch {
+            struct Upload {
+                size_t texture;
+                VkDeviceSize offset;
+                uint32_t width;
+                uint32_t height;
+            };
+
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            uint8_t* mapped = nullptr;
+            VkDeviceSize capacity = 0;
+            VkDeviceSize used = 0;
+            std::vector<Upload> uploads;
+            bool premultiplyAlpha = false;
+        };
+        UploadBatch uploadBatch;
+
+        // Creates the texture's image and queues its decode into the batch, flushing it when full
+        void queueTexture(UploadBatch& batch, std::vector<Texture>& textures, size_t index, TextureDecoder::Job job);
+        // Waits for the decoder and copies every texture in the batch to its image
+        void flushUploads(UploadBatch& batch, std::vector<Texture>& textures);
+        void createStagingBuffer(UploadBatch& batch, VkDeviceSize size);
+        void destroyStagingBuffer(UploadBatch& batch);
 
         VkFormat findDepthFormat();
         VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
@@ -0,0 +1,230 @@
+#include "Scene.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+Scene::NodeId Scene::createNode(NodeId parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    if (parent != NONE && parent >= getNodeCount()) {
+        throw std::runtime_error("Invalid parent node " + std::to_string(parent));
+    }
+
+    NodeId node = transforms.create(position, rotation, scale);
+    localMatrices.emplace_back(1.0f);
+    parents.push_back(NONE);
+    firstChildren.push_back(NONE);
+    lastChildren.push_back(NONE);
+    nextSiblings.push_back(NONE);
+    meshes.push_back(NONE);
+    materials.push_back(0);
+    storageIndices.push_back(NONE);
+    dirtyFlags.push_back(0);
+    link(node, parent);
+    layoutChanged = true;
+    return node;
+}
+
+void Scene::setParent(NodeId node, NodeId parent) {
+    if (parents[node] == parent) {
+        return;
+    }
+    for (NodeId ancestor = parent; ancestor != NONE; ancestor = parents[ancestor]) {
+        if (ancestor == node) {
+            throw std::runtime_error("Failed to reparent node " + std::to_string(node) + " - parent is in its subtree");
+        }
+    }
+
+    unlink(node);
+    link(node, parent);
+    layoutChanged = true;
+}
+
+void Scene::clear() {
+    transforms.clear();
+    localMatrices.clear();
+    parents.clear();
+    firstChildren.clear();
+    lastChildren.clear();
+    nextSiblings.clear();
+    meshes.clear();
+    materials.clear();
+    storageIndices.clear();
+    dirtyFlags.clear();
+    dirtyNodes.clear();
+    order.clear();
+    storageParents.clear();
+    subtreeEnds.clear();
+    worldMatrices.clear();
+    storageMeshes.clear();
+    storageMaterials.clear();
+    changedRanges.clear();
+    layoutChanged = false;
+}
+
+void Scene::setPosition(NodeId node, const glm::vec3& position) {
+    transforms.setPosition(node, position);
+    markDirty(node);
+}
+
+void Scene::setRotation(NodeId node, const glm::quat& rotation) {
+    transforms.setRotation(node, rotation);
+    markDirty(node);
+}
+
+void Scene::setScale(NodeId node, const glm::vec3& scale) {
+    transforms.setScale(node, scale);
+    markDirty(node);
+}
+
+void Scene::setMesh(NodeId node, uint32_t mesh, uint32_t material) {
+    meshes[node] = mesh;
+    materials[node] = material;
+    if (!layoutChanged) {
+        storageMeshes[storageIndices[node]] = mesh;
+        storageMaterials[storageIndices[node]] = material;
+    }
+}
+
+uint32_t Scene::update() {
+    changedRanges.clear();
+    if (layoutChanged) {
+        buildLayout();
+    }
+    if (dirtyNodes.empty()) {
+        return 0;
+    }
+
+    transforms.update(localMatrices.data());
+
+    // Sorted, a dirty node inside a subtree recomputed already is skipped
+    dirtyIndices.clear();
+    for (NodeId node : dirtyNodes) {
+        dirtyIndices.push_back(storageIndices[node]);
+        dirtyFlags[node] = 0;
+    }
+    dirtyNodes.clear();
+    std::sort(dirtyIndices.begin(), dirtyIndices.end());
+
+    uint32_t recomputed = 0;
+    uint32_t end = 0;
+    for (uint32_t first : dirtyIndices) {
+        if (first < end) {
+            continue;
+        }
+        end = subtreeEnds[first];
+        // Parents come first, so theirs are current by the time a child reads them
+        for (uint32_t index = first; index < end; index++) {
+            const glm::mat4& local = localMatrices[order[index]];
+            uint32_t parent = storageParents[index];
+            worldMatrices[index] = parent == NONE ? local : worldMatrices[parent] * local;
+        }
+        recomputed += end - first;
+
+        if (!changedRanges.empty() && changedRanges.back().second == first) {
+            changedRanges.back().second = end;
+        } else {
+            changedRanges.emplace_back(first, end);
+        }
+    }
+    return recomputed;
+}
+
+void Scene::markDirty(NodeId node) {
+    if (!dirtyFlags[node]) {
+        dirtyFlags[node] = 1;
+        dirtyNodes.push_back(node);
+    }
+}
+
+void Scene::link(NodeId node, NodeId parent) {
+    parents[node] = parent;
+    nextSiblings[node] = NONE;
+    if (parent == NONE) {
+        return;
+    }
+    if (lastChildren[parent] == NONE) {
+        firstChildren[parent] = node;
+    } else {
+        nextSiblings[lastChildren[parent]] = node;
+    }
+    lastChildren[parent] = node;
+}
+
+void Scene::unlink(NodeId node) {
+    NodeId parent = parents[node];
+    if (parent == NONE) {
+        return;
+    }
+    NodeId previous = NONE;
+    for (NodeId child = firstChildren[parent]; child != node; child = nextSiblings[child]) {
+        previous = child;
+    }
+    if (previous == NONE) {
+        firstChildren[parent] = nextSiblings[node];
+    } else {
+        nextSiblings[previous] = nextSiblings[node];
+    }
+    if (lastChildren[parent] == node) {
+        lastChildren[parent] = previous;
+    }
+    parents[node] = NONE;
+    nextSiblings[node] = NONE;
+}
+
+// Depth first, roots and siblings in creation order. Marks the roots dirty, so the next pass
+// recomputes every world matrix.
+void Scene::buildLayout() {
+    size_t nodeCount = parents.size();
+    order.clear();
+    order.reserve(nodeCount);
+    for (NodeId root = 0; root < nodeCount; root++) {
+        if (parents[root] != NONE) {
+            continue;
+        }
+        NodeId node = root;
+        while (true) {
+            storageIndices[node] = static_cast<uint32_t>(order.size());
+            order.push_back(node);
+            if (firstChildren[node] != NONE) {
+                node = firstChildren[node];
+                continue;
+            }
+            while (node != root && nextSiblings[node] == NONE) {
+                node = parents[node];
+            }
+            if (node == root) {
+                break;
+            }
+            node = nextSiblings[node];
+        }
+    }
+
+    storageParents.resize(nodeCount);
+    subtreeEnds.resize(nodeCount);
+    storageMeshes.resize(nodeCount);
+    storageMaterials.resize(nodeCount);
+    worldMatrices.resize(nodeCount);
+    for (uint32_t index = 0; index < nodeCount; index++) {
+        NodeId node = order[index];
+        storageParents[index] = parents[node] == NONE ? NONE : storageIndices[parents[node]];
+        subtreeEnds[index] = index + 1;
+        storageMeshes[index] = meshes[node];
+        storageMaterials[index] = materials[node];
+    }
+    // Children come after their parents, so walking back gathers each subtree before its root
+    for (uint32_t index = static_cast<uint32_t>(nodeCount); index-- > 0;) {
+        if (storageParents[index] != NONE) {
+            subtreeEnds[storageParents[index]] = std::max(subtreeEnds[storageParents[index]], subtreeEnds[index]);
+        }
+    }
+
+    for (NodeId node : dirtyNodes) {
+        dirtyFlags[node] = 0;
+    }
+    dirtyNodes.clear();
+    for (NodeId node = 0; node < nodeCount; node++) {
+        if (parents[node] == NONE) {
+            markDirty(node);
+        }
+    }
+    layoutChanged = false;
+}
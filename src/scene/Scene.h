@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "TransformSystem.h"
+
+// Hierarchy of nodes, each with a local transform relative to its parent and optionally a mesh and
+// material to draw it with (indices into the renderer's own lists).
+//
+// Nodes are stored flat in depth first order, so every parent comes before its children and every
+// subtree is one contiguous range. update() only recomputes the subtrees of nodes that changed,
+// front to back in a single pass over each range; a frame without changes costs nothing. Local
+// matrices are composed by a TransformSystem.
+//
+// Node ids are stable; storage indices are not. Adding or reparenting nodes rebuilds the layout on
+// the next update(), which is linear in the node count, so build scenes up front rather than per frame.
+class Scene {
+    public:
+        using NodeId = uint32_t;
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        // Appended as the last child of parent, or as a root with NONE
+        NodeId createNode(NodeId parent = NONE,
+                          const glm::vec3& position = glm::vec3(0.0f),
+                          const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                          const glm::vec3& scale = glm::vec3(1.0f));
+        // Moves node with its subtree under parent (NONE for a root), keeping its local transform
+        void setParent(NodeId node, NodeId parent);
+        void clear();
+        uint32_t getNodeCount() const { return static_cast<uint32_t>(parents.size()); }
+        NodeId getParent(NodeId node) const { return parents[node]; }
+
+        void setPosition(NodeId node, const glm::vec3& position);
+        void setRotation(NodeId node, const glm::quat& rotation);
+        void setScale(NodeId node, const glm::vec3& scale);
+        glm::vec3 getPosition(NodeId node) const { return transforms.getPosition(node); }
+        glm::quat getRotation(NodeId node) const { return transforms.getRotation(node); }
+        glm::vec3 getScale(NodeId node) const { return transforms.getScale(node); }
+
+        // NONE for nodes that are not drawn
+        void setMesh(NodeId node, uint32_t mesh, uint32_t material = 0);
+        uint32_t getMesh(NodeId node) const { return meshes[node]; }
+        uint32_t getMaterial(NodeId node) const { return materials[node]; }
+
+        // Recomputes the world matrices of changed nodes and their descendants. Returns the number
+        // of world matrices recomputed.
+        uint32_t update();
+        // As of the last update(), which must have run since the node was created
+        const glm::mat4& getWorldMatrix(NodeId node) const { return worldMatrices[storageIndices[node]]; }
+
+        // Storage order views for renderers, each getStorageCount() long and valid until the next
+        // update(): draws walk these arrays front to back instead of the hierarchy
+        uint32_t getStorageCount() const { return static_cast<uint32_t>(order.size()); }
+        const glm::mat4* getWorldMatrices() const { return worldMatrices.data(); }
+        const uint32_t* getStorageMeshes() const { return storageMeshes.data(); }
+        const uint32_t* getStorageMaterials() const { return storageMaterials.data(); }
+        NodeId getStorageNode(uint32_t index) const { return order[index]; }
+        // [first, end) storage ranges the last update() rewrote, in order, e.g. to copy to a GPU buffer
+        const std::vector<std::pair<uint32_t, uint32_t>>& getChangedRanges() const { return changedRanges; }
+
+    private:
+        // By node id
+        TransformSystem transforms;
+        std::vector<glm::mat4> localMatrices;
+        std::vector<NodeId> parents;
+        std::vector<NodeId> firstChildren;
+        std::vector<NodeId> lastChildren;
+        std::vector<NodeId> nextSiblings;
+        std::vector<uint32_t> meshes;
+        std::vector<uint32_t> materials;
+        std::vector<uint32_t> storageIndices;
+        std::vector<uint8_t> dirtyFlags;
+        std::vector<NodeId> dirtyNodes;
+
+        // By storage index, in depth first order
+        std::vector<NodeId> order;
+        std::vector<uint32_t> storageParents;
+        // One past the last descendant
+        std::vector<uint32_t> subtreeEnds;
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<uint32_t> storageMeshes;
+        std::vector<uint32_t> storageMaterials;
+
+        bool layoutChanged = false;
+        std::vector<uint32_t> dirtyIndices;
+        std::vector<std::pair<uint32_t, uint32_t>> changedRanges;
+
+        void markDirty(NodeId node);
+        void link(NodeId node, NodeId parent);
+        void unlink(NodeId node);
+        void buildLayout();
+};
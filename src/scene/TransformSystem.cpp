@@ -0,0 +1,355 @@
+#include "TransformSystem.h"
+#include "../common/CpuFeatures.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef CPU_FEATURES_X86
+#include <immintrin.h>
+#elif defined(CPU_FEATURES_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    const size_t BLOCK_SIZE = 8;
+
+    struct Transforms {
+        const float* positionX;
+        const float* positionY;
+        const float* positionZ;
+        const float* rotationX;
+        const float* rotationY;
+        const float* rotationZ;
+        const float* rotationW;
+        const float* scaleX;
+        const float* scaleY;
+        const float* scaleZ;
+    };
+
+    // Composes the block of 8 transforms starting at first and writes the lanes set in laneMask to
+    // their matrices, 16 floats each, column major
+    using ComposeBlock = void (*)(const Transforms& transforms, size_t first, uint32_t laneMask, float* destination);
+
+    void composeBlockScalar(const Transforms& t, size_t first, uint32_t laneMask, float* destination) {
+        for (size_t lane = 0; lane < BLOCK_SIZE; lane++) {
+            if (!(laneMask & (1u << lane))) {
+                continue;
+            }
+            size_t i = first + lane;
+            float x = t.rotationX[i], y = t.rotationY[i], z = t.rotationZ[i], w = t.rotationW[i];
+            float xx = 2.0f * x * x, yy = 2.0f * y * y, zz = 2.0f * z * z;
+            float xy = 2.0f * x * y, xz = 2.0f * x * z, yz = 2.0f * y * z;
+            float wx = 2.0f * w * x, wy = 2.0f * w * y, wz = 2.0f * w * z;
+            float sx = t.scaleX[i], sy = t.scaleY[i], sz = t.scaleZ[i];
+
+            float matrix[16] = {
+                (1.0f - yy - zz) * sx, (xy + wz) * sx, (xz - wy) * sx, 0.0f,
+                (xy - wz) * sy, (1.0f - xx - zz) * sy, (yz + wx) * sy, 0.0f,
+                (xz + wy) * sz, (yz - wx) * sz, (1.0f - xx - yy) * sz, 0.0f,
+                t.positionX[i], t.positionY[i], t.positionZ[i], 1.0f
+            };
+            std::memcpy(destination + i * 16, matrix, sizeof(matrix));
+        }
+    }
+
+#ifdef CPU_FEATURES_X86
+    CPU_TARGET("sse2")
+    void composeBlockSse(const Transforms& t, size_t first, uint32_t laneMask, float* destination) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        for (size_t half = 0; half < BLOCK_SIZE; half += 4) {
+            uint32_t halfMask = (laneMask >> half) & 0xfu;
+            if (!halfMask) {
+                continue;
+            }
+            size_t i = first + half;
+            __m128 x = _mm_loadu_ps(t.rotationX + i);
+            __m128 y = _mm_loadu_ps(t.rotationY + i);
+            __m128 z = _mm_loadu_ps(t.rotationZ + i);
+            __m128 w = _mm_loadu_ps(t.rotationW + i);
+            __m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+            __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+            __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+            __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+            __m128 sx = _mm_loadu_ps(t.scaleX + i);
+            __m128 sy = _mm_loadu_ps(t.scaleY + i);
+            __m128 sz = _mm_loadu_ps(t.scaleZ + i);
+
+            // columns[c][row] for all 4 objects, then transposed so columns[c][k] is object k's column
+            __m128 columns[4][4] = {
+                {_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+                 _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero},
+                {_mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+                 _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero},
+                {_mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+                 _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero},
+                {_mm_loadu_ps(t.positionX + i), _mm_loadu_ps(t.positionY + i), _mm_loadu_ps(t.positionZ + i), one}
+            };
+            for (auto& column : columns) {
+                _MM_TRANSPOSE4_PS(column[0], column[1], column[2], column[3]);
+            }
+
+            for (size_t k = 0; k < 4; k++) {
+                if (halfMask & (1u << k)) {
+                    float* matrix = destination + (i + k) * 16;
+                    for (size_t c = 0; c < 4; c++) {
+                        _mm_storeu_ps(matrix + c * 4, columns[c][k]);
+                    }
+                }
+            }
+        }
+    }
+
+    // 4x4 transpose within each 128 bit half
+    CPU_TARGET("avx")
+    inline void transposeHalves(__m256& a, __m256& b, __m256& c, __m256& d) {
+        __m256 ab0 = _mm256_unpacklo_ps(a, b);
+        __m256 ab1 = _mm256_unpackhi_ps(a, b);
+        __m256 cd0 = _mm256_unpacklo_ps(c, d);
+        __m256 cd1 = _mm256_unpackhi_ps(c, d);
+        a = _mm256_shuffle_ps(ab0, cd0, _MM_SHUFFLE(1, 0, 1, 0));
+        b = _mm256_shuffle_ps(ab0, cd0, _MM_SHUFFLE(3, 2, 3, 2));
+        c = _mm256_shuffle_ps(ab1, cd1, _MM_SHUFFLE(1, 0, 1, 0));
+        d = _mm256_shuffle_ps(ab1, cd1, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+
+    CPU_TARGET("avx")
+    void composeBlockAvx(const Transforms& t, size_t first, uint32_t laneMask, float* destination) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 x = _mm256_loadu_ps(t.rotationX + first);
+        __m256 y = _mm256_loadu_ps(t.rotationY + first);
+        __m256 z = _mm256_loadu_ps(t.rotationZ + first);
+        __m256 w = _mm256_loadu_ps(t.rotationW + first);
+        __m256 x2 = _mm256_add_ps(x, x), y2 = _mm256_add_ps(y, y), z2 = _mm256_add_ps(z, z);
+        __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+        __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+        __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+        __m256 sx = _mm256_loadu_ps(t.scaleX + first);
+        __m256 sy = _mm256_loadu_ps(t.scaleY + first);
+        __m256 sz = _mm256_loadu_ps(t.scaleZ + first);
+
+        __m256 columns[4][4] = {
+            {_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+             _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero},
+            {_mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+             _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero},
+            {_mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+             _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero},
+            {_mm256_loadu_ps(t.positionX + first), _mm256_loadu_ps(t.positionY + first),
+             _mm256_loadu_ps(t.positionZ + first), one}
+        };
+        // Afterwards the low half of columns[c][k] belongs to object k, the high half to object k + 4
+        for (auto& column : columns) {
+            transposeHalves(column[0], column[1], column[2], column[3]);
+        }
+
+        for (size_t k = 0; k < 4; k++) {
+            if (laneMask & (1u << k)) {
+                float* matrix = destination + (first + k) * 16;
+                for (size_t c = 0; c < 4; c++) {
+                    _mm_storeu_ps(matrix + c * 4, _mm256_castps256_ps128(columns[c][k]));
+                }
+            }
+            if (laneMask & (1u << (k + 4))) {
+                float* matrix = destination + (first + k + 4) * 16;
+                for (size_t c = 0; c < 4; c++) {
+                    _mm_storeu_ps(matrix + c * 4, _mm256_extractf128_ps(columns[c][k], 1));
+                }
+            }
+        }
+    }
+#endif
+
+#ifdef CPU_FEATURES_NEON
+    inline void transpose(float32x4_t& a, float32x4_t& b, float32x4_t& c, float32x4_t& d) {
+        float32x4x2_t ab = vtrnq_f32(a, b);
+        float32x4x2_t cd = vtrnq_f32(c, d);
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+
+    void composeBlockNeon(const Transforms& t, size_t first, uint32_t laneMask, float* destination) {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for (size_t half = 0; half < BLOCK_SIZE; half += 4) {
+            uint32_t halfMask = (laneMask >> half) & 0xfu;
+            if (!halfMask) {
+                continue;
+            }
+            size_t i = first + half;
+            float32x4_t x = vld1q_f32(t.rotationX + i);
+            float32x4_t y = vld1q_f32(t.rotationY + i);
+            float32x4_t z = vld1q_f32(t.rotationZ + i);
+            float32x4_t w = vld1q_f32(t.rotationW + i);
+            float32x4_t x2 = vaddq_f32(x, x), y2 = vaddq_f32(y, y), z2 = vaddq_f32(z, z);
+            float32x4_t xx = vmulq_f32(x, x2), yy = vmulq_f32(y, y2), zz = vmulq_f32(z, z2);
+            float32x4_t xy = vmulq_f32(x, y2), xz = vmulq_f32(x, z2), yz = vmulq_f32(y, z2);
+            float32x4_t wx = vmulq_f32(w, x2), wy = vmulq_f32(w, y2), wz = vmulq_f32(w, z2);
+            float32x4_t sx = vld1q_f32(t.scaleX + i);
+            float32x4_t sy = vld1q_f32(t.scaleY + i);
+            float32x4_t sz = vld1q_f32(t.scaleZ + i);
+
+            float32x4_t columns[4][4] = {
+                {vmulq_f32(vsubq_f32(one, vaddq_f32(yy, zz)), sx), vmulq_f32(vaddq_f32(xy, wz), sx),
+                 vmulq_f32(vsubq_f32(xz, wy), sx), zero},
+                {vmulq_f32(vsubq_f32(xy, wz), sy), vmulq_f32(vsubq_f32(one, vaddq_f32(xx, zz)), sy),
+                 vmulq_f32(vaddq_f32(yz, wx), sy), zero},
+                {vmulq_f32(vaddq_f32(xz, wy), sz), vmulq_f32(vsubq_f32(yz, wx), sz),
+                 vmulq_f32(vsubq_f32(one, vaddq_f32(xx, yy)), sz), zero},
+                {vld1q_f32(t.positionX + i), vld1q_f32(t.positionY + i), vld1q_f32(t.positionZ + i), one}
+            };
+            for (auto& column : columns) {
+                transpose(column[0], column[1], column[2], column[3]);
+            }
+
+            for (size_t k = 0; k < 4; k++) {
+                if (halfMask & (1u << k)) {
+                    float* matrix = destination + (i + k) * 16;
+                    for (size_t c = 0; c < 4; c++) {
+                        vst1q_f32(matrix + c * 4, columns[c][k]);
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    struct Kernel {
+        ComposeBlock composeBlock = composeBlockScalar;
+        const char* instructionSet = "scalar";
+    };
+
+    Kernel selectKernel() {
+        Kernel kernel;
+#ifdef CPU_FEATURES_X86
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        kernel.composeBlock = composeBlockSse;
+        kernel.instructionSet = "SSE2";
+#endif
+        if (CpuFeatures::get().avx) {
+            kernel.composeBlock = composeBlockAvx;
+            kernel.instructionSet = "AVX";
+        }
+#elif defined(CPU_FEATURES_NEON)
+        kernel.composeBlock = composeBlockNeon;
+        kernel.instructionSet = "NEON";
+#endif
+        return kernel;
+    }
+
+    const Kernel& getKernel() {
+        static const Kernel kernel = selectKernel();
+        return kernel;
+    }
+}
+
+TransformSystem::TransformSystem(uint32_t destinationCount)
+    : destinationCount(std::min(std::max(destinationCount, 1u), 255u)) {}
+
+TransformSystem::Handle TransformSystem::create(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    Handle handle = count++;
+    if (handle == pending.size()) {
+        size_t size = pending.size() + BLOCK_SIZE;
+        for (std::vector<float>* values : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ}) {
+            values->resize(size, 0.0f);
+        }
+        for (std::vector<float>* values : {&rotationW, &scaleX, &scaleY, &scaleZ}) {
+            values->resize(size, 1.0f);
+        }
+        pending.resize(size, 0);
+    }
+
+    positionX[handle] = position.x;
+    positionY[handle] = position.y;
+    positionZ[handle] = position.z;
+    rotationX[handle] = rotation.x;
+    rotationY[handle] = rotation.y;
+    rotationZ[handle] = rotation.z;
+    rotationW[handle] = rotation.w;
+    scaleX[handle] = scale.x;
+    scaleY[handle] = scale.y;
+    scaleZ[handle] = scale.z;
+    pending[handle] = static_cast<uint8_t>(destinationCount);
+    return handle;
+}
+
+void TransformSystem::clear() {
+    count = 0;
+    for (std::vector<float>* values : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ,
+                                       &rotationW, &scaleX, &scaleY, &scaleZ}) {
+        values->clear();
+    }
+    pending.clear();
+}
+
+void TransformSystem::setPosition(Handle handle, const glm::vec3& position) {
+    positionX[handle] = position.x;
+    positionY[handle] = position.y;
+    positionZ[handle] = position.z;
+    pending[handle] = static_cast<uint8_t>(destinationCount);
+}
+
+void TransformSystem::setRotation(Handle handle, const glm::quat& rotation) {
+    rotationX[handle] = rotation.x;
+    rotationY[handle] = rotation.y;
+    rotationZ[handle] = rotation.z;
+    rotationW[handle] = rotation.w;
+    pending[handle] = static_cast<uint8_t>(destinationCount);
+}
+
+void TransformSystem::setScale(Handle handle, const glm::vec3& scale) {
+    scaleX[handle] = scale.x;
+    scaleY[handle] = scale.y;
+    scaleZ[handle] = scale.z;
+    pending[handle] = static_cast<uint8_t>(destinationCount);
+}
+
+glm::vec3 TransformSystem::getPosition(Handle handle) const {
+    return glm::vec3(positionX[handle], positionY[handle], positionZ[handle]);
+}
+
+glm::quat TransformSystem::getRotation(Handle handle) const {
+    return glm::quat(rotationW[handle], rotationX[handle], rotationY[handle], rotationZ[handle]);
+}
+
+glm::vec3 TransformSystem::getScale(Handle handle) const {
+    return glm::vec3(scaleX[handle], scaleY[handle], scaleZ[handle]);
+}
+
+void TransformSystem::invalidate() {
+    std::fill(pending.begin(), pending.begin() + count, static_cast<uint8_t>(destinationCount));
+}
+
+uint32_t TransformSystem::update(glm::mat4* destination) {
+    Transforms transforms = {positionX.data(), positionY.data(), positionZ.data(), rotationX.data(), rotationY.data(),
+                             rotationZ.data(), rotationW.data(), scaleX.data(), scaleY.data(), scaleZ.data()};
+    ComposeBlock composeBlock = getKernel().composeBlock;
+    float* matrices = reinterpret_cast<float*>(destination);
+
+    uint32_t written = 0;
+    for (size_t first = 0; first < count; first += BLOCK_SIZE) {
+        // Blocks without changes cost one load
+        uint64_t blockPending;
+        std::memcpy(&blockPending, &pending[first], sizeof(blockPending));
+        if (blockPending == 0) {
+            continue;
+        }
+
+        uint32_t laneMask = 0;
+        for (size_t lane = 0; lane < BLOCK_SIZE; lane++) {
+            if (pending[first + lane]) {
+                pending[first + lane]--;
+                laneMask |= 1u << lane;
+                written++;
+            }
+        }
+        composeBlock(transforms, first, laneMask, matrices);
+    }
+    return written;
+}
+
+const char* TransformSystem::getInstructionSet() {
+    return getKernel().instructionSet;
+}
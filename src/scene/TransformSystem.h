@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+
+// Position, rotation and scale of many objects, stored as structure of arrays so their world
+// matrices (translate * rotate * scale) are composed 8 at a time with AVX, or 4 at a time with SSE
+// or NEON, instead of one glm call chain per object.
+//
+// Only changed transforms are composed. The matrices go to destinationCount destinations used in
+// turn, e.g. one mapped buffer per frame in flight, so a change is written to each of them once and
+// then skipped until the transform changes again.
+class TransformSystem {
+    public:
+        using Handle = uint32_t;
+
+        // At most 255 destinations
+        explicit TransformSystem(uint32_t destinationCount = 1);
+
+        Handle create(const glm::vec3& position = glm::vec3(0.0f),
+                      const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                      const glm::vec3& scale = glm::vec3(1.0f));
+        void clear();
+        uint32_t getCount() const { return count; }
+
+        void setPosition(Handle handle, const glm::vec3& position);
+        // Unit quaternion
+        void setRotation(Handle handle, const glm::quat& rotation);
+        void setScale(Handle handle, const glm::vec3& scale);
+        glm::vec3 getPosition(Handle handle) const;
+        glm::quat getRotation(Handle handle) const;
+        glm::vec3 getScale(Handle handle) const;
+        // Writes every matrix again on the next updates, e.g. after the destinations were recreated
+        void invalidate();
+
+        // Writes the world matrix of every changed transform to destination[handle]. The destination
+        // holds getCount() matrices and may be mapped GPU memory: matrices are written whole, in
+        // order, and never read back. Returns the number of matrices written.
+        uint32_t update(glm::mat4* destination);
+
+        // Instruction set update() uses, e.g. "AVX"
+        static const char* getInstructionSet();
+
+    private:
+        uint32_t destinationCount;
+        uint32_t count = 0;
+
+        // Padded with identity transforms to whole blocks of 8
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+        std::vector<float> scaleX, scaleY, scaleZ;
+        // Destinations each transform still has to be written to
+        std::vector<uint8_t> pending;
+};
@@ -2,8 +2,20 @@
 #include "../core/VulkanDevice.h"
 #include "../rendering/VulkanSwapchain.h"
 #include "../rendering/CommandManager.h"  // Add this include
+#include "../resources/AssetPack.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <vector>
+#include <imgui_internal.h>
+
+// The backend enables it with Vulkan 1.3 headers, which the engine needs anyway; the GUI is drawn
+// with dynamic rendering whenever the device supports it
+#ifndef IMGUI_IMPL_VULKAN_HAS_DYNAMIC_RENDERING
+#error "ImGui Vulkan backend was built without dynamic rendering support"
+#endif
 
 GuiManager::GuiManager(const Config& config) : config_(config) {}
 
@@ -12,7 +24,8 @@ GuiManager::~GuiManager() {
 }
 
 void GuiManager::initialize(GLFWwindow* window, VkInstance instance, VulkanDevice* device, 
-                             VulkanSwapchain* swapchain, VkRenderPass renderPass) {
+                             VulkanSwapchain* swapchain, VkRenderPass renderPass,
+                             VkFormat depthFormat) {
     vulkanDevice_ = device;
     
     createDescriptorPool();
@@ -24,7 +37,17 @@ void GuiManager::initialize(GLFWwindow* window, VkInstance instance, VulkanDevic
     
     // Load custom font if specified
     if (!config_.fontPath.empty()) {
-        ImFont* font = io.Fonts->AddFontFromFileTTF(config_.fontPath.c_str(), config_.fontSize);
+        ImFont* font = nullptr;
+        AssetPack::Asset asset;
+        if (config_.assetPack && config_.assetPack->find(config_.fontPath, asset)) {
+            // The atlas only reads the mapped data, and must not free it
+            ImFontConfig fontConfig;
+            fontConfig.FontDataOwnedByAtlas = false;
+            font = io.Fonts->AddFontFromMemoryTTF(const_cast<uint8_t*>(asset.data), static_cast<int>(asset.size),
+                                                  config_.fontSize, &fontConfig);
+        } else {
+            font = io.Fonts->AddFontFromFileTTF(config_.fontPath.c_str(), config_.fontSize);
+        }
         if (font == nullptr) {
             std::cerr << "Warning: Failed to load font from " << config_.fontPath << ". Using default font." << std::endl;
         } else {
@@ -69,10 +92,21 @@ void GuiManager::initialize(GLFWwindow* window, VkInstance instance, VulkanDevic
     init_info.DescriptorPool = descriptorPool_;
     init_info.RenderPass = renderPass;
     init_info.Subpass = 0;
-    init_info.MinImageCount = config_.maxFramesInFlight;
-    init_info.ImageCount = swapchain->getImageViews().size();
+    // ImageCount only sizes the backend's per-frame vertex buffers, which have to cover every frame
+    // in flight. It does not follow the swapchain, whose image count can change at runtime.
+    init_info.MinImageCount = std::max<uint32_t>(config_.maxFramesInFlight, 2);
+    init_info.ImageCount = std::max<uint32_t>(static_cast<uint32_t>(swapchain->getImageViews().size()), init_info.MinImageCount);
     init_info.MSAASamples = config_.msaaSamples;
     init_info.Allocator = nullptr;
+    if (renderPass == VK_NULL_HANDLE) {
+        colorFormat_ = swapchain->getImageFormat();
+        init_info.UseDynamicRendering = true;
+        init_info.PipelineRenderingCreateInfo = {};
+        init_info.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+        init_info.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+        init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats = &colorFormat_;
+        init_info.PipelineRenderingCreateInfo.depthAttachmentFormat = depthFormat;
+    }
     init_info.CheckVkResultFn = [](VkResult result) {
         if (result != VK_SUCCESS) {
             throw std::runtime_error("ImGui Vulkan error: " + std::to_string(result));
@@ -95,16 +129,47 @@ void GuiManager::cleanup() {
     }
 }
 
-void GuiManager::newFrame() {
+bool GuiManager::newFrame() {
     ImGui_ImplVulkan_NewFrame();
+    // Queues this frame's input events and sets the display size and delta time
     ImGui_ImplGlfw_NewFrame();
+
+    ImGuiIO& io = ImGui::GetIO();
+    if (!needsNewFrame()) {
+        skippedTime_ += io.DeltaTime;
+        frameBuilt_ = false;
+        reusedFrames_++;
+        return false;
+    }
+
+    // Keep ImGui's clock (tooltip delays, animations) in step with real time
+    io.DeltaTime += skippedTime_;
+    skippedTime_ = 0.0f;
     ImGui::NewFrame();
     
     setupDocking();
+
+    frameBuilt_ = true;
+    hasCachedFrame_ = true;
+    invalidated_ = false;
+    lastDisplaySize_ = io.DisplaySize;
+    lastFramebufferScale_ = io.DisplayFramebufferScale;
+    builtFrames_++;
+    return true;
 }
 
-// Fix: Add missing opening brace
 void GuiManager::render(VkCommandBuffer commandBuffer) {
+    if (!frameBuilt_) {
+        // The draw data of the last built frame stays valid until the next ImGui::NewFrame(). The
+        // backend uploads it again into its per-frame buffers, but ImGui does no layout or
+        // tessellation. Other viewports keep presenting their last image.
+        ImDrawData* draw_data = ImGui::GetDrawData();
+        if (draw_data) {
+            ImGui_ImplVulkan_RenderDrawData(draw_data, commandBuffer);
+        }
+        return;
+    }
+
     ImGui::Render();
     ImDrawData* draw_data = ImGui::GetDrawData();
     ImGui_ImplVulkan_RenderDrawData(draw_data, commandBuffer);
@@ -117,6 +182,41 @@ void GuiManager::render(VkCommandBuffer commandBuffer) {
     }
 }
 
+void GuiManager::setCacheStaticFrames(bool enable) {
+    config_.cacheStaticFrames = enable;
+    invalidated_ = true;
+}
+
+bool GuiManager::needsNewFrame() {
+    if (!config_.cacheStaticFrames || !hasCachedFrame_ || invalidated_) {
+        return true;
+    }
+
+    ImGuiContext& g = *ImGui::GetCurrentContext();
+    ImGuiIO& io = g.IO;
+    // Any queued event (mouse move, button, key, char, focus) means the UI may react. ImGui drops
+    // duplicate mouse positions, so an idle cursor queues nothing.
+    bool input = g.InputEventsQueue.Size > 0;
+    // Held buttons and active widgets (drags, key repeat, text caret) change without new events
+    bool active = g.ActiveId != 0 || ImGui::IsAnyMouseDown() || io.WantTextInput;
+    if (input || active) {
+        settleFramesLeft_ = config_.settleFrames;
+        return true;
+    }
+    if (settleFramesLeft_ > 0) {
+        settleFramesLeft_--;
+        return true;
+    }
+
+    if (io.DisplaySize.x != lastDisplaySize_.x || io.DisplaySize.y != lastDisplaySize_.y ||
+        io.DisplayFramebufferScale.x != lastFramebufferScale_.x ||
+        io.DisplayFramebufferScale.y != lastFramebufferScale_.y) {
+        return true;
+    }
+    // Values shown in the GUI (timings, counters) still refresh at a low rate
+    return skippedTime_ + io.DeltaTime >= config_.maxCachedFrameAge;
+}
+
 void GuiManager::setupDocking() {
     static bool dockspaceOpen = true;
     static bool opt_fullscreen_persistant = true;
@@ -159,6 +259,10 @@ void GuiManager::setupDocking() {
             }
             ImGui::EndMenu();
         }
+        if (metrics_ && ImGui::BeginMenu("View")) {
+            ImGui::MenuItem("Performance", nullptr, &showMetricsPanel_);
+            ImGui::EndMenu();
+        }
         ImGui::EndMenuBar();
     }
 
@@ -167,9 +271,113 @@ void GuiManager::setupDocking() {
         uiCallback();
     }
 
+    if (metrics_) {
+        metrics_->setEnabled(showMetricsPanel_);
+        if (showMetricsPanel_) {
+            drawMetricsPanel();
+        }
+    }
+
     ImGui::End();
 }
 
+void GuiManager::drawMetricsPanel() {
+    if (!ImGui::Begin("Performance", &showMetricsPanel_)) {
+        ImGui::End();
+        return;
+    }
+
+    // Frame timings: recent history, distribution and percentiles
+    std::vector<float> history;
+    std::vector<float> sorted;
+    for (Metrics::SeriesId id = 0; id < metrics_->getSeriesCount(); id++) {
+        if (metrics_->getCategory(id) != Metrics::Category::Frame) {
+            continue;
+        }
+        metrics_->getHistory(id, history);
+        if (history.empty()) {
+            continue;
+        }
+        sorted = history;
+        Metrics::Stats stats = Metrics::computeStats(sorted);
+
+        const std::string& name = metrics_->getName(id);
+        ImGui::Text("%s: avg %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", name.c_str(), stats.average,
+                    stats.p50, stats.p95, stats.p99, stats.max);
+        ImGui::PlotLines(("##history " + name).c_str(), history.data(), static_cast<int>(history.size()), 0,
+                         nullptr, 0.0f, stats.max, ImVec2(-1.0f, 50.0f));
+
+        const int binCount = 32;
+        float bins[binCount] = {};
+        float range = std::max(stats.max - stats.min, 1e-3f);
+        for (float value : sorted) {
+            int bin = std::min(static_cast<int>((value - stats.min) / range * binCount), binCount - 1);
+            bins[bin] += 1.0f;
+        }
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%.2f - %.2f ms", stats.min, stats.max);
+        ImGui::PlotHistogram(("##distribution " + name).c_str(), bins, binCount, 0, overlay, 0.0f, FLT_MAX,
+                             ImVec2(-1.0f, 50.0f));
+    }
+
+    drawMetricsTable("CPU phases (ms)", Metrics::Category::CpuPhase);
+    drawMetricsTable("GPU passes (ms)", Metrics::Category::GpuPass);
+    drawMetricsTable("Counters", Metrics::Category::Counter);
+
+    ImGui::Separator();
+    ImGui::Text("Device memory:");
+    std::vector<MemoryHeapUsage> heaps = vulkanDevice_->getMemoryHeapUsage();
+    for (uint32_t i = 0; i < heaps.size(); i++) {
+        const MemoryHeapUsage& heap = heaps[i];
+        const char* kind = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "device local" : "host";
+        double sizeMiB = heap.size / (1024.0 * 1024.0);
+        if (vulkanDevice_->isMemoryBudgetEnabled() && heap.budget > 0) {
+            char overlay[96];
+            snprintf(overlay, sizeof(overlay), "%.1f / %.1f MiB (heap %.1f MiB)", heap.usage / (1024.0 * 1024.0),
+                     heap.budget / (1024.0 * 1024.0), sizeMiB);
+            ImGui::Text("Heap %u (%s)", i, kind);
+            ImGui::ProgressBar(static_cast<float>(static_cast<double>(heap.usage) / heap.budget), ImVec2(-1.0f, 0.0f), overlay);
+        } else {
+            ImGui::Text("Heap %u (%s): %.1f MiB, usage unavailable (no VK_EXT_memory_budget)", i, kind, sizeMiB);
+        }
+    }
+
+    ImGui::End();
+}
+
+void GuiManager::drawMetricsTable(const char* label, Metrics::Category category) {
+    if (!ImGui::CollapsingHeader(label, ImGuiTreeNodeFlags_DefaultOpen)) {
+        return;
+    }
+    if (!ImGui::BeginTable(label, 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+        return;
+    }
+    ImGui::TableSetupColumn("Name");
+    ImGui::TableSetupColumn("Last");
+    ImGui::TableSetupColumn("Avg");
+    ImGui::TableSetupColumn("p95");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableHeadersRow();
+
+    for (Metrics::SeriesId id = 0; id < metrics_->getSeriesCount(); id++) {
+        if (metrics_->getCategory(id) != category) {
+            continue;
+        }
+        Metrics::Stats stats = metrics_->getStats(id);
+        if (stats.count == 0) {
+            continue;
+        }
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(metrics_->getName(id).c_str());
+        for (float value : {stats.last, stats.average, stats.p95, stats.max}) {
+            ImGui::TableNextColumn();
+            ImGui::Text(category == Metrics::Category::Counter ? "%.0f" : "%.3f", value);
+        }
+    }
+    ImGui::EndTable();
+}
+
 void GuiManager::createDescriptorPool() {
     VkDescriptorPoolSize pool_sizes[] = {
         { VK_DESCRIPTOR_TYPE_SAMPLER, 1000 },
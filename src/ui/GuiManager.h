@@ -7,9 +7,11 @@
 #include <imgui_impl_vulkan.h>
 #include <functional>
 #include <string>
+#include "../core/Metrics.h"
 
 class VulkanDevice;
 class VulkanSwapchain;
+class AssetPack;
 
 class GuiManager {
 public:
@@ -18,18 +20,43 @@ public:
         VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
         std::string fontPath = "";
         float fontSize = 16.0f;
+        // Read the font from here when it is packed; must outlive the GuiManager
+        const AssetPack* assetPack = nullptr;
+        // Reuse the previous GUI frame while there is no input instead of building it again. The
+        // draw data is replayed as is, so values shown in the GUI only refresh every
+        // maxCachedFrameAge seconds (or on invalidate()).
+        bool cacheStaticFrames = false;
+        float maxCachedFrameAge = 0.25f;
+        // Frames still built after the last input, so hover and fade animations can finish
+        uint32_t settleFrames = 8;
     };
 
     GuiManager(const Config& config);
     ~GuiManager();
 
+    // With a null renderPass the GUI is drawn with dynamic rendering into the swapchain format,
+    // alongside a depth attachment of depthFormat (if not VK_FORMAT_UNDEFINED)
     void initialize(GLFWwindow* window, VkInstance instance, VulkanDevice* device, 
-                   VulkanSwapchain* swapchain, VkRenderPass renderPass);
+                   VulkanSwapchain* swapchain, VkRenderPass renderPass,
+                   VkFormat depthFormat = VK_FORMAT_UNDEFINED);
     void cleanup();
     
-    void newFrame();
+    // Returns false when the previous frame is reused. No ImGui calls may be made until the next
+    // newFrame() in that case; render() replays the cached draw data.
+    bool newFrame();
     void render(VkCommandBuffer commandBuffer);
     void setupDocking();
+
+    // Builds the next frame even if there was no input, e.g. after state shown in the GUI changed
+    void invalidate() { invalidated_ = true; }
+    void setCacheStaticFrames(bool enable);
+    bool getCacheStaticFrames() const { return config_.cacheStaticFrames; }
+    uint64_t getBuiltFrameCount() const { return builtFrames_; }
+    uint64_t getReusedFrameCount() const { return reusedFrames_; }
+
+    // Adds View > Performance, a panel with the frame time distribution, CPU phase and GPU pass
+    // timings, counters and memory heap usage. Recording is only enabled while the panel is open.
+    void setMetrics(Metrics* metrics) { metrics_ = metrics; }
     
     // UI callback - you can set this to define your UI
     std::function<void()> uiCallback;
@@ -38,7 +65,27 @@ private:
     Config config_;
     VkDescriptorPool descriptorPool_ = VK_NULL_HANDLE;
     VulkanDevice* vulkanDevice_ = nullptr;
+    // Referenced by the ImGui pipeline rendering info, so it has to outlive initialize()
+    VkFormat colorFormat_ = VK_FORMAT_UNDEFINED;
+
+    // Frame cache state
+    bool frameBuilt_ = false;
+    bool hasCachedFrame_ = false;
+    bool invalidated_ = true;
+    uint32_t settleFramesLeft_ = 0;
+    // Time of the reused frames, added to the delta time of the next built one
+    float skippedTime_ = 0.0f;
+    ImVec2 lastDisplaySize_{};
+    ImVec2 lastFramebufferScale_{};
+    uint64_t builtFrames_ = 0;
+    uint64_t reusedFrames_ = 0;
+
+    Metrics* metrics_ = nullptr;
+    bool showMetricsPanel_ = false;
     
+    void drawMetricsPanel();
+    void drawMetricsTable(const char* label, Metrics::Category category);
+    bool needsNewFrame();
     void createDescriptorPool();
     void destroyDescriptorPool(); 
 };
\ No newline at end of file